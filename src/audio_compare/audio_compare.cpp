@@ -0,0 +1,61 @@
+// Copyright 2017 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include "audio_core/audio_recording.h"
+
+static void PrintHelp(const char* argv0) {
+    std::cout << "Usage: " << argv0
+              << " [options] <expected> <actual>\n"
+                 "Compares two audio recordings made with the record audio output engine.\n"
+                 "-t, --tolerance=NUMBER  Largest difference allowed between samples (default 0)\n"
+                 "-h, --help              Display this help and exit\n"
+                 "Exits with 0 if the recordings match, 1 if they don't and 2 on errors.\n";
+}
+
+int main(int argc, char** argv) {
+    int tolerance = 0;
+    std::string paths[2];
+    int path_count = 0;
+
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+        if (arg == "-h" || arg == "--help") {
+            PrintHelp(argv[0]);
+            return 0;
+        } else if (arg == "-t" && i + 1 < argc) {
+            tolerance = std::atoi(argv[++i]);
+        } else if (arg.compare(0, 12, "--tolerance=") == 0) {
+            tolerance = std::atoi(arg.c_str() + 12);
+        } else if (path_count < 2 && !arg.empty() && arg[0] != '-') {
+            paths[path_count++] = arg;
+        } else {
+            PrintHelp(argv[0]);
+            return 2;
+        }
+    }
+
+    if (path_count != 2 || tolerance < 0) {
+        PrintHelp(argv[0]);
+        return 2;
+    }
+
+    AudioCore::Recording::Reader expected(paths[0]);
+    AudioCore::Recording::Reader actual(paths[1]);
+    if (!expected.IsValid() || !actual.IsValid())
+        return 2;
+
+    const auto result = AudioCore::Recording::Compare(expected, actual, tolerance);
+    if (!result.matches) {
+        std::cout << "Mismatch: " << result.mismatch << "\n";
+        return 1;
+    }
+
+    std::cout << "Recordings match: " << result.frames_compared
+              << " frames, largest sample difference " << result.max_difference << "\n";
+    return 0;
+}
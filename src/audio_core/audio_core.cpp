@@ -76,6 +76,18 @@ void EnableStretching(bool enable) {
     DSP::HLE::EnableStretching(enable);
 }
 
+void EnableSpeedGovernor(bool enable) {
+    DSP::HLE::EnableSpeedGovernor(enable);
+}
+
+void EnablePolyphaseInterpolation(bool enable) {
+    DSP::HLE::EnablePolyphaseInterpolation(enable);
+}
+
+double GetSpeedGovernorFactor() {
+    return DSP::HLE::GetSpeedGovernorFactor();
+}
+
 void Shutdown() {
     CoreTiming::UnscheduleEvent(tick_event, 0);
     DSP::HLE::Shutdown();
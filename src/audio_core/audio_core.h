@@ -26,6 +26,15 @@ void SelectSink(std::string sink_id);
 /// Enable/Disable stretching.
 void EnableStretching(bool enable);
 
+/// Enable/Disable the speed governor.
+void EnableSpeedGovernor(bool enable);
+
+/// Enable/Disable the polyphase filter for sources requesting polyphase interpolation.
+void EnablePolyphaseInterpolation(bool enable);
+
+/// Factor by which the speed governor wants emulation speed scaled. 1.0 while it's inactive.
+double GetSpeedGovernorFactor();
+
 /// Shutdown Audio Core
 void Shutdown();
 
@@ -0,0 +1,223 @@
+// Copyright 2017 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include "audio_core/audio_recording.h"
+#include "common/logging/log.h"
+#include "common/string_util.h"
+
+namespace AudioCore {
+namespace Recording {
+
+// Each channel is coded as a sequence of varints. An odd value is a run of (value >> 1) repeats
+// of the previous sample. An even value holds the zigzag coded delta to the next sample.
+
+static void WriteVarint(u32 value, std::vector<u8>& output) {
+    while (value >= 0x80) {
+        output.push_back(static_cast<u8>(value | 0x80));
+        value >>= 7;
+    }
+    output.push_back(static_cast<u8>(value));
+}
+
+static bool ReadVarint(const u8*& data, const u8* end, u32& value) {
+    value = 0;
+    for (unsigned shift = 0; shift < 32; shift += 7) {
+        if (data == end)
+            return false;
+        const u8 byte = *data++;
+        value |= static_cast<u32>(byte & 0x7F) << shift;
+        if (!(byte & 0x80))
+            return true;
+    }
+    return false;
+}
+
+void CompressFrame(const s16* samples, size_t sample_count, std::vector<u8>& output) {
+    output.clear();
+
+    for (size_t channel = 0; channel < 2; ++channel) {
+        s32 previous = 0;
+        u32 zero_run = 0;
+
+        for (size_t i = 0; i < sample_count; ++i) {
+            const s32 sample = samples[i * 2 + channel];
+            const s32 delta = sample - previous;
+            previous = sample;
+
+            if (delta == 0) {
+                ++zero_run;
+                continue;
+            }
+
+            if (zero_run > 0) {
+                WriteVarint((zero_run << 1) | 1, output);
+                zero_run = 0;
+            }
+            const u32 zigzag = (static_cast<u32>(delta) << 1) ^ static_cast<u32>(delta >> 31);
+            WriteVarint(zigzag << 1, output);
+        }
+
+        if (zero_run > 0) {
+            WriteVarint((zero_run << 1) | 1, output);
+        }
+    }
+}
+
+bool DecompressFrame(const u8* data, size_t size, s16* samples, size_t sample_count) {
+    const u8* const end = data + size;
+
+    for (size_t channel = 0; channel < 2; ++channel) {
+        s32 previous = 0;
+        size_t i = 0;
+
+        while (i < sample_count) {
+            u32 value;
+            if (!ReadVarint(data, end, value))
+                return false;
+
+            if (value & 1) {
+                const u32 run = value >> 1;
+                if (run > sample_count - i)
+                    return false;
+                for (u32 j = 0; j < run; ++j, ++i)
+                    samples[i * 2 + channel] = static_cast<s16>(previous);
+            } else {
+                const u32 zigzag = value >> 1;
+                const s32 delta = static_cast<s32>(zigzag >> 1) ^ -static_cast<s32>(zigzag & 1);
+                previous += delta;
+                if (previous < -32768 || previous > 32767)
+                    return false;
+                samples[i++ * 2 + channel] = static_cast<s16>(previous);
+            }
+        }
+    }
+
+    return data == end;
+}
+
+Writer::Writer(const std::string& path, u32 sample_rate) {
+    if (!file.Open(path, "wb")) {
+        LOG_CRITICAL(Audio, "Could not open %s for writing", path.c_str());
+        return;
+    }
+
+    FileHeader header;
+    std::memcpy(header.magic, FileHeader::ExpectedMagicWord(), sizeof(header.magic));
+    header.version = FileHeader::ExpectedVersion();
+    header.sample_rate = sample_rate;
+    file.WriteObject(header);
+}
+
+void Writer::WriteFrame(u64 timestamp, const s16* samples, size_t sample_count) {
+    if (!file.IsOpen())
+        return;
+
+    CompressFrame(samples, sample_count, compressed);
+
+    FrameHeader frame_header;
+    frame_header.timestamp = timestamp;
+    frame_header.sample_count = static_cast<u32>(sample_count);
+    frame_header.data_size = static_cast<u32>(compressed.size());
+    file.WriteObject(frame_header);
+    file.WriteArray(compressed.data(), compressed.size());
+}
+
+Reader::Reader(const std::string& path) {
+    if (!file.Open(path, "rb")) {
+        LOG_ERROR(Audio, "Could not open %s", path.c_str());
+        return;
+    }
+
+    if (file.ReadBytes(&header, sizeof(header)) != sizeof(header) ||
+        std::memcmp(header.magic, FileHeader::ExpectedMagicWord(), sizeof(header.magic)) != 0 ||
+        header.version != FileHeader::ExpectedVersion()) {
+        LOG_ERROR(Audio, "%s is not an audio recording of a supported version", path.c_str());
+        return;
+    }
+
+    valid = true;
+}
+
+bool Reader::ReadFrame(u64& timestamp, std::vector<s16>& samples) {
+    if (!valid)
+        return false;
+
+    FrameHeader frame_header;
+    if (file.ReadBytes(&frame_header, sizeof(frame_header)) != sizeof(frame_header))
+        return false;
+
+    compressed.resize(frame_header.data_size);
+    samples.resize(frame_header.sample_count * 2);
+    if (file.ReadArray(compressed.data(), compressed.size()) != compressed.size() ||
+        !DecompressFrame(compressed.data(), compressed.size(), samples.data(),
+                         frame_header.sample_count)) {
+        LOG_ERROR(Audio, "Malformed audio frame");
+        return false;
+    }
+
+    timestamp = frame_header.timestamp;
+    return true;
+}
+
+ComparisonResult Compare(Reader& expected, Reader& actual, int tolerance) {
+    ComparisonResult result;
+
+    auto mismatch = [&result](std::string description) {
+        result.matches = false;
+        result.mismatch = std::move(description);
+        return result;
+    };
+
+    if (expected.GetHeader().sample_rate != actual.GetHeader().sample_rate) {
+        return mismatch(Common::StringFromFormat("Sample rates differ: %u and %u",
+                                                 static_cast<u32>(expected.GetHeader().sample_rate),
+                                                 static_cast<u32>(actual.GetHeader().sample_rate)));
+    }
+
+    u64 expected_timestamp, actual_timestamp;
+    std::vector<s16> expected_samples, actual_samples;
+    while (true) {
+        const bool expected_read = expected.ReadFrame(expected_timestamp, expected_samples);
+        const bool actual_read = actual.ReadFrame(actual_timestamp, actual_samples);
+        if (!expected_read && !actual_read)
+            break;
+
+        const size_t frame = result.frames_compared++;
+        if (!expected_read || !actual_read) {
+            return mismatch(Common::StringFromFormat("Frame %zu is only in the %s recording",
+                                                     frame, expected_read ? "expected" : "actual"));
+        }
+
+        if (expected_timestamp != actual_timestamp) {
+            return mismatch(Common::StringFromFormat(
+                "Frame %zu timestamps differ: %llu and %llu", frame,
+                static_cast<unsigned long long>(expected_timestamp),
+                static_cast<unsigned long long>(actual_timestamp)));
+        }
+
+        if (expected_samples.size() != actual_samples.size()) {
+            return mismatch(Common::StringFromFormat("Frame %zu sample counts differ: %zu and %zu",
+                                                     frame, expected_samples.size() / 2,
+                                                     actual_samples.size() / 2));
+        }
+
+        for (size_t i = 0; i < expected_samples.size(); ++i) {
+            const int difference = std::abs(expected_samples[i] - actual_samples[i]);
+            result.max_difference = std::max(result.max_difference, difference);
+            if (difference > tolerance) {
+                return mismatch(Common::StringFromFormat(
+                    "Frame %zu sample %zu channel %zu differs by %d: %d and %d", frame, i / 2,
+                    i % 2, difference, expected_samples[i], actual_samples[i]));
+            }
+        }
+    }
+
+    return result;
+}
+
+} // namespace Recording
+} // namespace AudioCore
@@ -0,0 +1,134 @@
+// Copyright 2017 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <vector>
+#include "common/common_types.h"
+#include "common/file_util.h"
+#include "common/swap.h"
+
+namespace AudioCore {
+namespace Recording {
+
+// An audio recording is a FileHeader followed by frames, each a FrameHeader followed by the
+// compressed samples of the frame. Frames are compressed independently of each other.
+
+#pragma pack(push, 1)
+
+struct FileHeader {
+    static const char* ExpectedMagicWord() {
+        return "CiAu";
+    }
+
+    static u32 ExpectedVersion() {
+        return 1;
+    }
+
+    char magic[4];
+    u32_le version;
+    u32_le sample_rate;
+};
+static_assert(sizeof(FileHeader) == 12, "FileHeader has incorrect size");
+
+struct FrameHeader {
+    u64_le timestamp;    ///< Emulated time at which the frame was mixed, in CPU cycles
+    u32_le sample_count; ///< Number of stereo samples in the frame
+    u32_le data_size;    ///< Size of the compressed samples following the header
+};
+static_assert(sizeof(FrameHeader) == 16, "FrameHeader has incorrect size");
+
+#pragma pack(pop)
+
+/**
+ * Compresses stereo samples losslessly. Each channel is delta coded, and the deltas are stored as
+ * variable-length integers with runs of zero deltas collapsed, which makes silence nearly free.
+ * @param samples Samples in interleaved stereo PCM16 format.
+ * @param sample_count Number of samples.
+ * @param output Receives the compressed data, replacing its contents.
+ */
+void CompressFrame(const s16* samples, size_t sample_count, std::vector<u8>& output);
+
+/**
+ * Decompresses samples compressed by CompressFrame.
+ * @param data Compressed data.
+ * @param size Size of the compressed data.
+ * @param samples Receives the samples in interleaved stereo PCM16 format.
+ * @param sample_count Number of samples to decompress.
+ * @return false if the data is malformed or doesn't hold exactly sample_count samples.
+ */
+bool DecompressFrame(const u8* data, size_t size, s16* samples, size_t sample_count);
+
+/// Writes audio frames to a recording.
+class Writer final {
+public:
+    Writer(const std::string& path, u32 sample_rate);
+
+    bool IsOpen() const {
+        return file.IsOpen();
+    }
+
+    /**
+     * Appends a frame to the recording.
+     * @param timestamp Emulated time at which the frame was mixed.
+     * @param samples Samples in interleaved stereo PCM16 format.
+     * @param sample_count Number of samples.
+     */
+    void WriteFrame(u64 timestamp, const s16* samples, size_t sample_count);
+
+private:
+    FileUtil::IOFile file;
+    std::vector<u8> compressed;
+};
+
+/// Reads audio frames from a recording.
+class Reader final {
+public:
+    explicit Reader(const std::string& path);
+
+    /// Whether the file could be opened and has a valid header
+    bool IsValid() const {
+        return valid;
+    }
+
+    const FileHeader& GetHeader() const {
+        return header;
+    }
+
+    /**
+     * Reads the next frame of the recording.
+     * @param timestamp Receives the emulated time at which the frame was mixed.
+     * @param samples Receives the samples in interleaved stereo PCM16 format.
+     * @return false at the end of the recording or if the frame is malformed.
+     */
+    bool ReadFrame(u64& timestamp, std::vector<s16>& samples);
+
+private:
+    FileUtil::IOFile file;
+    FileHeader header;
+    bool valid = false;
+    std::vector<u8> compressed;
+};
+
+struct ComparisonResult {
+    bool matches = true;
+    /// Number of frames that were compared, including the first mismatching one
+    size_t frames_compared = 0;
+    /// Largest difference between corresponding samples seen
+    int max_difference = 0;
+    /// Description of the first mismatch, if any
+    std::string mismatch;
+};
+
+/**
+ * Compares two recordings frame by frame. They match if they have the same sample rate and the
+ * same number of frames, each with the same timestamp and sample count, and all corresponding
+ * samples differ by at most tolerance.
+ */
+ComparisonResult Compare(Reader& expected, Reader& actual, int tolerance);
+
+} // namespace Recording
+} // namespace AudioCore
@@ -5,7 +5,6 @@
 #include <array>
 #include <cstddef>
 #include <cstring>
-#include <vector>
 #include "audio_core/codec.h"
 #include "common/assert.h"
 #include "common/common_types.h"
@@ -13,21 +12,18 @@
 
 namespace Codec {
 
-StereoBuffer16 DecodeADPCM(const u8* const data, const size_t sample_count,
-                           const std::array<s16, 16>& adpcm_coeff, ADPCMState& state) {
+void DecodeADPCM(const u8* const data, const size_t sample_count,
+                 const std::array<s16, 16>& adpcm_coeff, ADPCMState& state,
+                 std::array<s16, 2>* output) {
     // GC-ADPCM with scale factor and variable coefficients.
     // Frames are 8 bytes long containing 14 samples each.
     // Samples are 4 bits (one nibble) long.
 
-    constexpr size_t FRAME_LEN = 8;
-    constexpr size_t SAMPLES_PER_FRAME = 14;
+    constexpr size_t FRAME_LEN = ADPCM_FRAME_SIZE;
+    constexpr size_t SAMPLES_PER_FRAME = ADPCM_SAMPLES_PER_FRAME;
     constexpr std::array<int, 16> SIGNED_NIBBLES = {
         {0, 1, 2, 3, 4, 5, 6, 7, -8, -7, -6, -5, -4, -3, -2, -1}};
 
-    const size_t ret_size =
-        sample_count % 2 == 0 ? sample_count : sample_count + 1; // Ensure multiple of two.
-    StereoBuffer16 ret(ret_size);
-
     int yn1 = state.yn1, yn2 = state.yn2;
 
     const size_t NUM_FRAMES =
@@ -61,11 +57,11 @@ StereoBuffer16 DecodeADPCM(const u8* const data, const size_t sample_count,
         size_t datai = framei * FRAME_LEN + 1;
         for (size_t i = 0; i < SAMPLES_PER_FRAME && outputi < sample_count; i += 2) {
             const s16 sample1 = decode_sample(SIGNED_NIBBLES[data[datai] >> 4]);
-            ret[outputi].fill(sample1);
+            output[outputi].fill(sample1);
             outputi++;
 
             const s16 sample2 = decode_sample(SIGNED_NIBBLES[data[datai] & 0xF]);
-            ret[outputi].fill(sample2);
+            output[outputi].fill(sample2);
             outputi++;
 
             datai++;
@@ -74,8 +70,6 @@ StereoBuffer16 DecodeADPCM(const u8* const data, const size_t sample_count,
 
     state.yn1 = yn1;
     state.yn2 = yn2;
-
-    return ret;
 }
 
 static s16 SignExtendS8(u8 x) {
@@ -84,42 +78,34 @@ static s16 SignExtendS8(u8 x) {
     return static_cast<s16>(static_cast<s8>(x));
 }
 
-StereoBuffer16 DecodePCM8(const unsigned num_channels, const u8* const data,
-                          const size_t sample_count) {
+void DecodePCM8(const unsigned num_channels, const u8* const data, const size_t sample_count,
+                std::array<s16, 2>* output) {
     ASSERT(num_channels == 1 || num_channels == 2);
 
-    StereoBuffer16 ret(sample_count);
-
     if (num_channels == 1) {
         for (size_t i = 0; i < sample_count; i++) {
-            ret[i].fill(SignExtendS8(data[i]));
+            output[i].fill(SignExtendS8(data[i]));
         }
     } else {
         for (size_t i = 0; i < sample_count; i++) {
-            ret[i][0] = SignExtendS8(data[i * 2 + 0]);
-            ret[i][1] = SignExtendS8(data[i * 2 + 1]);
+            output[i][0] = SignExtendS8(data[i * 2 + 0]);
+            output[i][1] = SignExtendS8(data[i * 2 + 1]);
         }
     }
-
-    return ret;
 }
 
-StereoBuffer16 DecodePCM16(const unsigned num_channels, const u8* const data,
-                           const size_t sample_count) {
+void DecodePCM16(const unsigned num_channels, const u8* const data, const size_t sample_count,
+                 std::array<s16, 2>* output) {
     ASSERT(num_channels == 1 || num_channels == 2);
 
-    StereoBuffer16 ret(sample_count);
-
     if (num_channels == 1) {
         for (size_t i = 0; i < sample_count; i++) {
             s16 sample;
             std::memcpy(&sample, data + i * sizeof(s16), sizeof(s16));
-            ret[i].fill(sample);
+            output[i].fill(sample);
         }
     } else {
-        std::memcpy(ret.data(), data, sample_count * 2 * sizeof(u16));
+        std::memcpy(output, data, sample_count * 2 * sizeof(u16));
     }
-
-    return ret;
 }
 };
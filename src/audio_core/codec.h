@@ -5,14 +5,11 @@
 #pragma once
 
 #include <array>
-#include <vector>
+#include <cstddef>
 #include "common/common_types.h"
 
 namespace Codec {
 
-/// A variable length buffer of signed PCM16 stereo samples.
-using StereoBuffer16 = std::vector<std::array<s16, 2>>;
-
 /// See: Codec::DecodeADPCM
 struct ADPCMState {
     // Two historical samples from previous processed buffer,
@@ -21,31 +18,40 @@ struct ADPCMState {
     s16 yn2; ///< y[n-2]
 };
 
+/// Number of samples in each 8-byte ADPCM frame
+constexpr size_t ADPCM_SAMPLES_PER_FRAME = 14;
+/// Size of an ADPCM frame in bytes
+constexpr size_t ADPCM_FRAME_SIZE = 8;
+
 /**
- * @param data Pointer to buffer that contains ADPCM data to decode
- * @param sample_count Length of buffer in terms of number of samples
+ * Decodes ADPCM data into a caller-provided buffer. Long buffers can be decoded a block at a time
+ * by starting each call at an ADPCM frame boundary and passing the state on.
+ * @param data Pointer to the first ADPCM frame to decode
+ * @param sample_count Number of samples to decode. Samples are decoded in pairs, so an odd count
+ *                     decodes one extra sample.
  * @param adpcm_coeff ADPCM coefficients
  * @param state ADPCM state, this is updated with new state
- * @return Decoded stereo signed PCM16 data, sample_count in length
+ * @param output Destination of the decoded stereo signed PCM16 samples
  */
-StereoBuffer16 DecodeADPCM(const u8* const data, const size_t sample_count,
-                           const std::array<s16, 16>& adpcm_coeff, ADPCMState& state);
+void DecodeADPCM(const u8* const data, const size_t sample_count,
+                 const std::array<s16, 16>& adpcm_coeff, ADPCMState& state,
+                 std::array<s16, 2>* output);
 
 /**
  * @param num_channels Number of channels
  * @param data Pointer to buffer that contains PCM8 data to decode
  * @param sample_count Length of buffer in terms of number of samples
- * @return Decoded stereo signed PCM16 data, sample_count in length
+ * @param output Destination of the decoded stereo signed PCM16 samples
  */
-StereoBuffer16 DecodePCM8(const unsigned num_channels, const u8* const data,
-                          const size_t sample_count);
+void DecodePCM8(const unsigned num_channels, const u8* const data, const size_t sample_count,
+                std::array<s16, 2>* output);
 
 /**
  * @param num_channels Number of channels
  * @param data Pointer to buffer that contains PCM16 data to decode
  * @param sample_count Length of buffer in terms of number of samples
- * @return Decoded stereo signed PCM16 data, sample_count in length
+ * @param output Destination of the decoded stereo signed PCM16 samples
  */
-StereoBuffer16 DecodePCM16(const unsigned num_channels, const u8* const data,
-                           const size_t sample_count);
+void DecodePCM16(const unsigned num_channels, const u8* const data, const size_t sample_count,
+                 std::array<s16, 2>* output);
 };
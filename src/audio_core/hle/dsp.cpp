@@ -3,13 +3,20 @@
 // Refer to the license.txt file included.
 
 #include <array>
+#include <atomic>
+#include <cstring>
 #include <memory>
+#include <mutex>
+#include <thread>
 #include "audio_core/hle/dsp.h"
 #include "audio_core/hle/mixers.h"
 #include "audio_core/hle/pipe.h"
 #include "audio_core/hle/source.h"
 #include "audio_core/sink.h"
 #include "audio_core/time_stretch.h"
+#include "common/math_util.h"
+#include "common/thread.h"
+#include "core/core_timing.h"
 
 namespace DSP {
 namespace HLE {
@@ -52,31 +59,46 @@ static std::array<Source, num_sources> sources = {
 };
 static Mixers mixers;
 
-static StereoFrame16 GenerateCurrentFrame() {
-    SharedMemory& read = ReadRegion();
-    SharedMemory& write = WriteRegion();
+/// Inputs of one audio frame, copied out of the shared memory region on the emulation thread
+struct FrameInput {
+    SourceConfiguration source_configurations;
+    AdpcmCoefficients adpcm_coefficients;
+    DspConfiguration dsp_configuration;
+    IntermediateMixSamples intermediate_mix_samples;
+    /// Emulated time at which the frame was requested
+    u64 timestamp;
+};
+
+/// Outputs of one audio frame, copied into the shared memory region on the following tick
+struct FrameOutput {
+    SourceStatus source_statuses;
+    DspStatus dsp_status;
+    IntermediateMixSamples intermediate_mix_samples;
+    FinalMixSamples final_samples;
+};
 
+static StereoFrame16 GenerateFrame(FrameInput& input, FrameOutput& output) {
     std::array<QuadFrame32, 3> intermediate_mixes = {};
 
     // Generate intermediate mixes
     for (size_t i = 0; i < num_sources; i++) {
-        write.source_statuses.status[i] =
-            sources[i].Tick(read.source_configurations.config[i], read.adpcm_coefficients.coeff[i]);
+        output.source_statuses.status[i] = sources[i].Tick(
+            input.source_configurations.config[i], input.adpcm_coefficients.coeff[i]);
         for (size_t mix = 0; mix < 3; mix++) {
             sources[i].MixInto(intermediate_mixes[mix], mix);
         }
     }
 
     // Generate final mix
-    write.dsp_status = mixers.Tick(read.dsp_configuration, read.intermediate_mix_samples,
-                                   write.intermediate_mix_samples, intermediate_mixes);
+    output.dsp_status =
+        mixers.Tick(input.dsp_configuration, input.intermediate_mix_samples,
+                    output.intermediate_mix_samples, intermediate_mixes);
 
     StereoFrame16 output_frame = mixers.GetOutput();
 
-    // Write current output frame to the shared memory region
     for (size_t samplei = 0; samplei < output_frame.size(); samplei++) {
         for (size_t channeli = 0; channeli < output_frame[0].size(); channeli++) {
-            write.final_samples.pcm16[samplei][channeli] = s16_le(output_frame[samplei][channeli]);
+            output.final_samples.pcm16[samplei][channeli] = s16_le(output_frame[samplei][channeli]);
         }
     }
 
@@ -85,28 +107,83 @@ static StereoFrame16 GenerateCurrentFrame() {
 
 // Audio output
 
+// The sink and time stretcher are used by the audio thread and reconfigured from the frontend.
+static std::mutex output_mutex;
 static bool perform_time_stretching = true;
 static std::unique_ptr<AudioCore::Sink> sink;
 static AudioCore::TimeStretcher time_stretcher;
 
+// Speed governor
+//
+// Without stretching, emulation running slightly faster or slower than the audio device makes
+// the sink's queue back up or run dry. The governor follows the queue depth and asks the frame
+// limiter to adjust emulation speed by a few percent, holding the queue at a target latency.
+
+static bool perform_speed_governing = false;
+/// Queue depth averaged over recent frames
+static double smoothed_queue_depth = 0.0;
+/// Read by the emulation thread, so unlike the rest of the output state it isn't under the mutex
+static std::atomic<double> speed_governor_factor{1.0};
+
+constexpr double governor_target_latency = 0.05; // Units: seconds
+/// Audio is only dropped once this much is queued despite the governor
+constexpr double governor_drop_latency = 0.25; // Units: seconds
+/// Weight of each frame's queue depth in the average
+constexpr double governor_smoothing = 0.05;
+/// Speed adjustment per target latency of deviation from the target
+constexpr double governor_gain = 0.05;
+constexpr double governor_max_adjustment = 0.05;
+
+static void UpdateSpeedGovernor(size_t samples_in_queue, double sample_rate) {
+    const double target_queue_depth = governor_target_latency * sample_rate;
+    smoothed_queue_depth +=
+        governor_smoothing * (static_cast<double>(samples_in_queue) - smoothed_queue_depth);
+
+    // Too much audio queued means emulation is running ahead of the device, so slow it down
+    const double error = (smoothed_queue_depth - target_queue_depth) / target_queue_depth;
+    const double adjustment =
+        MathUtil::Clamp(governor_gain * error, -governor_max_adjustment, governor_max_adjustment);
+    speed_governor_factor = 1.0 - adjustment;
+}
+
+/// Stretched audio is passed on to the sink in chunks of up to this many samples
+constexpr size_t stretch_chunk_samples = 2 * samples_per_frame;
+
+/// Stretches the audio added to the time stretcher and passes it on to the sink
+static void EnqueueStretchedAudio() {
+    std::array<s16, 2 * stretch_chunk_samples> chunk;
+    size_t count =
+        time_stretcher.Process(sink->SamplesInQueue(), chunk.data(), stretch_chunk_samples);
+    while (count > 0) {
+        sink->EnqueueSamples(chunk.data(), count);
+        count = time_stretcher.GetSamples(chunk.data(), stretch_chunk_samples);
+    }
+}
+
 static void FlushResidualStretcherAudio() {
     time_stretcher.Flush();
-    while (true) {
-        std::vector<s16> residual_audio = time_stretcher.Process(sink->SamplesInQueue());
-        if (residual_audio.empty())
-            break;
-        sink->EnqueueSamples(residual_audio.data(), residual_audio.size() / 2);
-    }
+    EnqueueStretchedAudio();
 }
 
-static void OutputCurrentFrame(const StereoFrame16& frame) {
-    if (perform_time_stretching) {
+static void OutputCurrentFrame(const StereoFrame16& frame, u64 timestamp) {
+    std::lock_guard<std::mutex> lock(output_mutex);
+
+    if (!sink->IsRealTime()) {
+        // Recording sinks get every frame unaltered, however fast emulation runs
+        sink->EnqueueFrame(timestamp, &frame[0][0], frame.size());
+    } else if (perform_time_stretching) {
         time_stretcher.AddSamples(&frame[0][0], frame.size());
-        std::vector<s16> stretched_samples = time_stretcher.Process(sink->SamplesInQueue());
-        sink->EnqueueSamples(stretched_samples.data(), stretched_samples.size() / 2);
+        EnqueueStretchedAudio();
     } else {
-        constexpr size_t maximum_sample_latency = 2048; // about 64 miliseconds
-        if (sink->SamplesInQueue() > maximum_sample_latency) {
+        const size_t samples_in_queue = sink->SamplesInQueue();
+        size_t maximum_sample_latency = 2048; // about 64 miliseconds
+        if (perform_speed_governing) {
+            const double sample_rate = sink->GetNativeSampleRate();
+            UpdateSpeedGovernor(samples_in_queue, sample_rate);
+            maximum_sample_latency = static_cast<size_t>(governor_drop_latency * sample_rate);
+        }
+
+        if (samples_in_queue > maximum_sample_latency) {
             // This can occur if we're running too fast and samples are starting to back up.
             // Just drop the samples.
             return;
@@ -117,6 +194,8 @@ static void OutputCurrentFrame(const StereoFrame16& frame) {
 }
 
 void EnableStretching(bool enable) {
+    std::lock_guard<std::mutex> lock(output_mutex);
+
     if (perform_time_stretching == enable)
         return;
 
@@ -124,6 +203,114 @@ void EnableStretching(bool enable) {
         FlushResidualStretcherAudio();
     }
     perform_time_stretching = enable;
+    speed_governor_factor = 1.0;
+}
+
+void EnableSpeedGovernor(bool enable) {
+    std::lock_guard<std::mutex> lock(output_mutex);
+
+    perform_speed_governing = enable;
+    smoothed_queue_depth = 0.0;
+    speed_governor_factor = 1.0;
+}
+
+double GetSpeedGovernorFactor() {
+    return speed_governor_factor;
+}
+
+/// Set from the UI thread, read by the sources on the emulation thread
+static std::atomic<bool> polyphase_interpolation_enabled{false};
+
+void EnablePolyphaseInterpolation(bool enable) {
+    polyphase_interpolation_enabled = enable;
+}
+
+bool IsPolyphaseInterpolationEnabled() {
+    return polyphase_interpolation_enabled;
+}
+
+// Audio thread
+//
+// Frames are generated on a dedicated thread so that decoding, mixing and time stretching don't
+// hold up the emulated CPU. Each tick the emulation thread copies the inputs of a frame out of
+// shared memory and hands them to the audio thread. The outputs are written back on the next
+// tick, one frame later than the hardware would.
+
+static std::thread audio_thread;
+static bool audio_thread_exit = false;
+static Common::Event frame_requested;
+static Common::Event frame_finished;
+/// Whether the audio thread is working on frame_input. Only accessed by the emulation thread.
+static bool frame_in_flight = false;
+
+static FrameInput frame_input;
+static FrameOutput frame_output;
+
+static void AudioThread() {
+    while (true) {
+        frame_requested.Wait();
+        if (audio_thread_exit)
+            break;
+
+        OutputCurrentFrame(GenerateFrame(frame_input, frame_output), frame_input.timestamp);
+        frame_finished.Set();
+    }
+}
+
+static void WaitForFrame() {
+    if (!frame_in_flight)
+        return;
+
+    frame_finished.Wait();
+    frame_in_flight = false;
+}
+
+static void StartAudioThread() {
+    audio_thread_exit = false;
+    audio_thread = std::thread(AudioThread);
+}
+
+static void StopAudioThread() {
+    if (!audio_thread.joinable())
+        return;
+
+    WaitForFrame();
+    audio_thread_exit = true;
+    frame_requested.Set();
+    audio_thread.join();
+}
+
+/**
+ * Copies the inputs of the next frame out of shared memory and acknowledges the configuration
+ * updates by clearing their dirty flags, as the sources and mixers would on their copy.
+ */
+static void ReadFrameInput(SharedMemory& read) {
+    // The DSP structures are plain data, but BitField doesn't allow copy assignment. The casts
+    // tell the compiler that copying their bytes is intended.
+    std::memcpy(static_cast<void*>(&frame_input.source_configurations),
+                &read.source_configurations, sizeof(SourceConfiguration));
+    std::memcpy(&frame_input.adpcm_coefficients, &read.adpcm_coefficients,
+                sizeof(AdpcmCoefficients));
+    std::memcpy(static_cast<void*>(&frame_input.dsp_configuration), &read.dsp_configuration,
+                sizeof(DspConfiguration));
+    std::memcpy(&frame_input.intermediate_mix_samples, &read.intermediate_mix_samples,
+                sizeof(IntermediateMixSamples));
+
+    for (auto& config : read.source_configurations.config) {
+        if (config.buffer_queue_dirty) {
+            config.buffers_dirty = 0;
+        }
+        config.dirty_raw = 0;
+    }
+    read.dsp_configuration.dirty_raw = 0;
+}
+
+static void WriteFrameOutput(SharedMemory& write) {
+    std::memcpy(&write.source_statuses, &frame_output.source_statuses, sizeof(SourceStatus));
+    std::memcpy(&write.dsp_status, &frame_output.dsp_status, sizeof(DspStatus));
+    std::memcpy(&write.intermediate_mix_samples, &frame_output.intermediate_mix_samples,
+                sizeof(IntermediateMixSamples));
+    std::memcpy(&write.final_samples, &frame_output.final_samples, sizeof(FinalMixSamples));
 }
 
 // Public Interface
@@ -136,34 +323,48 @@ void Init() {
     }
 
     mixers.Reset();
+    std::memset(&frame_output, 0, sizeof(frame_output));
 
-    time_stretcher.Reset();
-    if (sink) {
-        time_stretcher.SetOutputSampleRate(sink->GetNativeSampleRate());
+    {
+        std::lock_guard<std::mutex> lock(output_mutex);
+        time_stretcher.Reset();
+        if (sink) {
+            time_stretcher.SetOutputSampleRate(sink->GetNativeSampleRate());
+        }
     }
+
+    StartAudioThread();
 }
 
 void Shutdown() {
+    StopAudioThread();
+
+    std::lock_guard<std::mutex> lock(output_mutex);
     if (perform_time_stretching) {
         FlushResidualStretcherAudio();
     }
 }
 
 bool Tick() {
-    StereoFrame16 current_frame = {};
-
     // TODO: Check dsp::DSP semaphore (which indicates emulated application has finished writing to
     // shared memory region)
-    current_frame = GenerateCurrentFrame();
+    WaitForFrame();
+    WriteFrameOutput(WriteRegion());
 
-    OutputCurrentFrame(current_frame);
+    ReadFrameInput(ReadRegion());
+    frame_input.timestamp = CoreTiming::GetTicks();
+    frame_in_flight = true;
+    frame_requested.Set();
 
     return true;
 }
 
 void SetSink(std::unique_ptr<AudioCore::Sink> sink_) {
+    std::lock_guard<std::mutex> lock(output_mutex);
     sink = std::move(sink_);
     time_stretcher.SetOutputSampleRate(sink->GetNativeSampleRate());
+    smoothed_queue_depth = 0.0;
+    speed_governor_factor = 1.0;
 }
 
 } // namespace HLE
@@ -576,5 +576,32 @@ void SetSink(std::unique_ptr<AudioCore::Sink> sink);
  */
 void EnableStretching(bool enable);
 
+/**
+ * Enables/Disables the speed governor.
+ * While audio stretching is disabled, the governor keeps audio latency steady by asking for
+ * emulation speed to be adjusted by a few percent, instead of dropping audio that backs up.
+ * @param enable true to enable, false to disable.
+ */
+void EnableSpeedGovernor(bool enable);
+
+/**
+ * Selects how sources requesting polyphase interpolation are resampled.
+ * @param enable true to use the windowed-sinc polyphase filter, false to use linear interpolation.
+ */
+void EnablePolyphaseInterpolation(bool enable);
+
+/**
+ * Whether sources requesting polyphase interpolation use the polyphase filter. Safe to call from
+ * any thread.
+ */
+bool IsPolyphaseInterpolationEnabled();
+
+/**
+ * Gets the factor the speed governor wants emulation speed scaled by, so that the audio queued in
+ * the sink stays at its target latency. Safe to call from any thread.
+ * @return The speed factor. 1.0 while the governor is inactive.
+ */
+double GetSpeedGovernorFactor();
+
 } // namespace HLE
 } // namespace DSP
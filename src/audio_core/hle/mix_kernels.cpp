@@ -0,0 +1,198 @@
+// Copyright 2017 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include "audio_core/hle/mix_kernels.h"
+#include "common/math_util.h"
+
+#ifdef ARCHITECTURE_x86_64
+#include <emmintrin.h>
+#endif // ARCHITECTURE_x86_64
+
+namespace DSP {
+namespace HLE {
+namespace Kernels {
+
+// The vectorized kernels perform the same float operations in the same order as the scalar
+// code, and truncate and saturate the same way, so their results are bit-identical.
+
+static_assert(samples_per_frame % 4 == 0, "The kernels process four samples at a time");
+static_assert(sizeof(StereoFrame16) == samples_per_frame * 2 * sizeof(s16),
+              "Stereo frames must be tightly packed");
+static_assert(sizeof(QuadFrame32) == samples_per_frame * 4 * sizeof(s32),
+              "Quadraphonic frames must be tightly packed");
+
+#ifdef ARCHITECTURE_x86_64
+
+/// Transposes four vectors of four 32-bit lanes
+static void Transpose4x4(__m128i& r0, __m128i& r1, __m128i& r2, __m128i& r3) {
+    const __m128i t0 = _mm_unpacklo_epi32(r0, r1);
+    const __m128i t1 = _mm_unpackhi_epi32(r0, r1);
+    const __m128i t2 = _mm_unpacklo_epi32(r2, r3);
+    const __m128i t3 = _mm_unpackhi_epi32(r2, r3);
+    r0 = _mm_unpacklo_epi64(t0, t2);
+    r1 = _mm_unpackhi_epi64(t0, t2);
+    r2 = _mm_unpacklo_epi64(t1, t3);
+    r3 = _mm_unpackhi_epi64(t1, t3);
+}
+
+/// Loads the quadraphonic sample at index i, converted to float and scaled by gain
+static __m128 LoadScaledQuad(const QuadFrame32& samples, size_t i, __m128 gain) {
+    const __m128i quad = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&samples[i]));
+    return _mm_mul_ps(gain, _mm_cvtepi32_ps(quad));
+}
+
+/// Adds eight 16-bit values to four stereo samples of accumulator starting at i, saturating
+static void AddToAccumulator(StereoFrame16& accumulator, size_t i, __m128i values) {
+    __m128i* dst = reinterpret_cast<__m128i*>(&accumulator[i]);
+    _mm_storeu_si128(dst, _mm_adds_epi16(_mm_loadu_si128(dst), values));
+}
+
+#else
+
+static s16 ClampToS16(s32 value) {
+    return static_cast<s16>(MathUtil::Clamp(value, -32768, 32767));
+}
+
+static std::array<s16, 2> AddAndClampToS16(const std::array<s16, 2>& a,
+                                           const std::array<s16, 2>& b) {
+    return {ClampToS16(static_cast<s32>(a[0]) + static_cast<s32>(b[0])),
+            ClampToS16(static_cast<s32>(a[1]) + static_cast<s32>(b[1]))};
+}
+
+#endif // ARCHITECTURE_x86_64
+
+void GainMix(const StereoFrame16& samples, const std::array<float, 4>& gains, QuadFrame32& dest) {
+#ifdef ARCHITECTURE_x86_64
+    const __m128 gain = _mm_loadu_ps(gains.data());
+    for (size_t i = 0; i < samples_per_frame; i += 4) {
+        const __m128i stereo = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&samples[i]));
+        // Sign-extend to [L, R] pairs of 32-bit lanes
+        const __m128i lo = _mm_srai_epi32(_mm_unpacklo_epi16(stereo, stereo), 16);
+        const __m128i hi = _mm_srai_epi32(_mm_unpackhi_epi16(stereo, stereo), 16);
+        const __m128i quads[4] = {
+            _mm_shuffle_epi32(lo, _MM_SHUFFLE(1, 0, 1, 0)),
+            _mm_shuffle_epi32(lo, _MM_SHUFFLE(3, 2, 3, 2)),
+            _mm_shuffle_epi32(hi, _MM_SHUFFLE(1, 0, 1, 0)),
+            _mm_shuffle_epi32(hi, _MM_SHUFFLE(3, 2, 3, 2)),
+        };
+
+        for (size_t j = 0; j < 4; ++j) {
+            __m128i* out = reinterpret_cast<__m128i*>(&dest[i + j]);
+            const __m128i scaled = _mm_cvttps_epi32(_mm_mul_ps(gain, _mm_cvtepi32_ps(quads[j])));
+            _mm_storeu_si128(out, _mm_add_epi32(_mm_loadu_si128(out), scaled));
+        }
+    }
+#else
+    for (size_t i = 0; i < samples_per_frame; i++) {
+        dest[i][0] += static_cast<s32>(gains[0] * samples[i][0]);
+        dest[i][1] += static_cast<s32>(gains[1] * samples[i][1]);
+        dest[i][2] += static_cast<s32>(gains[2] * samples[i][0]);
+        dest[i][3] += static_cast<s32>(gains[3] * samples[i][1]);
+    }
+#endif // ARCHITECTURE_x86_64
+}
+
+void DownmixStereoAndMix(float gain, const QuadFrame32& samples, StereoFrame16& accumulator) {
+#ifdef ARCHITECTURE_x86_64
+    const __m128 gain_vec = _mm_set1_ps(gain);
+    for (size_t i = 0; i < samples_per_frame; i += 4) {
+        const __m128 q0 = LoadScaledQuad(samples, i + 0, gain_vec);
+        const __m128 q1 = LoadScaledQuad(samples, i + 1, gain_vec);
+        const __m128 q2 = LoadScaledQuad(samples, i + 2, gain_vec);
+        const __m128 q3 = LoadScaledQuad(samples, i + 3, gain_vec);
+        // [0] + [2] and [1] + [3] of two samples each
+        const __m128 lr01 = _mm_add_ps(_mm_movelh_ps(q0, q1), _mm_movehl_ps(q1, q0));
+        const __m128 lr23 = _mm_add_ps(_mm_movelh_ps(q2, q3), _mm_movehl_ps(q3, q2));
+        const __m128i stereo = _mm_packs_epi32(_mm_cvttps_epi32(lr01), _mm_cvttps_epi32(lr23));
+        AddToAccumulator(accumulator, i, stereo);
+    }
+#else
+    for (size_t i = 0; i < samples_per_frame; i++) {
+        const auto& sample = samples[i];
+        s16 left = ClampToS16(static_cast<s32>(gain * sample[0] + gain * sample[2]));
+        s16 right = ClampToS16(static_cast<s32>(gain * sample[1] + gain * sample[3]));
+        accumulator[i] = AddAndClampToS16(accumulator[i], {left, right});
+    }
+#endif // ARCHITECTURE_x86_64
+}
+
+void DownmixMonoAndMix(float gain, const QuadFrame32& samples, StereoFrame16& accumulator) {
+#ifdef ARCHITECTURE_x86_64
+    const __m128 gain_vec = _mm_set1_ps(gain);
+    for (size_t i = 0; i < samples_per_frame; i += 4) {
+        __m128i c0 = _mm_castps_si128(LoadScaledQuad(samples, i + 0, gain_vec));
+        __m128i c1 = _mm_castps_si128(LoadScaledQuad(samples, i + 1, gain_vec));
+        __m128i c2 = _mm_castps_si128(LoadScaledQuad(samples, i + 2, gain_vec));
+        __m128i c3 = _mm_castps_si128(LoadScaledQuad(samples, i + 3, gain_vec));
+        Transpose4x4(c0, c1, c2, c3);
+
+        // Summed left to right like the scalar expression
+        __m128 sum = _mm_add_ps(_mm_castsi128_ps(c0), _mm_castsi128_ps(c1));
+        sum = _mm_add_ps(sum, _mm_castsi128_ps(c2));
+        sum = _mm_add_ps(sum, _mm_castsi128_ps(c3));
+        sum = _mm_mul_ps(sum, _mm_set1_ps(0.5f));
+
+        const __m128i mono = _mm_cvttps_epi32(sum);
+        const __m128i packed = _mm_packs_epi32(mono, mono);
+        AddToAccumulator(accumulator, i, _mm_unpacklo_epi16(packed, packed));
+    }
+#else
+    for (size_t i = 0; i < samples_per_frame; i++) {
+        const auto& sample = samples[i];
+        s16 mono = ClampToS16(static_cast<s32>(
+            (gain * sample[0] + gain * sample[1] + gain * sample[2] + gain * sample[3]) / 2));
+        accumulator[i] = AddAndClampToS16(accumulator[i], {mono, mono});
+    }
+#endif // ARCHITECTURE_x86_64
+}
+
+void Deinterleave(const QuadFrame32& samples, s32_le (&pcm32)[4][samples_per_frame]) {
+#ifdef ARCHITECTURE_x86_64
+    for (size_t i = 0; i < samples_per_frame; i += 4) {
+        const __m128i* src = reinterpret_cast<const __m128i*>(&samples[i]);
+        __m128i r0 = _mm_loadu_si128(src + 0);
+        __m128i r1 = _mm_loadu_si128(src + 1);
+        __m128i r2 = _mm_loadu_si128(src + 2);
+        __m128i r3 = _mm_loadu_si128(src + 3);
+        Transpose4x4(r0, r1, r2, r3);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(&pcm32[0][i]), r0);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(&pcm32[1][i]), r1);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(&pcm32[2][i]), r2);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(&pcm32[3][i]), r3);
+    }
+#else
+    for (size_t sample = 0; sample < samples_per_frame; sample++) {
+        for (size_t channel = 0; channel < 4; channel++) {
+            pcm32[channel][sample] = samples[sample][channel];
+        }
+    }
+#endif // ARCHITECTURE_x86_64
+}
+
+void Interleave(const s32_le (&pcm32)[4][samples_per_frame], QuadFrame32& samples) {
+#ifdef ARCHITECTURE_x86_64
+    for (size_t i = 0; i < samples_per_frame; i += 4) {
+        __m128i r0 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&pcm32[0][i]));
+        __m128i r1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&pcm32[1][i]));
+        __m128i r2 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&pcm32[2][i]));
+        __m128i r3 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&pcm32[3][i]));
+        Transpose4x4(r0, r1, r2, r3);
+        __m128i* dst = reinterpret_cast<__m128i*>(&samples[i]);
+        _mm_storeu_si128(dst + 0, r0);
+        _mm_storeu_si128(dst + 1, r1);
+        _mm_storeu_si128(dst + 2, r2);
+        _mm_storeu_si128(dst + 3, r3);
+    }
+#else
+    for (size_t sample = 0; sample < samples_per_frame; sample++) {
+        for (size_t channel = 0; channel < 4; channel++) {
+            samples[sample][channel] = pcm32[channel][sample];
+        }
+    }
+#endif // ARCHITECTURE_x86_64
+}
+
+} // namespace Kernels
+} // namespace HLE
+} // namespace DSP
@@ -0,0 +1,45 @@
+// Copyright 2017 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <array>
+#include "audio_core/hle/common.h"
+#include "common/common_types.h"
+#include "common/swap.h"
+
+namespace DSP {
+namespace HLE {
+namespace Kernels {
+
+/**
+ * Scales a stereo frame into the four channels of a quadraphonic mix and adds it to the mix.
+ * Channels 0 and 2 take the left input, channels 1 and 3 the right input.
+ * @param samples Stereo source frame
+ * @param gains Gain of each quadraphonic channel
+ * @param dest Quadraphonic mix accumulating the scaled samples
+ */
+void GainMix(const StereoFrame16& samples, const std::array<float, 4>& gains, QuadFrame32& dest);
+
+/**
+ * Downmixes a quadraphonic frame to stereo, scales it by gain and adds it to accumulator.
+ * Both the downmixed samples and the sums saturate to the 16-bit range.
+ */
+void DownmixStereoAndMix(float gain, const QuadFrame32& samples, StereoFrame16& accumulator);
+
+/**
+ * Downmixes a quadraphonic frame to mono, scales it by gain and adds it to both channels of
+ * accumulator. Both the downmixed samples and the sums saturate to the 16-bit range.
+ */
+void DownmixMonoAndMix(float gain, const QuadFrame32& samples, StereoFrame16& accumulator);
+
+/// Converts a frame from sample-major to the channel-major layout used in shared memory
+void Deinterleave(const QuadFrame32& samples, s32_le (&pcm32)[4][samples_per_frame]);
+
+/// Converts a frame from the channel-major layout used in shared memory to sample-major
+void Interleave(const s32_le (&pcm32)[4][samples_per_frame], QuadFrame32& samples);
+
+} // namespace Kernels
+} // namespace HLE
+} // namespace DSP
@@ -4,10 +4,14 @@
 
 #include <algorithm>
 #include <array>
+#include <cstring>
 #include "audio_core/codec.h"
 #include "audio_core/hle/common.h"
+#include "audio_core/hle/dsp.h"
+#include "audio_core/hle/mix_kernels.h"
 #include "audio_core/hle/source.h"
 #include "audio_core/interpolate.h"
+#include "common/alignment.h"
 #include "common/assert.h"
 #include "common/logging/log.h"
 #include "core/memory.h"
@@ -30,14 +34,8 @@ void Source::MixInto(QuadFrame32& dest, size_t intermediate_mix_id) const {
     if (!state.enabled)
         return;
 
-    const std::array<float, 4>& gains = state.gain.at(intermediate_mix_id);
-    for (size_t samplei = 0; samplei < samples_per_frame; samplei++) {
-        // Conversion from stereo (current_frame) to quadraphonic (dest) occurs here.
-        dest[samplei][0] += static_cast<s32>(gains[0] * current_frame[samplei][0]);
-        dest[samplei][1] += static_cast<s32>(gains[1] * current_frame[samplei][1]);
-        dest[samplei][2] += static_cast<s32>(gains[2] * current_frame[samplei][0]);
-        dest[samplei][3] += static_cast<s32>(gains[3] * current_frame[samplei][1]);
-    }
+    // Conversion from stereo (current_frame) to quadraphonic (dest) occurs here.
+    Kernels::GainMix(current_frame, state.gain.at(intermediate_mix_id), dest);
 }
 
 void Source::Reset() {
@@ -220,7 +218,7 @@ void Source::ParseConfig(SourceConfiguration::Configuration& config,
 void Source::GenerateFrame() {
     current_frame.fill({});
 
-    if (state.current_buffer.empty() && !DequeueBuffer()) {
+    if (!state.current_buffer.active && !DequeueBuffer()) {
         state.enabled = false;
         state.buffer_update = true;
         state.current_buffer_id = 0;
@@ -231,27 +229,25 @@ void Source::GenerateFrame() {
 
     state.current_sample_number = state.next_sample_number;
     while (frame_position < current_frame.size()) {
-        if (state.current_buffer.empty() && !DequeueBuffer()) {
-            break;
+        if (!state.current_buffer.active) {
+            // Buffers that are too short or invalid leave current_buffer inactive
+            if (!DequeueBuffer())
+                break;
+            continue;
         }
 
-        const size_t size_to_copy =
-            std::min(state.current_buffer.size(), current_frame.size() - frame_position);
-
-        std::copy(state.current_buffer.begin(), state.current_buffer.begin() + size_to_copy,
-                  current_frame.begin() + frame_position);
-        state.current_buffer.erase(state.current_buffer.begin(),
-                                   state.current_buffer.begin() + size_to_copy);
+        const size_t size_read = ReadCurrentBuffer(&current_frame[frame_position],
+                                                   current_frame.size() - frame_position);
 
-        frame_position += size_to_copy;
-        state.next_sample_number += static_cast<u32>(size_to_copy);
+        frame_position += size_read;
+        state.next_sample_number += static_cast<u32>(size_read);
     }
 
     state.filters.ProcessFrame(current_frame);
 }
 
 bool Source::DequeueBuffer() {
-    ASSERT_MSG(state.current_buffer.empty(),
+    ASSERT_MSG(!state.current_buffer.active,
                "Shouldn't dequeue; we still have data in current_buffer");
 
     if (state.input_queue.empty())
@@ -269,62 +265,172 @@ bool Source::DequeueBuffer() {
     }
 
     const u8* const memory = Memory::GetPhysicalPointer(buf.physical_address);
-    if (memory) {
-        const unsigned num_channels = buf.mono_or_stereo == MonoOrStereo::Stereo ? 2 : 1;
-        switch (buf.format) {
-        case Format::PCM8:
-            state.current_buffer = Codec::DecodePCM8(num_channels, memory, buf.length);
-            break;
-        case Format::PCM16:
-            state.current_buffer = Codec::DecodePCM16(num_channels, memory, buf.length);
-            break;
-        case Format::ADPCM:
-            DEBUG_ASSERT(num_channels == 1);
-            state.current_buffer =
-                Codec::DecodeADPCM(memory, buf.length, state.adpcm_coeffs, state.adpcm_state);
-            break;
-        default:
-            UNIMPLEMENTED();
-            break;
-        }
-    } else {
+    if (!memory) {
         LOG_WARNING(Audio_DSP,
                     "source_id=%zu buffer_id=%hu length=%u: Invalid physical address 0x%08X",
                     source_id, buf.buffer_id, buf.length, buf.physical_address);
-        state.current_buffer.clear();
         return true;
     }
 
-    switch (state.interpolation_mode) {
-    case InterpolationMode::None:
-        state.current_buffer =
-            AudioInterp::None(state.interp_state, state.current_buffer, state.rate_multiplier);
-        break;
-    case InterpolationMode::Linear:
-        state.current_buffer =
-            AudioInterp::Linear(state.interp_state, state.current_buffer, state.rate_multiplier);
+    CurrentBuffer& current = state.current_buffer;
+    current.memory = memory;
+    current.length = buf.length;
+    current.decoded = 0;
+    current.format = buf.format;
+    current.num_channels = buf.mono_or_stereo == MonoOrStereo::Stereo ? 2 : 1;
+    current.interpolation_mode = state.interpolation_mode;
+    current.step_size = AudioInterp::StepSize(state.rate_multiplier);
+
+    switch (buf.format) {
+    case Format::PCM8:
+    case Format::PCM16:
         break;
-    case InterpolationMode::Polyphase:
-        // TODO(merry): Implement polyphase interpolation
-        state.current_buffer =
-            AudioInterp::Linear(state.interp_state, state.current_buffer, state.rate_multiplier);
+    case Format::ADPCM:
+        DEBUG_ASSERT(current.num_channels == 1);
+        // ADPCM samples are decoded in pairs
+        current.length += current.length % 2;
         break;
     default:
         UNIMPLEMENTED();
+        current.length = 0;
         break;
     }
 
+    // Resampling starts with the history of the previous buffer
+    const AudioInterp::State& history = state.interp_state;
+    std::copy(history.xn_earlier.begin(), history.xn_earlier.end(), current.window.begin());
+    current.window[AudioInterp::polyphase_history] = history.xn2;
+    current.window[AudioInterp::polyphase_history + 1] = history.xn1;
+    current.window_count = AudioInterp::polyphase_taps;
+    current.window_start = 0;
+    current.fposition = 0;
+
+    // Buffers too short to resample produce no output and leave the history alone
+    current.active = current.length >= 2;
+
     state.current_sample_number = 0;
     state.next_sample_number = 0;
     state.buffer_update = buf.from_queue && (state.current_buffer_id != buf.buffer_id);
     state.current_buffer_id = buf.buffer_id;
 
-    LOG_TRACE(Audio_DSP, "source_id=%zu buffer_id=%hu from_queue=%s current_buffer.size()=%zu",
-              source_id, buf.buffer_id, buf.from_queue ? "true" : "false",
-              state.current_buffer.size());
+    LOG_TRACE(Audio_DSP, "source_id=%zu buffer_id=%hu from_queue=%s length=%u", source_id,
+              buf.buffer_id, buf.from_queue ? "true" : "false", current.length);
     return true;
 }
 
+size_t Source::ReadCurrentBuffer(std::array<s16, 2>* output, size_t max_output) {
+    CurrentBuffer& current = state.current_buffer;
+    size_t count = 0;
+
+    while (count < max_output) {
+        // Resample as far as the decoded samples reach, relative to the window
+        const u64 window_fposition = current.window_start * AudioInterp::scale_factor;
+        const u64 max_fposition = current.decoded * AudioInterp::scale_factor - window_fposition;
+        u64 fposition = current.fposition - window_fposition;
+        const std::array<s16, 2>* const input =
+            current.window.data() + AudioInterp::polyphase_history;
+
+        switch (current.interpolation_mode) {
+        case InterpolationMode::None:
+            count += AudioInterp::None(input, fposition, current.step_size, max_fposition,
+                                       output + count, max_output - count);
+            break;
+        case InterpolationMode::Linear:
+            count += AudioInterp::Linear(input, fposition, current.step_size, max_fposition,
+                                         output + count, max_output - count);
+            break;
+        case InterpolationMode::Polyphase:
+            if (IsPolyphaseInterpolationEnabled()) {
+                count += AudioInterp::Polyphase(input, fposition, current.step_size,
+                                                max_fposition, output + count, max_output - count);
+            } else {
+                count += AudioInterp::Linear(input, fposition, current.step_size, max_fposition,
+                                             output + count, max_output - count);
+            }
+            break;
+        default:
+            UNIMPLEMENTED();
+            break;
+        }
+
+        current.fposition = fposition + window_fposition;
+
+        if (count == max_output)
+            break;
+
+        if (current.decoded == current.length) {
+            // The history for the next buffer is never dropped from the window
+            AudioInterp::State& history = state.interp_state;
+            const auto end = current.window.begin() + current.window_count;
+            std::copy(end - AudioInterp::polyphase_taps, end - 2, history.xn_earlier.begin());
+            history.xn2 = end[-2];
+            history.xn1 = end[-1];
+            current.active = false;
+            break;
+        }
+
+        DecodeCurrentBuffer(max_output - count);
+    }
+
+    return count;
+}
+
+void Source::DecodeCurrentBuffer(size_t output_count) {
+    CurrentBuffer& current = state.current_buffer;
+
+    // Drop the samples resampling has moved past, keeping the history it needs
+    const size_t position = static_cast<size_t>(current.fposition / AudioInterp::scale_factor);
+    const size_t drop = std::min(position - current.window_start,
+                                 current.window_count - AudioInterp::polyphase_taps);
+    std::memmove(current.window.data(), current.window.data() + drop,
+                 (current.window_count - drop) * sizeof(current.window[0]));
+    current.window_start += static_cast<u32>(drop);
+    current.window_count -= drop;
+
+    // Decode what the next output_count outputs need, bounded by the free space
+    const u64 last_fposition = current.fposition + (output_count - 1) * current.step_size;
+    const size_t needed =
+        static_cast<size_t>(last_fposition / AudioInterp::scale_factor) + 1 - current.decoded;
+    const size_t free_space = current.window.size() - current.window_count;
+    constexpr size_t adpcm_frame_samples = Codec::ADPCM_SAMPLES_PER_FRAME;
+
+    size_t to_decode;
+    if (current.format == Format::ADPCM) {
+        // ADPCM is decoded from a frame boundary in whole frames, except at the end of the buffer
+        to_decode = std::min(Common::AlignUp(needed, adpcm_frame_samples),
+                             Common::AlignDown(free_space, adpcm_frame_samples));
+    } else {
+        to_decode = std::min(needed, free_space);
+    }
+    to_decode = std::min<size_t>(to_decode, current.length - current.decoded);
+
+    std::array<s16, 2>* const output = current.window.data() + current.window_count;
+    const size_t offset = current.decoded;
+
+    switch (current.format) {
+    case Format::PCM8:
+        Codec::DecodePCM8(current.num_channels, current.memory + offset * current.num_channels,
+                          to_decode, output);
+        break;
+    case Format::PCM16:
+        Codec::DecodePCM16(current.num_channels,
+                           current.memory + offset * current.num_channels * sizeof(s16), to_decode,
+                           output);
+        break;
+    case Format::ADPCM:
+        Codec::DecodeADPCM(
+            current.memory + offset / adpcm_frame_samples * Codec::ADPCM_FRAME_SIZE, to_decode,
+            state.adpcm_coeffs, state.adpcm_state, output);
+        break;
+    default:
+        UNIMPLEMENTED();
+        break;
+    }
+
+    current.decoded += static_cast<u32>(to_decode);
+    current.window_count += to_decode;
+}
+
 SourceStatus::Status Source::GetCurrentStatus() {
     SourceStatus::Status ret;
 
@@ -78,6 +78,35 @@ private:
         bool from_queue;
     };
 
+    /// Capacity of the window of decoded samples, including the history that resampling needs.
+    static constexpr size_t decode_window_size = 2 * samples_per_frame;
+
+    /**
+     * The buffer being played. Rather than decoding it whole when it is dequeued, it is decoded a
+     * block at a time into a window as resampling reaches its samples.
+     */
+    struct CurrentBuffer {
+        bool active = false;
+
+        const u8* memory = nullptr;
+        u32 length = 0;  ///< Length in samples
+        u32 decoded = 0; ///< Number of samples decoded so far
+        Format format = Format::ADPCM;
+        unsigned num_channels = 1;
+
+        InterpolationMode interpolation_mode = InterpolationMode::Polyphase;
+        u64 step_size = 0;
+
+        /// Resampling position. Sample 0 is the second to last sample of the previous buffer, so
+        /// buffer sample n is sample n + 2.
+        u64 fposition = 0;
+        /// Index of the sample in window[AudioInterp::polyphase_history]. The samples before it
+        /// are history for the polyphase filter.
+        u32 window_start = 0;
+        size_t window_count = 0;
+        std::array<std::array<s16, 2>, decode_window_size> window;
+    };
+
     struct BufferOrder {
         bool operator()(const Buffer& a, const Buffer& b) const {
             // Lower buffer_id comes first.
@@ -106,7 +135,7 @@ private:
 
         u32 current_sample_number = 0;
         u32 next_sample_number = 0;
-        std::vector<std::array<s16, 2>> current_buffer;
+        CurrentBuffer current_buffer;
 
         // buffer_id state
 
@@ -136,9 +165,14 @@ private:
     void ParseConfig(SourceConfiguration::Configuration& config, const s16_le (&adpcm_coeffs)[16]);
     /// INTERNAL: Generate the current audio output for this frame based on our internal state.
     void GenerateFrame();
-    /// INTERNAL: Dequeues a buffer and does preprocessing on it (decoding, resampling). Puts it
-    /// into current_buffer.
+    /// INTERNAL: Dequeues a buffer and prepares current_buffer for decoding and resampling it.
     bool DequeueBuffer();
+    /// INTERNAL: Resamples up to max_output samples of current_buffer into output, decoding as
+    /// needed. Returns the number of samples written.
+    size_t ReadCurrentBuffer(std::array<s16, 2>* output, size_t max_output);
+    /// INTERNAL: Decodes more of current_buffer into its window, enough for the next
+    /// output_count output samples if there is space.
+    void DecodeCurrentBuffer(size_t output_count);
     /// INTERNAL: Generates a SourceStatus::Status based on our internal state.
     SourceStatus::Status GetCurrentStatus();
 };
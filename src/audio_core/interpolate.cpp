@@ -2,85 +2,340 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <vector>
 #include "audio_core/interpolate.h"
 #include "common/assert.h"
 #include "common/math_util.h"
 
+#ifdef ARCHITECTURE_x86_64
+#include <emmintrin.h>
+#endif // ARCHITECTURE_x86_64
+
 namespace AudioInterp {
 
 // Calculations are done in fixed point with 24 fractional bits.
 // (This is not verified. This was chosen for minimal error.)
-constexpr u64 scale_factor = 1 << 24;
 constexpr u64 scale_mask = scale_factor - 1;
 
-/// Here we step over the input in steps of rate_multiplier, until we consume all of the input.
-/// Three adjacent samples are passed to fn each step.
-template <typename Function>
-static StereoBuffer16 StepOverSamples(State& state, const StereoBuffer16& input,
-                                      float rate_multiplier, Function fn) {
+u64 StepSize(float rate_multiplier) {
     ASSERT(rate_multiplier > 0);
+    return static_cast<u64>(rate_multiplier * scale_factor);
+}
+
+/// Here we step over the input window in steps of step_size, until we reach max_fposition or fill
+/// the output. The two samples around each position are passed to fn. bulk_fn may produce any
+/// number of leading steps at once, returning how many it wrote.
+template <typename Function, typename BulkFunction>
+static size_t StepOverSamples(const std::array<s16, 2>* input, u64& fposition, u64 step_size,
+                              u64 max_fposition, std::array<s16, 2>* output, size_t max_output,
+                              Function fn, BulkFunction bulk_fn) {
+    size_t count = bulk_fn(input, fposition, step_size, max_fposition, output, max_output);
+
+    while (count < max_output && fposition < max_fposition) {
+        u64 fraction = fposition & scale_mask;
+
+        size_t index = static_cast<size_t>(fposition / scale_factor);
+        output[count++] = fn(fraction, input[index], input[index + 1]);
 
+        fposition += step_size;
+    }
+
+    return count;
+}
+
+template <typename Function>
+static size_t StepOverSamples(const std::array<s16, 2>* input, u64& fposition, u64 step_size,
+                              u64 max_fposition, std::array<s16, 2>* output, size_t max_output,
+                              Function fn) {
+    return StepOverSamples(input, fposition, step_size, max_fposition, output, max_output, fn,
+                           [](const std::array<s16, 2>*, u64&, u64, u64, std::array<s16, 2>*,
+                              size_t) -> size_t { return 0; });
+}
+
+/// Resamples a whole buffer, with the history samples from state in front of it.
+template <typename Resampler>
+static StereoBuffer16 ResampleBuffer(State& state, const StereoBuffer16& input,
+                                     float rate_multiplier, Resampler resampler) {
     if (input.size() < 2)
         return {};
 
-    StereoBuffer16 output;
-    output.reserve(static_cast<size_t>(input.size() / rate_multiplier));
+    StereoBuffer16 window;
+    window.reserve(polyphase_taps + input.size());
+    window.insert(window.end(), state.xn_earlier.begin(), state.xn_earlier.end());
+    window.push_back(state.xn2);
+    window.push_back(state.xn1);
+    window.insert(window.end(), input.begin(), input.end());
 
-    u64 step_size = static_cast<u64>(rate_multiplier * scale_factor);
+    const u64 step_size = StepSize(rate_multiplier);
+    const u64 max_fposition = input.size() * scale_factor;
 
+    StereoBuffer16 output((max_fposition + step_size - 1) / step_size);
     u64 fposition = 0;
-    const u64 max_fposition = input.size() * scale_factor;
+    output.resize(resampler(window.data() + polyphase_history, fposition, step_size,
+                            max_fposition, output.data(), output.size()));
 
-    while (fposition < 1 * scale_factor) {
-        u64 fraction = fposition & scale_mask;
+    const auto history = window.end() - polyphase_taps;
+    std::copy(history, history + polyphase_history, state.xn_earlier.begin());
+    state.xn2 = input[input.size() - 2];
+    state.xn1 = input[input.size() - 1];
 
-        output.push_back(fn(fraction, state.xn2, state.xn1, input[0]));
+    return output;
+}
 
-        fposition += step_size;
+static std::array<s16, 2> LinearStep(u64 fraction, const std::array<s16, 2>& x0,
+                                     const std::array<s16, 2>& x1) {
+    // This is a saturated subtraction. (Verified by black-box fuzzing.)
+    s64 delta0 = MathUtil::Clamp<s64>(x1[0] - x0[0], -32768, 32767);
+    s64 delta1 = MathUtil::Clamp<s64>(x1[1] - x0[1], -32768, 32767);
+
+    return std::array<s16, 2>{
+        static_cast<s16>(x0[0] + fraction * delta0 / scale_factor),
+        static_cast<s16>(x0[1] + fraction * delta1 / scale_factor),
+    };
+}
+
+#ifdef ARCHITECTURE_x86_64
+
+/**
+ * Produces the steps of linear interpolation four at a time, with results identical to
+ * LinearStep. The unsigned arithmetic there amounts to x0 + floor(fraction * delta / 2^24),
+ * which is computed here from two 12-bit halves of the fraction so that every product fits into
+ * 32 bits.
+ */
+static size_t LinearBulk(const std::array<s16, 2>* input, u64& fposition, u64 step_size,
+                         u64 max_fposition, std::array<s16, 2>* output, size_t max_output) {
+    constexpr u64 half_bits = 12;
+    constexpr u64 half_mask = (1 << half_bits) - 1;
+
+    size_t count = 0;
+    while (count + 4 <= max_output && fposition + 3 * step_size < max_fposition) {
+        // Each step reads two adjacent samples, [x0 x1], with one 64-bit load
+        __m128i pairs[4];
+        for (size_t i = 0; i < 4; ++i) {
+            const size_t index = static_cast<size_t>((fposition + i * step_size) / scale_factor);
+            pairs[i] = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(&input[index]));
+        }
+        const __m128i pairs01 = _mm_unpacklo_epi32(pairs[0], pairs[1]);
+        const __m128i pairs23 = _mm_unpacklo_epi32(pairs[2], pairs[3]);
+        const __m128i vx0 = _mm_unpacklo_epi64(pairs01, pairs23);
+        const __m128i vx1 = _mm_unpackhi_epi64(pairs01, pairs23);
+
+        // The fractions only depend on the low bits of the positions
+        const __m128i fractions = _mm_and_si128(
+            _mm_setr_epi32(static_cast<s32>(fposition), static_cast<s32>(fposition + step_size),
+                           static_cast<s32>(fposition + 2 * step_size),
+                           static_cast<s32>(fposition + 3 * step_size)),
+            _mm_set1_epi32(static_cast<s32>(scale_mask)));
+        const __m128i fractions_hi = _mm_srli_epi32(fractions, half_bits);
+        const __m128i fractions_lo =
+            _mm_and_si128(fractions, _mm_set1_epi32(static_cast<s32>(half_mask)));
+        const __m128i packed_hi = _mm_packs_epi32(fractions_hi, fractions_hi);
+        const __m128i packed_lo = _mm_packs_epi32(fractions_lo, fractions_lo);
+        const __m128i hi = _mm_unpacklo_epi16(packed_hi, packed_hi);
+        const __m128i lo = _mm_unpacklo_epi16(packed_lo, packed_lo);
+        const __m128i delta = _mm_subs_epi16(vx1, vx0);
+
+        // 32-bit products of the fraction halves and the deltas
+        const __m128i hi_lo = _mm_mullo_epi16(hi, delta);
+        const __m128i hi_hi = _mm_mulhi_epi16(hi, delta);
+        const __m128i lo_lo = _mm_mullo_epi16(lo, delta);
+        const __m128i lo_hi = _mm_mulhi_epi16(lo, delta);
+        const __m128i a0 = _mm_unpacklo_epi16(hi_lo, hi_hi);
+        const __m128i a1 = _mm_unpackhi_epi16(hi_lo, hi_hi);
+        const __m128i b0 = _mm_unpacklo_epi16(lo_lo, lo_hi);
+        const __m128i b1 = _mm_unpackhi_epi16(lo_lo, lo_hi);
+
+        // floor((a * 2^12 + b) / 2^24) == floor((a + floor(b / 2^12)) / 2^12)
+        __m128i r0 = _mm_srai_epi32(_mm_add_epi32(a0, _mm_srai_epi32(b0, half_bits)), half_bits);
+        __m128i r1 = _mm_srai_epi32(_mm_add_epi32(a1, _mm_srai_epi32(b1, half_bits)), half_bits);
+
+        // Wrap to 16 bits like the conversion to s16 does
+        r0 = _mm_srai_epi32(_mm_slli_epi32(r0, 16), 16);
+        r1 = _mm_srai_epi32(_mm_slli_epi32(r1, 16), 16);
+        const __m128i result = _mm_add_epi16(vx0, _mm_packs_epi32(r0, r1));
+
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(&output[count]), result);
+
+        count += 4;
+        fposition += 4 * step_size;
     }
 
-    while (fposition < 2 * scale_factor) {
-        u64 fraction = fposition & scale_mask;
+    return count;
+}
 
-        output.push_back(fn(fraction, state.xn1, input[0], input[1]));
+#endif // ARCHITECTURE_x86_64
 
-        fposition += step_size;
+/// Number of phases of the polyphase filter, selected by the top bits of the fraction
+constexpr size_t polyphase_phases = 256;
+constexpr u64 polyphase_phase_shift = 24 - 8;
+/// Fixed point precision of the filter coefficients
+constexpr int polyphase_coeff_bits = 14;
+
+/// Decimating filters are made for rate multipliers rounded up to a multiple of this
+constexpr u64 polyphase_rate_granularity = scale_factor / 2;
+/// Filters for rate multipliers of 1.0, 1.5, ..., 4.0. Higher rates reuse the last one.
+constexpr size_t polyphase_filter_count = 7;
+
+using PolyphaseCoeffs = std::array<s16, polyphase_taps>;
+using PolyphaseFilter = std::array<PolyphaseCoeffs, polyphase_phases>;
+
+/**
+ * Builds a Blackman-windowed sinc filter.
+ * @param cutoff Cutoff frequency relative to the input Nyquist frequency.
+ */
+static PolyphaseFilter MakePolyphaseFilter(double cutoff) {
+    constexpr double pi = 3.14159265358979323846;
+    constexpr double half_width = polyphase_taps / 2;
+
+    PolyphaseFilter filter;
+    for (size_t phase = 0; phase < polyphase_phases; ++phase) {
+        const double fraction = static_cast<double>(phase) / polyphase_phases;
+
+        std::array<double, polyphase_taps> taps;
+        double sum = 0.0;
+        for (size_t k = 0; k < polyphase_taps; ++k) {
+            // The point being evaluated lies between the two centre taps
+            const double distance = half_width - 1 + fraction - k;
+            const double x = pi * cutoff * distance;
+            const double sinc = x == 0.0 ? 1.0 : std::sin(x) / x;
+            const double window = 0.42 + 0.5 * std::cos(pi * distance / half_width) +
+                                  0.08 * std::cos(2 * pi * distance / half_width);
+            taps[k] = sinc * window;
+            sum += taps[k];
+        }
+
+        // Normalized to unity gain at DC
+        for (size_t k = 0; k < polyphase_taps; ++k) {
+            filter[phase][k] = static_cast<s16>(
+                std::lround(taps[k] / sum * (1 << polyphase_coeff_bits)));
+        }
     }
+    return filter;
+}
 
-    while (fposition < max_fposition) {
-        u64 fraction = fposition & scale_mask;
+/// Selects the filter for a step size. Its cutoff lies at or below the output Nyquist frequency.
+static const PolyphaseFilter& GetPolyphaseFilter(u64 step_size) {
+    static const std::vector<PolyphaseFilter> filters = [] {
+        std::vector<PolyphaseFilter> filters(polyphase_filter_count);
+        for (size_t i = 0; i < filters.size(); ++i) {
+            const u64 step_size = scale_factor + i * polyphase_rate_granularity;
+            filters[i] = MakePolyphaseFilter(static_cast<double>(scale_factor) / step_size);
+        }
+        return filters;
+    }();
 
-        size_t index = static_cast<size_t>(fposition / scale_factor);
-        output.push_back(fn(fraction, input[index - 2], input[index - 1], input[index]));
+    size_t index = 0;
+    if (step_size > scale_factor) {
+        index = static_cast<size_t>((step_size - scale_factor + polyphase_rate_granularity - 1) /
+                                    polyphase_rate_granularity);
+    }
+    return filters[std::min(index, filters.size() - 1)];
+}
 
-        fposition += step_size;
+/// Filters polyphase_taps samples starting at x with the coefficients of one phase
+static std::array<s16, 2> PolyphaseStep(const PolyphaseCoeffs& coeffs,
+                                        const std::array<s16, 2>* x) {
+    constexpr s32 rounding = 1 << (polyphase_coeff_bits - 1);
+
+#ifdef ARCHITECTURE_x86_64
+    static_assert(polyphase_taps % 8 == 0, "The filter is applied eight taps at a time");
+
+    __m128i sum = _mm_setzero_si128();
+    for (size_t k = 0; k < polyphase_taps; k += 8) {
+        // Coefficient pairs repeated for each channel: c0 c1 c0 c1 c2 c3 c2 c3
+        const __m128i c = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&coeffs[k]));
+        const __m128i c_lo = _mm_unpacklo_epi32(c, c);
+        const __m128i c_hi = _mm_unpackhi_epi32(c, c);
+
+        // Samples grouped by channel within each pair: L0 L1 R0 R1 L2 L3 R2 R3
+        __m128i x_lo = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&x[k]));
+        __m128i x_hi = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&x[k + 4]));
+        x_lo = _mm_shufflelo_epi16(x_lo, _MM_SHUFFLE(3, 1, 2, 0));
+        x_lo = _mm_shufflehi_epi16(x_lo, _MM_SHUFFLE(3, 1, 2, 0));
+        x_hi = _mm_shufflelo_epi16(x_hi, _MM_SHUFFLE(3, 1, 2, 0));
+        x_hi = _mm_shufflehi_epi16(x_hi, _MM_SHUFFLE(3, 1, 2, 0));
+
+        sum = _mm_add_epi32(sum, _mm_madd_epi16(x_lo, c_lo));
+        sum = _mm_add_epi32(sum, _mm_madd_epi16(x_hi, c_hi));
     }
 
-    state.xn2 = input[input.size() - 2];
-    state.xn1 = input[input.size() - 1];
+    // Lanes hold L R L R partial sums
+    sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, _MM_SHUFFLE(1, 0, 3, 2)));
+    sum = _mm_srai_epi32(_mm_add_epi32(sum, _mm_set1_epi32(rounding)), polyphase_coeff_bits);
+    const s32 packed = _mm_cvtsi128_si32(_mm_packs_epi32(sum, sum));
 
-    return output;
+    std::array<s16, 2> result;
+    std::memcpy(result.data(), &packed, sizeof(result));
+    return result;
+#else
+    s32 left = 0;
+    s32 right = 0;
+    for (size_t k = 0; k < polyphase_taps; ++k) {
+        left += coeffs[k] * x[k][0];
+        right += coeffs[k] * x[k][1];
+    }
+
+    return {
+        static_cast<s16>(MathUtil::Clamp((left + rounding) >> polyphase_coeff_bits, -32768, 32767)),
+        static_cast<s16>(
+            MathUtil::Clamp((right + rounding) >> polyphase_coeff_bits, -32768, 32767)),
+    };
+#endif // ARCHITECTURE_x86_64
+}
+
+size_t None(const std::array<s16, 2>* input, u64& fposition, u64 step_size, u64 max_fposition,
+            std::array<s16, 2>* output, size_t max_output) {
+    return StepOverSamples(input, fposition, step_size, max_fposition, output, max_output,
+                           [](u64 fraction, const auto& x0, const auto& x1) { return x0; });
+}
+
+size_t Linear(const std::array<s16, 2>* input, u64& fposition, u64 step_size, u64 max_fposition,
+              std::array<s16, 2>* output, size_t max_output) {
+    // Note on accuracy: Some values that this produces are +/- 1 from the actual firmware.
+#ifdef ARCHITECTURE_x86_64
+    return StepOverSamples(input, fposition, step_size, max_fposition, output, max_output,
+                           LinearStep, LinearBulk);
+#else
+    return StepOverSamples(input, fposition, step_size, max_fposition, output, max_output,
+                           LinearStep);
+#endif // ARCHITECTURE_x86_64
+}
+
+size_t Polyphase(const std::array<s16, 2>* input, u64& fposition, u64 step_size,
+                 u64 max_fposition, std::array<s16, 2>* output, size_t max_output) {
+    const PolyphaseFilter& filter = GetPolyphaseFilter(step_size);
+
+    size_t count = 0;
+    while (count < max_output && fposition < max_fposition) {
+        const size_t index = static_cast<size_t>(fposition / scale_factor);
+        const PolyphaseCoeffs& coeffs = filter[(fposition & scale_mask) >> polyphase_phase_shift];
+        output[count++] = PolyphaseStep(coeffs, input - polyphase_history + index);
+
+        fposition += step_size;
+    }
+
+    return count;
 }
 
 StereoBuffer16 None(State& state, const StereoBuffer16& input, float rate_multiplier) {
-    return StepOverSamples(
-        state, input, rate_multiplier,
-        [](u64 fraction, const auto& x0, const auto& x1, const auto& x2) { return x0; });
+    return ResampleBuffer(state, input, rate_multiplier, [](auto&&... args) {
+        return None(args...);
+    });
 }
 
 StereoBuffer16 Linear(State& state, const StereoBuffer16& input, float rate_multiplier) {
-    // Note on accuracy: Some values that this produces are +/- 1 from the actual firmware.
-    return StepOverSamples(state, input, rate_multiplier,
-                           [](u64 fraction, const auto& x0, const auto& x1, const auto& x2) {
-                               // This is a saturated subtraction. (Verified by black-box fuzzing.)
-                               s64 delta0 = MathUtil::Clamp<s64>(x1[0] - x0[0], -32768, 32767);
-                               s64 delta1 = MathUtil::Clamp<s64>(x1[1] - x0[1], -32768, 32767);
-
-                               return std::array<s16, 2>{
-                                   static_cast<s16>(x0[0] + fraction * delta0 / scale_factor),
-                                   static_cast<s16>(x0[1] + fraction * delta1 / scale_factor),
-                               };
-                           });
+    return ResampleBuffer(state, input, rate_multiplier, [](auto&&... args) {
+        return Linear(args...);
+    });
+}
+
+StereoBuffer16 Polyphase(State& state, const StereoBuffer16& input, float rate_multiplier) {
+    return ResampleBuffer(state, input, rate_multiplier, [](auto&&... args) {
+        return Polyphase(args...);
+    });
 }
 
 } // namespace AudioInterp
@@ -5,6 +5,7 @@
 #pragma once
 
 #include <array>
+#include <cstddef>
 #include <vector>
 #include "common/common_types.h"
 
@@ -13,12 +14,77 @@ namespace AudioInterp {
 /// A variable length buffer of signed PCM16 stereo samples.
 using StereoBuffer16 = std::vector<std::array<s16, 2>>;
 
+/// Resampling positions are fixed point with 24 fractional bits.
+constexpr u64 scale_factor = 1 << 24;
+
+/// Number of taps of the polyphase filter.
+constexpr size_t polyphase_taps = 16;
+/// Number of samples before the two-sample predelay that the polyphase filter reads.
+constexpr size_t polyphase_history = polyphase_taps - 2;
+
 struct State {
     // Two historical samples.
     std::array<s16, 2> xn1 = {}; ///< x[n-1]
     std::array<s16, 2> xn2 = {}; ///< x[n-2]
+    /// Older history for the polyphase filter, x[n-16] to x[n-3].
+    std::array<std::array<s16, 2>, polyphase_history> xn_earlier = {};
 };
 
+/**
+ * Converts a rate multiplier into the distance between output samples.
+ * @param rate_multiplier Stretch factor. Must be a positive non-zero value.
+ * @return The step size in fixed point.
+ */
+u64 StepSize(float rate_multiplier);
+
+/**
+ * No interpolation over a window of input, for resampling a stream a block at a time.
+ * The output for position p is input[floor(p)].
+ * @param input Input window.
+ * @param fposition Position of the next output sample relative to input[0]. Advanced past the
+ *                  samples written.
+ * @param step_size Distance between output samples.
+ * @param max_fposition Resampling stops before this position.
+ * @param output Destination of the resampled samples.
+ * @param max_output Maximum number of samples to write.
+ * @return The number of samples written.
+ */
+size_t None(const std::array<s16, 2>* input, u64& fposition, u64 step_size, u64 max_fposition,
+            std::array<s16, 2>* output, size_t max_output);
+
+/**
+ * Linear interpolation over a window of input, for resampling a stream a block at a time.
+ * The output for position p lies between input[floor(p)] and input[floor(p) + 1], so input has to
+ * extend one sample past the last position resampled.
+ * @param input Input window.
+ * @param fposition Position of the next output sample relative to input[0]. Advanced past the
+ *                  samples written.
+ * @param step_size Distance between output samples.
+ * @param max_fposition Resampling stops before this position.
+ * @param output Destination of the resampled samples.
+ * @param max_output Maximum number of samples to write.
+ * @return The number of samples written.
+ */
+size_t Linear(const std::array<s16, 2>* input, u64& fposition, u64 step_size, u64 max_fposition,
+              std::array<s16, 2>* output, size_t max_output);
+
+/**
+ * Windowed-sinc interpolation over a window of input, for resampling a stream a block at a time.
+ * The output for position p is filtered from input[floor(p) - polyphase_history] to
+ * input[floor(p) + 1], so polyphase_history samples before input[0] are read as well. When
+ * decimating, the cutoff of the filter is lowered to suppress aliasing.
+ * @param input Input window.
+ * @param fposition Position of the next output sample relative to input[0]. Advanced past the
+ *                  samples written.
+ * @param step_size Distance between output samples.
+ * @param max_fposition Resampling stops before this position.
+ * @param output Destination of the resampled samples.
+ * @param max_output Maximum number of samples to write.
+ * @return The number of samples written.
+ */
+size_t Polyphase(const std::array<s16, 2>* input, u64& fposition, u64 step_size,
+                 u64 max_fposition, std::array<s16, 2>* output, size_t max_output);
+
 /**
  * No interpolation. This is equivalent to a zero-order hold. There is a two-sample predelay.
  * @param input Input buffer.
@@ -39,4 +105,15 @@ StereoBuffer16 None(State& state, const StereoBuffer16& input, float rate_multip
  */
 StereoBuffer16 Linear(State& state, const StereoBuffer16& input, float rate_multiplier);
 
+/**
+ * Windowed-sinc interpolation with a polyphase filter. This delays the signal by a further
+ * polyphase_taps / 2 - 1 samples over the two-sample predelay.
+ * @param input Input buffer.
+ * @param rate_multiplier Stretch factor. Must be a positive non-zero value.
+ *                        rate_multiplier > 1.0 performs decimation and rate_multipler < 1.0
+ *                        performs upsampling.
+ * @return The resampled audio buffer.
+ */
+StereoBuffer16 Polyphase(State& state, const StereoBuffer16& input, float rate_multiplier);
+
 } // namespace AudioInterp
@@ -0,0 +1,46 @@
+// Copyright 2017 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include "audio_core/audio_core.h"
+#include "audio_core/recording_sink.h"
+#include "common/file_util.h"
+#include "common/logging/log.h"
+
+namespace AudioCore {
+
+constexpr char recording_sink_file_name[] = "audio_recording.ciaudio";
+
+RecordingSink::RecordingSink()
+    : RecordingSink(FileUtil::GetUserPath(D_USER_IDX) + recording_sink_file_name) {}
+
+RecordingSink::RecordingSink(const std::string& path) : writer(path, native_sample_rate) {
+    if (writer.IsOpen()) {
+        LOG_INFO(Audio_Sink, "Recording audio frames to %s", path.c_str());
+    }
+}
+
+RecordingSink::~RecordingSink() = default;
+
+unsigned int RecordingSink::GetNativeSampleRate() const {
+    return native_sample_rate;
+}
+
+void RecordingSink::EnqueueSamples(const s16*, size_t) {
+    // Mixed frames arrive through EnqueueFrame. Anything else is audio left in the time stretcher
+    // from before this sink was selected, which isn't part of the recording.
+}
+
+size_t RecordingSink::SamplesInQueue() const {
+    return 0;
+}
+
+bool RecordingSink::IsRealTime() const {
+    return false;
+}
+
+void RecordingSink::EnqueueFrame(u64 timestamp, const s16* samples, size_t sample_count) {
+    writer.WriteFrame(timestamp, samples, sample_count);
+}
+
+} // namespace AudioCore
@@ -0,0 +1,40 @@
+// Copyright 2017 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include "audio_core/audio_recording.h"
+#include "audio_core/sink.h"
+
+namespace AudioCore {
+
+/**
+ * Sink that records every mixed frame, with its emulated timestamp, to a compressed audio
+ * recording. It doesn't play in real time, so the output is deterministic and emulation can run
+ * as fast as possible. Recordings of two runs can be compared with audio_compare.
+ */
+class RecordingSink final : public Sink {
+public:
+    /// Records to audio_recording.ciaudio in the user directory
+    RecordingSink();
+    explicit RecordingSink(const std::string& path);
+    ~RecordingSink() override;
+
+    unsigned int GetNativeSampleRate() const override;
+
+    void EnqueueSamples(const s16* samples, size_t sample_count) override;
+
+    size_t SamplesInQueue() const override;
+
+    bool IsRealTime() const override;
+
+    void EnqueueFrame(u64 timestamp, const s16* samples, size_t sample_count) override;
+
+private:
+    Recording::Writer writer;
+};
+
+} // namespace AudioCore
@@ -0,0 +1,98 @@
+// Copyright 2017 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstring>
+#include <type_traits>
+
+namespace AudioCore {
+
+/**
+ * Fixed-size single-producer/single-consumer ring buffer. Push may only be called from one thread
+ * and Pop from one other thread; neither allocates nor blocks, so it is safe to use from real-time
+ * audio callbacks.
+ * @tparam T Element type, which must be trivially copyable
+ * @tparam capacity Number of slots, a power of two
+ * @tparam granularity Number of elements making up one slot (e.g. 2 for stereo frames)
+ */
+template <typename T, std::size_t capacity, std::size_t granularity = 1>
+class RingBuffer final {
+    static_assert(capacity != 0 && (capacity & (capacity - 1)) == 0,
+                  "capacity must be a power of two");
+    static_assert(granularity != 0, "granularity must be at least one");
+    static_assert(std::is_trivially_copyable<T>::value, "T must be trivially copyable");
+
+public:
+    /**
+     * Appends slots to the buffer. Only call this from the producer thread.
+     * @param data Elements to append, granularity elements per slot
+     * @param slot_count Number of slots to append
+     * @returns Number of slots appended, which is less than slot_count if the buffer filled up
+     */
+    std::size_t Push(const T* data, std::size_t slot_count) {
+        const std::size_t read = read_index.load(std::memory_order_acquire);
+        const std::size_t write = write_index.load(std::memory_order_relaxed);
+        const std::size_t count = std::min(slot_count, capacity - (write - read));
+
+        const std::size_t pos = write % capacity;
+        const std::size_t first_part = std::min(count, capacity - pos);
+        std::memcpy(&data_buffer[pos * granularity], data, first_part * SLOT_SIZE);
+        std::memcpy(&data_buffer[0], data + first_part * granularity,
+                    (count - first_part) * SLOT_SIZE);
+
+        write_index.store(write + count, std::memory_order_release);
+        return count;
+    }
+
+    /**
+     * Removes slots from the front of the buffer. Only call this from the consumer thread.
+     * @param output Destination of the removed elements, granularity elements per slot
+     * @param max_slots Maximum number of slots to remove
+     * @returns Number of slots removed
+     */
+    std::size_t Pop(T* output, std::size_t max_slots) {
+        const std::size_t write = write_index.load(std::memory_order_acquire);
+        const std::size_t read = read_index.load(std::memory_order_relaxed);
+        const std::size_t count = std::min(max_slots, write - read);
+
+        const std::size_t pos = read % capacity;
+        const std::size_t first_part = std::min(count, capacity - pos);
+        std::memcpy(output, &data_buffer[pos * granularity], first_part * SLOT_SIZE);
+        std::memcpy(output + first_part * granularity, &data_buffer[0],
+                    (count - first_part) * SLOT_SIZE);
+
+        read_index.store(read + count, std::memory_order_release);
+        return count;
+    }
+
+    /// Number of slots currently stored. May be called from any thread.
+    std::size_t Size() const {
+        // The read index is loaded first so that it can never be ahead of the write index
+        const std::size_t read = read_index.load(std::memory_order_acquire);
+        const std::size_t write = write_index.load(std::memory_order_acquire);
+        return write - read;
+    }
+
+    /// Total number of slots the buffer can hold.
+    static constexpr std::size_t Capacity() {
+        return capacity;
+    }
+
+private:
+    static constexpr std::size_t SLOT_SIZE = granularity * sizeof(T);
+
+    // The indices only ever increase and wrap around at the end of size_t, which is a multiple of
+    // capacity, so `write - read` is always the number of stored slots.
+    std::atomic<std::size_t> read_index{0};
+    std::atomic<std::size_t> write_index{0};
+
+    std::array<T, capacity * granularity> data_buffer;
+};
+
+} // namespace AudioCore
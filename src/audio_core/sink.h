@@ -5,10 +5,14 @@
 #pragma once
 
 #include <vector>
+#include "audio_core/ring_buffer.h"
 #include "common/common_types.h"
 
 namespace AudioCore {
 
+/// Queue of interleaved stereo PCM16 frames between the emulator and a sink's output thread
+using SinkSampleQueue = RingBuffer<s16, 0x4000, 2>;
+
 /**
  * This class is an interface for an audio sink. An audio sink accepts samples in stereo signed
  * PCM16 format to be output. Sinks *do not* handle resampling and expect the correct sample rate.
@@ -31,6 +35,24 @@ public:
 
     /// Samples enqueued that have not been played yet.
     virtual std::size_t SamplesInQueue() const = 0;
+
+    /**
+     * Whether the sink plays audio in real time. Sinks that don't are fed every mixed frame as it
+     * is, through EnqueueFrame, with neither time stretching nor dropping of frames.
+     */
+    virtual bool IsRealTime() const {
+        return true;
+    }
+
+    /**
+     * Feed a whole mixed frame to a sink that doesn't play in real time.
+     * @param timestamp Emulated time at which the frame was mixed, in CPU cycles.
+     * @param samples Samples in interleaved stereo PCM16 format.
+     * @param sample_count Number of samples.
+     */
+    virtual void EnqueueFrame(u64 timestamp, const s16* samples, size_t sample_count) {
+        EnqueueSamples(samples, sample_count);
+    }
 };
 
 } // namespace
@@ -5,7 +5,9 @@
 #include <memory>
 #include <vector>
 #include "audio_core/null_sink.h"
+#include "audio_core/recording_sink.h"
 #include "audio_core/sink_details.h"
+#include "audio_core/wav_sink.h"
 #ifdef HAVE_SDL2
 #include "audio_core/sdl2_sink.h"
 #endif
@@ -18,6 +20,8 @@ const std::vector<SinkDetails> g_sink_details = {
     {"sdl2", []() { return std::make_unique<SDL2Sink>(); }},
 #endif
     {"null", []() { return std::make_unique<NullSink>(); }},
+    {"wav", []() { return std::make_unique<WavSink>(); }},
+    {"record", []() { return std::make_unique<RecordingSink>(); }},
 };
 
 } // namespace AudioCore
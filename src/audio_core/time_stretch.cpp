@@ -4,7 +4,6 @@
 
 #include <chrono>
 #include <cmath>
-#include <vector>
 #include <SoundTouch.h>
 #include "audio_core/audio_core.h"
 #include "audio_core/time_stretch.h"
@@ -29,18 +28,25 @@ constexpr size_t DROP_FRAMES_SAMPLE_DELAY = 16000; // Units: samples
 
 constexpr double SMOOTHING_FACTOR = 0.007;
 
+/// Ratios are measured over at least this much audio, as the timing of single frames jitters.
+constexpr double RATIO_MEASUREMENT_TIME = 0.05; // Units: seconds
+/// SoundTouch is only given a new tempo once it drifts this far (relatively) from the current one.
+constexpr double TEMPO_UPDATE_THRESHOLD = 0.005;
+
 struct TimeStretcher::Impl {
     soundtouch::SoundTouch soundtouch;
 
     steady_clock::time_point frame_timer = steady_clock::now();
     size_t samples_queued = 0;
 
+    double measured_ratio = 1.0;
     double smoothed_ratio = 1.0;
+    double tempo = 1.0;
 
     double sample_rate = static_cast<double>(native_sample_rate);
 };
 
-std::vector<s16> TimeStretcher::Process(size_t samples_in_queue) {
+size_t TimeStretcher::Process(size_t samples_in_queue, s16* output, size_t max_samples) {
     // This is a very simple algorithm without any fancy control theory. It works and is stable.
 
     double ratio = CalculateCurrentRatio();
@@ -50,14 +56,19 @@ std::vector<s16> TimeStretcher::Process(size_t samples_in_queue) {
     impl->smoothed_ratio = ClampRatio(impl->smoothed_ratio);
 
     // SoundTouch's tempo definition the inverse of our ratio definition.
-    impl->soundtouch.setTempo(1.0 / impl->smoothed_ratio);
+    // Changing it recalculates SoundTouch's processing parameters, so small changes are ignored.
+    const double tempo = 1.0 / impl->smoothed_ratio;
+    if (std::abs(tempo - impl->tempo) > TEMPO_UPDATE_THRESHOLD * impl->tempo) {
+        impl->tempo = tempo;
+        impl->soundtouch.setTempo(tempo);
+    }
 
-    std::vector<s16> samples = GetSamples();
     if (samples_in_queue >= DROP_FRAMES_SAMPLE_DELAY) {
-        samples.clear();
+        impl->soundtouch.receiveSamples(impl->soundtouch.numSamples());
         LOG_DEBUG(Audio, "Dropping frames!");
+        return 0;
     }
-    return samples;
+    return GetSamples(output, max_samples);
 }
 
 TimeStretcher::TimeStretcher() : impl(std::make_unique<Impl>()) {
@@ -88,31 +99,30 @@ void TimeStretcher::Flush() {
 void TimeStretcher::Reset() {
     impl->soundtouch.setTempo(1.0);
     impl->soundtouch.clear();
+    impl->measured_ratio = 1.0;
     impl->smoothed_ratio = 1.0;
+    impl->tempo = 1.0;
     impl->frame_timer = steady_clock::now();
     impl->samples_queued = 0;
     SetOutputSampleRate(native_sample_rate);
 }
 
 double TimeStretcher::CalculateCurrentRatio() {
-    const steady_clock::time_point now = steady_clock::now();
-    const std::chrono::duration<double> duration = now - impl->frame_timer;
-
     const double expected_time =
         static_cast<double>(impl->samples_queued) / static_cast<double>(native_sample_rate);
-    const double actual_time = duration.count();
-
-    double ratio;
-    if (expected_time != 0) {
-        ratio = ClampRatio(actual_time / expected_time);
-    } else {
-        ratio = impl->smoothed_ratio;
+    if (expected_time < RATIO_MEASUREMENT_TIME) {
+        return impl->measured_ratio;
     }
 
+    const steady_clock::time_point now = steady_clock::now();
+    const std::chrono::duration<double> duration = now - impl->frame_timer;
+    const double actual_time = duration.count();
+
+    impl->measured_ratio = ClampRatio(actual_time / expected_time);
     impl->frame_timer = now;
     impl->samples_queued = 0;
 
-    return ratio;
+    return impl->measured_ratio;
 }
 
 double TimeStretcher::CorrectForUnderAndOverflow(double ratio, size_t sample_delay) const {
@@ -130,14 +140,8 @@ double TimeStretcher::CorrectForUnderAndOverflow(double ratio, size_t sample_del
     return ClampRatio(ratio);
 }
 
-std::vector<s16> TimeStretcher::GetSamples() {
-    uint available = impl->soundtouch.numSamples();
-
-    std::vector<s16> output(static_cast<size_t>(available) * 2);
-
-    impl->soundtouch.receiveSamples(output.data(), available);
-
-    return output;
+size_t TimeStretcher::GetSamples(s16* output, size_t max_samples) {
+    return impl->soundtouch.receiveSamples(output, static_cast<uint>(max_samples));
 }
 
 } // namespace AudioCore
@@ -6,7 +6,6 @@
 
 #include <cstddef>
 #include <memory>
-#include <vector>
 #include "common/common_types.h"
 
 namespace AudioCore {
@@ -40,21 +39,29 @@ public:
      * Timer calculations use sample_delay to determine how much of a margin we have.
      * @param sample_delay How many samples are buffered downstream of this module and haven't been
      * played yet.
-     * @return Samples to play in interleaved stereo PCM16 format.
+     * @param output Buffer that receives samples to play in interleaved stereo PCM16 format.
+     * @param max_samples Capacity of output in samples.
+     * @return The number of samples written. If output was filled, GetSamples returns the rest.
      */
-    std::vector<s16> Process(size_t sample_delay);
+    size_t Process(size_t sample_delay, s16* output, size_t max_samples);
+
+    /**
+     * Gets further time-stretched samples without updating the stretch ratio.
+     * @param output Buffer that receives samples in interleaved stereo PCM16 format.
+     * @param max_samples Capacity of output in samples.
+     * @return The number of samples written.
+     */
+    size_t GetSamples(s16* output, size_t max_samples);
 
 private:
     struct Impl;
     std::unique_ptr<Impl> impl;
 
-    /// INTERNAL: ratio = wallclock time / emulated time
+    /// INTERNAL: ratio = wallclock time / emulated time, measured over several frames
     double CalculateCurrentRatio();
     /// INTERNAL: If we have too many or too few samples downstream, nudge ratio in the appropriate
     /// direction.
     double CorrectForUnderAndOverflow(double ratio, size_t sample_delay) const;
-    /// INTERNAL: Gets the time-stretched samples from SoundTouch.
-    std::vector<s16> GetSamples();
 };
 
 } // namespace AudioCore
@@ -0,0 +1,156 @@
+// Copyright 2017 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstring>
+#include <thread>
+#include "audio_core/audio_core.h"
+#include "audio_core/wav_sink.h"
+#include "common/file_util.h"
+#include "common/logging/log.h"
+#include "common/swap.h"
+#include "common/thread.h"
+
+namespace AudioCore {
+
+constexpr char wav_sink_file_name[] = "audio_dump.wav";
+
+/// How often the writer thread consumes queued samples
+constexpr std::chrono::milliseconds write_interval{10};
+
+#pragma pack(push, 1)
+struct WavHeader {
+    char riff_id[4];
+    u32_le riff_size;
+    char wave_id[4];
+    char fmt_id[4];
+    u32_le fmt_size;
+    u16_le format;
+    u16_le channels;
+    u32_le sample_rate;
+    u32_le byte_rate;
+    u16_le block_align;
+    u16_le bits_per_sample;
+    char data_id[4];
+    u32_le data_size;
+};
+#pragma pack(pop)
+static_assert(sizeof(WavHeader) == 44, "WavHeader has incorrect size");
+
+static WavHeader MakeWavHeader(u32 data_size) {
+    constexpr u16 channels = 2;
+    constexpr u16 bits_per_sample = 16;
+
+    WavHeader header;
+    std::memcpy(header.riff_id, "RIFF", 4);
+    header.riff_size = static_cast<u32>(sizeof(WavHeader) - 8 + data_size);
+    std::memcpy(header.wave_id, "WAVE", 4);
+    std::memcpy(header.fmt_id, "fmt ", 4);
+    header.fmt_size = 16;
+    header.format = 1; // PCM
+    header.channels = channels;
+    header.sample_rate = native_sample_rate;
+    header.byte_rate = native_sample_rate * channels * bits_per_sample / 8;
+    header.block_align = channels * bits_per_sample / 8;
+    header.bits_per_sample = bits_per_sample;
+    std::memcpy(header.data_id, "data", 4);
+    header.data_size = data_size;
+    return header;
+}
+
+struct WavSink::Impl {
+    FileUtil::IOFile file;
+    u32 data_size = 0;
+
+    SinkSampleQueue queue;
+
+    std::thread writer_thread;
+    Common::Event stop_event;
+
+    /// Pops up to frame_count frames from the queue and appends them to the file
+    void WriteFrames(size_t frame_count);
+
+    void WriterThread();
+};
+
+WavSink::WavSink() : WavSink(FileUtil::GetUserPath(D_USER_IDX) + wav_sink_file_name) {}
+
+WavSink::WavSink(const std::string& path) : impl(std::make_unique<Impl>()) {
+    if (!impl->file.Open(path, "wb")) {
+        LOG_CRITICAL(Audio_Sink, "Could not open %s for writing", path.c_str());
+        return;
+    }
+
+    // The sizes are filled in once recording stops
+    impl->file.WriteObject(MakeWavHeader(0));
+    LOG_INFO(Audio_Sink, "Recording audio to %s", path.c_str());
+
+    impl->writer_thread = std::thread(&Impl::WriterThread, impl.get());
+}
+
+WavSink::~WavSink() {
+    if (!impl->writer_thread.joinable())
+        return;
+
+    impl->stop_event.Set();
+    impl->writer_thread.join();
+
+    impl->WriteFrames(impl->queue.Size());
+    impl->file.Seek(0, SEEK_SET);
+    impl->file.WriteObject(MakeWavHeader(impl->data_size));
+}
+
+unsigned int WavSink::GetNativeSampleRate() const {
+    return native_sample_rate;
+}
+
+void WavSink::EnqueueSamples(const s16* samples, size_t sample_count) {
+    if (!impl->writer_thread.joinable())
+        return;
+
+    size_t pushed = impl->queue.Push(samples, sample_count);
+    if (pushed < sample_count) {
+        LOG_DEBUG(Audio_Sink, "Sample queue full, dropped %zu samples", sample_count - pushed);
+    }
+}
+
+size_t WavSink::SamplesInQueue() const {
+    return impl->queue.Size();
+}
+
+void WavSink::Impl::WriteFrames(size_t frame_count) {
+    std::array<s16, 2 * 1024> buffer;
+
+    while (frame_count > 0) {
+        size_t popped = queue.Pop(buffer.data(), std::min(frame_count, buffer.size() / 2));
+        if (popped == 0)
+            break;
+
+        file.WriteArray(buffer.data(), popped * 2);
+        data_size += static_cast<u32>(popped * 2 * sizeof(s16));
+        frame_count -= popped;
+    }
+}
+
+void WavSink::Impl::WriterThread() {
+    using Clock = std::chrono::steady_clock;
+    const Clock::time_point start_time = Clock::now();
+    Clock::time_point next_write = start_time;
+    u64 frames_consumed = 0;
+
+    while (!stop_event.WaitUntil(next_write += write_interval)) {
+        // Consume samples at the rate a device would play them. Time during which the queue ran
+        // dry is skipped rather than recorded as silence.
+        const auto elapsed =
+            std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - start_time);
+        const u64 frames_due = static_cast<u64>(elapsed.count()) * native_sample_rate / 1000000;
+
+        WriteFrames(static_cast<size_t>(frames_due - frames_consumed));
+        frames_consumed = frames_due;
+    }
+}
+
+} // namespace AudioCore
@@ -0,0 +1,37 @@
+// Copyright 2017 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <string>
+#include "audio_core/sink.h"
+
+namespace AudioCore {
+
+/**
+ * Sink that records audio to a WAV file instead of playing it. A writer thread consumes samples
+ * at the native sample rate like an audio device would, so time stretching and frame pacing
+ * behave as with real output. It needs no audio hardware, which makes it usable headless.
+ */
+class WavSink final : public Sink {
+public:
+    /// Records to audio_dump.wav in the user directory
+    WavSink();
+    explicit WavSink(const std::string& path);
+    ~WavSink() override;
+
+    unsigned int GetNativeSampleRate() const override;
+
+    void EnqueueSamples(const s16* samples, size_t sample_count) override;
+
+    size_t SamplesInQueue() const override;
+
+private:
+    struct Impl;
+    std::unique_ptr<Impl> impl;
+};
+
+} // namespace AudioCore
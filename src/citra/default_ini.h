@@ -68,6 +68,10 @@ resolution_factor =
 # 0 (default): Off, 1: On
 use_vsync =
 
+# Target emulation speed in percent of the console's frame rate when the frame limiter is enabled.
+# 0: Unlimited, 100 (default): Normal speed, 200: Double speed
+frame_limit =
+
 # The clear color for the renderer. What shows up on the sides of the bottom screen.
 # Must be in range of 0.0-1.0. Defaults to 1.0 for all.
 bg_red =
@@ -90,7 +94,11 @@ swap_screen =
 
 [Audio]
 # Which audio output engine to use.
-# auto (default): Auto-select, null: No audio output, sdl2: SDL2 (if available)
+# auto (default): Auto-select, null: No audio output, sdl2: SDL2 (if available),
+# wav: Record to audio_dump.wav in the user directory
+# record: Record every audio frame with its emulated timestamp to audio_recording.ciaudio in the
+# user directory, without real-time pacing. Use with the frame limit disabled for headless runs,
+# and compare recordings with audio_compare.
 output_engine =
 
 # Whether or not to enable the audio-stretching post-processing effect.
@@ -99,6 +107,18 @@ output_engine =
 # 0: No, 1 (default): Yes
 enable_audio_stretching =
 
+# Whether or not to adjust emulation speed by a few percent to keep audio latency steady.
+# This prevents audio stutter without changing pitch. It only applies while audio stretching is
+# disabled.
+# 0 (default): No, 1: Yes
+enable_audio_speed_governor =
+
+# Whether or not to resample sounds requesting polyphase interpolation with a windowed-sinc filter.
+# This reduces aliasing of pitched sounds at a higher CPU cost. Linear interpolation is used
+# otherwise.
+# 0 (default): No, 1: Yes
+enable_polyphase_interpolation =
+
 [Camera]
 # Which camera engine to use for the right outer camera
 # blank (default): a dummy camera that always returns black image
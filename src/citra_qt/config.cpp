@@ -51,6 +51,8 @@ void Config::ReadValues() {
     Settings::values.resolution_factor = qt_config->value("resolution_factor", 1.0).toFloat();
     Settings::values.use_vsync = qt_config->value("use_vsync", false).toBool();
     Settings::values.toggle_framelimit = qt_config->value("toggle_framelimit", true).toBool();
+    Settings::values.frame_limit =
+        static_cast<u16>(qt_config->value("frame_limit", 100).toInt());
 
     Settings::values.bg_red = qt_config->value("bg_red", 1.0).toFloat();
     Settings::values.bg_green = qt_config->value("bg_green", 1.0).toFloat();
@@ -67,6 +69,10 @@ void Config::ReadValues() {
     Settings::values.sink_id = qt_config->value("output_engine", "auto").toString().toStdString();
     Settings::values.enable_audio_stretching =
         qt_config->value("enable_audio_stretching", true).toBool();
+    Settings::values.enable_audio_speed_governor =
+        qt_config->value("enable_audio_speed_governor", false).toBool();
+    Settings::values.enable_polyphase_interpolation =
+        qt_config->value("enable_polyphase_interpolation", false).toBool();
     qt_config->endGroup();
 
     using namespace Service::CAM;
@@ -179,6 +185,7 @@ void Config::SaveValues() {
     qt_config->setValue("resolution_factor", (double)Settings::values.resolution_factor);
     qt_config->setValue("use_vsync", Settings::values.use_vsync);
     qt_config->setValue("toggle_framelimit", Settings::values.toggle_framelimit);
+    qt_config->setValue("frame_limit", Settings::values.frame_limit);
 
     // Cast to double because Qt's written float values are not human-readable
     qt_config->setValue("bg_red", (double)Settings::values.bg_red);
@@ -194,6 +201,10 @@ void Config::SaveValues() {
     qt_config->beginGroup("Audio");
     qt_config->setValue("output_engine", QString::fromStdString(Settings::values.sink_id));
     qt_config->setValue("enable_audio_stretching", Settings::values.enable_audio_stretching);
+    qt_config->setValue("enable_audio_speed_governor",
+                        Settings::values.enable_audio_speed_governor);
+    qt_config->setValue("enable_polyphase_interpolation",
+                        Settings::values.enable_polyphase_interpolation);
     qt_config->endGroup();
 
     using namespace Service::CAM;
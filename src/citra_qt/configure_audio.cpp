@@ -33,6 +33,9 @@ void ConfigureAudio::setConfiguration() {
     ui->output_sink_combo_box->setCurrentIndex(new_sink_index);
 
     ui->toggle_audio_stretching->setChecked(Settings::values.enable_audio_stretching);
+    ui->toggle_audio_speed_governor->setChecked(Settings::values.enable_audio_speed_governor);
+    ui->toggle_polyphase_interpolation->setChecked(
+        Settings::values.enable_polyphase_interpolation);
 }
 
 void ConfigureAudio::applyConfiguration() {
@@ -40,5 +43,8 @@ void ConfigureAudio::applyConfiguration() {
         ui->output_sink_combo_box->itemText(ui->output_sink_combo_box->currentIndex())
             .toStdString();
     Settings::values.enable_audio_stretching = ui->toggle_audio_stretching->isChecked();
+    Settings::values.enable_audio_speed_governor = ui->toggle_audio_speed_governor->isChecked();
+    Settings::values.enable_polyphase_interpolation =
+        ui->toggle_polyphase_interpolation->isChecked();
     Settings::Apply();
 }
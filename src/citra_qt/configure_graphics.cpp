@@ -111,6 +111,7 @@ void ConfigureGraphics::setConfiguration() {
         ui->layout_bg->setStyleSheet("QPushButton { background-color: " + bg_color.name() + ";}");
     }
     ui->toggle_framelimit->setChecked(Settings::values.toggle_framelimit);
+    ui->frame_limit->setValue(Settings::values.frame_limit);
     ui->layout_combobox->setCurrentIndex(static_cast<int>(Settings::values.layout_option));
     ui->swap_screen->setChecked(Settings::values.swap_screen);
 }
@@ -125,6 +126,7 @@ void ConfigureGraphics::applyConfiguration() {
     Settings::values.bg_green = bg_color.greenF();
     Settings::values.bg_blue = bg_color.blueF();
     Settings::values.toggle_framelimit = ui->toggle_framelimit->isChecked();
+    Settings::values.frame_limit = static_cast<u16>(ui->frame_limit->value());
     Settings::values.layout_option =
         static_cast<Settings::LayoutOption>(ui->layout_combobox->currentIndex());
     Settings::values.swap_screen = ui->swap_screen->isChecked();
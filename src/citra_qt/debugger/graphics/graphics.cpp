@@ -2,7 +2,9 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
+#include <QLabel>
 #include <QListView>
+#include <QVBoxLayout>
 #include "citra_qt/debugger/graphics/graphics.h"
 #include "citra_qt/util/util.h"
 
@@ -53,6 +55,16 @@ void GPUCommandStreamItemModel::GXCommandProcessed(int total_command_count) {
     emit GXCommandFinished(total_command_count);
 }
 
+void GPUCommandStreamItemModel::FrameDrawStatsUpdated(u32 guest_draws, u32 host_draws) {
+    emit FrameDrawStatsChanged(static_cast<int>(guest_draws), static_cast<int>(host_draws));
+}
+
+void GPUCommandStreamItemModel::FrameSurfaceStatsUpdated(u32 hits, u32 uploads, u32 reuses,
+                                                         u32 evictions) {
+    emit FrameSurfaceStatsChanged(static_cast<int>(hits), static_cast<int>(uploads),
+                                  static_cast<int>(reuses), static_cast<int>(evictions));
+}
+
 void GPUCommandStreamItemModel::OnGXCommandFinishedInternal(int total_command_count) {
     if (total_command_count == 0)
         return;
@@ -73,5 +85,35 @@ GPUCommandStreamWidget::GPUCommandStreamWidget(QWidget* parent)
     command_list->setModel(command_model);
     command_list->setFont(GetMonospaceFont());
 
-    setWidget(command_list);
+    draw_stats_label = new QLabel;
+    connect(command_model, SIGNAL(FrameDrawStatsChanged(int, int)), this,
+            SLOT(OnFrameDrawStatsChanged(int, int)));
+
+    surface_stats_label = new QLabel;
+    connect(command_model, SIGNAL(FrameSurfaceStatsChanged(int, int, int, int)), this,
+            SLOT(OnFrameSurfaceStatsChanged(int, int, int, int)));
+
+    QWidget* main_widget = new QWidget;
+    QVBoxLayout* main_layout = new QVBoxLayout;
+    main_layout->addWidget(command_list);
+    main_layout->addWidget(draw_stats_label);
+    main_layout->addWidget(surface_stats_label);
+    main_widget->setLayout(main_layout);
+    setWidget(main_widget);
+}
+
+void GPUCommandStreamWidget::OnFrameDrawStatsChanged(int guest_draws, int host_draws) {
+    draw_stats_label->setText(tr("Draws in previous frame: %1 triggered by the PICA, %2 submitted")
+                                  .arg(guest_draws)
+                                  .arg(host_draws));
+}
+
+void GPUCommandStreamWidget::OnFrameSurfaceStatsChanged(int hits, int uploads, int reuses,
+                                                        int evictions) {
+    surface_stats_label->setText(
+        tr("Surfaces in previous frame: %1 cache hits, %2 uploads, %3 reused, %4 evicted")
+            .arg(hits)
+            .arg(uploads)
+            .arg(reuses)
+            .arg(evictions));
 }
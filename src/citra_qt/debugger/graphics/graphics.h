@@ -6,8 +6,11 @@
 
 #include <QAbstractListModel>
 #include <QDockWidget>
+#include "common/common_types.h"
 #include "video_core/gpu_debugger.h"
 
+class QLabel;
+
 class GPUCommandStreamItemModel : public QAbstractListModel,
                                   public GraphicsDebugger::DebuggerObserver {
     Q_OBJECT
@@ -20,12 +23,16 @@ public:
 
 public:
     void GXCommandProcessed(int total_command_count) override;
+    void FrameDrawStatsUpdated(u32 guest_draws, u32 host_draws) override;
+    void FrameSurfaceStatsUpdated(u32 hits, u32 uploads, u32 reuses, u32 evictions) override;
 
 public slots:
     void OnGXCommandFinishedInternal(int total_command_count);
 
 signals:
     void GXCommandFinished(int total_command_count);
+    void FrameDrawStatsChanged(int guest_draws, int host_draws);
+    void FrameSurfaceStatsChanged(int hits, int uploads, int reuses, int evictions);
 
 private:
     int command_count;
@@ -37,5 +44,11 @@ class GPUCommandStreamWidget : public QDockWidget {
 public:
     GPUCommandStreamWidget(QWidget* parent = nullptr);
 
+public slots:
+    void OnFrameDrawStatsChanged(int guest_draws, int host_draws);
+    void OnFrameSurfaceStatsChanged(int hits, int uploads, int reuses, int evictions);
+
 private:
+    QLabel* draw_stats_label;
+    QLabel* surface_stats_label;
 };
@@ -75,7 +75,7 @@ int ProfilerModel::rowCount(const QModelIndex& parent) const {
     if (parent.isValid()) {
         return 0;
     } else {
-        return 2;
+        return 5;
     }
 }
 
@@ -93,6 +93,24 @@ QVariant ProfilerModel::data(const QModelIndex& index, int role) const {
             } else {
                 return GetDataForColumn(index.column(), results.interframe_time);
             }
+        } else if (index.row() == 2) {
+            if (index.column() == 0) {
+                return tr("Emulation");
+            } else {
+                return GetDataForColumn(index.column(), results.emulation_time);
+            }
+        } else if (index.row() == 3) {
+            if (index.column() == 0) {
+                return tr("Frame limiter wait");
+            } else {
+                return GetDataForColumn(index.column(), results.wait_time);
+            }
+        } else if (index.row() == 4) {
+            if (index.column() == 0) {
+                return tr("Frame limiter overshoot");
+            } else {
+                return GetDataForColumn(index.column(), results.overshoot);
+            }
         }
     }
 
@@ -36,6 +36,7 @@
 #include <cstring>
 #include <dirent.h>
 #include <pwd.h>
+#include <sys/mman.h>
 #include <unistd.h>
 #endif
 
@@ -57,6 +58,7 @@
 #endif
 
 #include <algorithm>
+#include <limits>
 #include <sys/stat.h>
 
 #ifndef S_ISDIR
@@ -889,4 +891,52 @@ bool IOFile::Resize(u64 size) {
     return m_good;
 }
 
+MappedFile::MappedFile(const IOFile& file) {
+    if (!file.IsOpen())
+        return;
+
+    const u64 file_size = file.GetSize();
+    if (file_size == 0 || file_size > std::numeric_limits<size_t>::max())
+        return;
+
+#ifdef _WIN32
+    HANDLE handle = reinterpret_cast<HANDLE>(_get_osfhandle(_fileno(file.GetHandle())));
+    mapping = CreateFileMappingW(handle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (mapping == nullptr) {
+        LOG_ERROR(Common_Filesystem, "CreateFileMapping failed: %s", GetLastErrorMsg());
+        return;
+    }
+
+    void* view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    if (view == nullptr) {
+        LOG_ERROR(Common_Filesystem, "MapViewOfFile failed: %s", GetLastErrorMsg());
+        CloseHandle(mapping);
+        mapping = nullptr;
+        return;
+    }
+#else
+    void* view = mmap(nullptr, static_cast<size_t>(file_size), PROT_READ, MAP_SHARED,
+                      fileno(file.GetHandle()), 0);
+    if (view == MAP_FAILED) {
+        LOG_ERROR(Common_Filesystem, "mmap failed: %s", GetLastErrorMsg());
+        return;
+    }
+#endif
+
+    data = static_cast<u8*>(view);
+    size = file_size;
+}
+
+MappedFile::~MappedFile() {
+    if (!data)
+        return;
+
+#ifdef _WIN32
+    UnmapViewOfFile(data);
+    CloseHandle(mapping);
+#else
+    munmap(data, static_cast<size_t>(size));
+#endif
+}
+
 } // namespace
@@ -248,11 +248,49 @@ public:
         std::clearerr(m_file);
     }
 
+    std::FILE* GetHandle() const {
+        return m_file;
+    }
+
 private:
     std::FILE* m_file = nullptr;
     bool m_good = true;
 };
 
+/**
+ * A read-only view of a whole file in memory. Reads from the view are served from the page cache
+ * without a system call each. The view stays valid after the file it was mapped from is closed.
+ */
+class MappedFile : public NonCopyable {
+public:
+    /**
+     * Maps a file.
+     * @param file File opened for reading. IsOpen() is false afterwards if it couldn't be mapped,
+     *             for example because it is empty.
+     */
+    explicit MappedFile(const IOFile& file);
+    ~MappedFile();
+
+    bool IsOpen() const {
+        return data != nullptr;
+    }
+
+    const u8* GetData() const {
+        return data;
+    }
+
+    u64 GetSize() const {
+        return size;
+    }
+
+private:
+    u8* data = nullptr;
+    u64 size = 0;
+#ifdef _WIN32
+    void* mapping = nullptr;
+#endif
+};
+
 } // namespace
 
 // To deal with Windows being dumb at unicode:
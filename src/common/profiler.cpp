@@ -13,7 +13,9 @@ namespace Common {
 namespace Profiling {
 
 ProfilingManager::ProfilingManager()
-    : last_frame_end(Clock::now()), this_frame_start(Clock::now()) {}
+    : last_frame_end(Clock::now()), this_frame_start(Clock::now()),
+      pacing_emulation_time(Duration::zero()), pacing_wait_time(Duration::zero()),
+      pacing_overshoot(Duration::zero()), results() {}
 
 void ProfilingManager::BeginFrame() {
     this_frame_start = Clock::now();
@@ -24,14 +26,27 @@ void ProfilingManager::FinishFrame() {
 
     results.interframe_time = now - last_frame_end;
     results.frame_time = now - this_frame_start;
+    results.emulation_time = pacing_emulation_time;
+    results.wait_time = pacing_wait_time;
+    results.overshoot = pacing_overshoot;
 
     last_frame_end = now;
 }
 
+void ProfilingManager::SetFramePacingResults(Duration emulation_time, Duration wait_time,
+                                             Duration overshoot) {
+    pacing_emulation_time = emulation_time;
+    pacing_wait_time = wait_time;
+    pacing_overshoot = overshoot;
+}
+
 TimingResultsAggregator::TimingResultsAggregator(size_t window_size)
     : max_window_size(window_size), window_size(0) {
     interframe_times.resize(window_size, Duration::zero());
     frame_times.resize(window_size, Duration::zero());
+    emulation_times.resize(window_size, Duration::zero());
+    wait_times.resize(window_size, Duration::zero());
+    overshoots.resize(window_size, Duration::zero());
 }
 
 void TimingResultsAggregator::Clear() {
@@ -41,6 +56,9 @@ void TimingResultsAggregator::Clear() {
 void TimingResultsAggregator::AddFrame(const ProfilingFrameResult& frame_result) {
     interframe_times[cursor] = frame_result.interframe_time;
     frame_times[cursor] = frame_result.frame_time;
+    emulation_times[cursor] = frame_result.emulation_time;
+    wait_times[cursor] = frame_result.wait_time;
+    overshoots[cursor] = frame_result.overshoot;
 
     ++cursor;
     if (cursor == max_window_size)
@@ -76,6 +94,9 @@ AggregatedFrameResult TimingResultsAggregator::GetAggregatedResults() const {
 
     result.interframe_time = AggregateField(interframe_times, window_size);
     result.frame_time = AggregateField(frame_times, window_size);
+    result.emulation_time = AggregateField(emulation_times, window_size);
+    result.wait_time = AggregateField(wait_times, window_size);
+    result.overshoot = AggregateField(overshoots, window_size);
 
     if (result.interframe_time.avg != Duration::zero()) {
         result.fps = 1000.0f / tof(result.interframe_time.avg);
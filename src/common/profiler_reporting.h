@@ -21,6 +21,15 @@ struct ProfilingFrameResult {
 
     /// Time spent processing a frame, excluding VSync
     Duration frame_time;
+
+    /// Time spent emulating the previous frame, measured by the frame limiter
+    Duration emulation_time;
+
+    /// Time the frame limiter waited after the previous frame
+    Duration wait_time;
+
+    /// How far past its deadline the frame limiter released the previous frame
+    Duration overshoot;
 };
 
 class ProfilingManager final {
@@ -32,6 +41,12 @@ public:
     /// This should be called before swapping screen buffers.
     void FinishFrame();
 
+    /**
+     * Records the frame limiter's statistics for the frame that was just paced. They are reported
+     * together with the timings of the next finished frame.
+     */
+    void SetFramePacingResults(Duration emulation_time, Duration wait_time, Duration overshoot);
+
     /// Get the timing results from the previous frame. This is updated when you call FinishFrame().
     const ProfilingFrameResult& GetPreviousFrameResults() const {
         return results;
@@ -41,6 +56,10 @@ private:
     Clock::time_point last_frame_end;
     Clock::time_point this_frame_start;
 
+    Duration pacing_emulation_time;
+    Duration pacing_wait_time;
+    Duration pacing_overshoot;
+
     ProfilingFrameResult results;
 };
 
@@ -55,6 +74,15 @@ struct AggregatedFrameResult {
     /// Time spent processing a frame, excluding VSync
     AggregatedDuration frame_time;
 
+    /// Time spent emulating a frame, measured by the frame limiter
+    AggregatedDuration emulation_time;
+
+    /// Time the frame limiter waited after a frame
+    AggregatedDuration wait_time;
+
+    /// How far past its deadline the frame limiter released a frame
+    AggregatedDuration overshoot;
+
     float fps;
 };
 
@@ -74,6 +102,9 @@ public:
 
     std::vector<Duration> interframe_times;
     std::vector<Duration> frame_times;
+    std::vector<Duration> emulation_times;
+    std::vector<Duration> wait_times;
+    std::vector<Duration> overshoots;
 };
 
 ProfilingManager& GetProfilingManager();
@@ -1,5 +1,12 @@
+#include <algorithm>
+#include <cstring>
 #include "core/aes/aes.h"
 
+#ifdef ARCHITECTURE_x86_64
+#include "common/x64/cpu_detect.h"
+#include "core/aes/aes_ni.h"
+#endif
+
 namespace AES {
 static int wrap_index(int i) {
     return i < 0 ? ((i % 16) + 16) % 16 : (i > 15 ? i % 16 : i);
@@ -92,17 +99,63 @@ void AddCtr(std::array<u8, 16>& ctr, u32 carry) {
     }
 }
 
+/// Number of counter blocks encrypted at a time by the table-based implementation
+constexpr size_t software_chunk_blocks = 16;
+
+/// XORs whole blocks with the keystream starting at ctr, and advances ctr past them
+static void CtrXorBlocks(u8* data, u64 blocks, const std::array<u8, 16>& key,
+                         std::array<u8, 16>& ctr) {
+#ifdef ARCHITECTURE_x86_64
+    if (Common::GetCPUCaps().aes) {
+        AesNiCtrXorBlocks(data, static_cast<size_t>(blocks), key, ctr);
+        return;
+    }
+#endif
+
+    std::array<u8, software_chunk_blocks * 16> xorpad;
+    while (blocks > 0) {
+        const size_t count = static_cast<size_t>(std::min<u64>(blocks, software_chunk_blocks));
+        for (size_t i = 0; i < count; ++i) {
+            std::memcpy(&xorpad[i * 16], ctr.data(), 16);
+            AddCtr(ctr, 1);
+        }
+        AesCipherBlocks(xorpad.data(), count, key);
+        for (size_t j = 0; j < count * 16; ++j)
+            data[j] ^= xorpad[j];
+        data += count * 16;
+        blocks -= count;
+    }
+}
+
+/// XORs length bytes with the keystream block at ctr, starting skip bytes into the block
+static void CtrXorPartialBlock(u8* data, size_t skip, size_t length,
+                               const std::array<u8, 16>& key, std::array<u8, 16>& ctr) {
+    std::array<u8, 16> block{};
+    std::memcpy(block.data() + skip, data, length);
+    CtrXorBlocks(block.data(), 1, key, ctr);
+    std::memcpy(data, block.data() + skip, length);
+}
+
 void AesCtrDecrypt(void* data, u64 length, const std::array<u8, 16>& key,
-                   const std::array<u8, 16>& ctr) {
+                   const std::array<u8, 16>& ctr, u64 offset) {
     u8* p = reinterpret_cast<u8*>(data);
-    std::array<u8, 16> c(ctr), xorpad;
-    while (length > 0) {
-        xorpad = AesCipher(c, key);
-        AddCtr(c, 1);
-        u64 l = length > 16 ? 16 : length;
-        for (u64 j = 0; j < l; ++j)
-            *(p++) ^= xorpad[j];
+    std::array<u8, 16> c(ctr);
+    AddCtr(c, static_cast<u32>(offset / 16));
+
+    const size_t skip = static_cast<size_t>(offset % 16);
+    if (skip != 0 && length > 0) {
+        const size_t l = static_cast<size_t>(std::min<u64>(length, 16 - skip));
+        CtrXorPartialBlock(p, skip, l, key, c);
+        p += l;
         length -= l;
     }
+
+    const u64 blocks = length / 16;
+    CtrXorBlocks(p, blocks, key, c);
+    p += blocks * 16;
+    length -= blocks * 16;
+
+    if (length > 0)
+        CtrXorPartialBlock(p, 0, static_cast<size_t>(length), key, c);
 }
 }
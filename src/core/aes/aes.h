@@ -1,6 +1,7 @@
 #pragma once
 
 #include <array>
+#include <cstddef>
 
 #include "common/common_types.h"
 
@@ -15,8 +16,25 @@ extern const std::array<u8, 16> ZERO_KEY;
 std::array<u8, 16> MakeKey(int slot, const std::array<u8, 16>& y);
 void AddCtr(std::array<u8, 16>& ctr, u32 carry);
 std::array<u8, 16> AesCipher(const std::array<u8, 16>& input, const std::array<u8, 16>& key);
+
+/**
+ * Encrypts blocks in place, expanding the key only once.
+ * @param blocks Data to encrypt.
+ * @param count Number of 16-byte blocks in data.
+ * @param key Key.
+ */
+void AesCipherBlocks(u8* blocks, size_t count, const std::array<u8, 16>& key);
+
+/**
+ * Decrypts a range of an AES-CTR stream in place. Uses AES-NI when the host CPU supports it.
+ * @param data Data to decrypt.
+ * @param length Length of data in bytes.
+ * @param key Key.
+ * @param ctr Counter at the start of the stream.
+ * @param offset Position of data in the stream. Doesn't have to be a multiple of the block size.
+ */
 void AesCtrDecrypt(void* data, u64 length, const std::array<u8, 16>& key,
-                   const std::array<u8, 16>& ctr);
+                   const std::array<u8, 16>& ctr, u64 offset = 0);
 
 struct AesContext {
     std::array<u8, 16> key, ctr;
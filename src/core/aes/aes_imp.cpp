@@ -248,4 +248,13 @@ std::array<u8, 16> AesCipher(const std::array<u8, 16>& input, const std::array<u
     Cipher();
     return output;
 }
+
+void AesCipherBlocks(u8* blocks, size_t count, const std::array<u8, 16>& key) {
+    Key = key.data();
+    KeyExpansion();
+    for (size_t i = 0; i < count; ++i) {
+        state = (state_t*)(blocks + i * KEYLEN);
+        Cipher();
+    }
+}
 }
@@ -0,0 +1,82 @@
+// Copyright 2017 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <cstring>
+#include <wmmintrin.h>
+#include "common/swap.h"
+#include "core/aes/aes_ni.h"
+
+namespace AES {
+
+/// Number of counter blocks encrypted together to hide the latency of the round instructions
+constexpr size_t pipeline_blocks = 8;
+
+static __m128i ExpandKeyStep(__m128i key, __m128i assist) {
+    assist = _mm_shuffle_epi32(assist, _MM_SHUFFLE(3, 3, 3, 3));
+    key = _mm_xor_si128(key, _mm_slli_si128(key, 4));
+    key = _mm_xor_si128(key, _mm_slli_si128(key, 4));
+    key = _mm_xor_si128(key, _mm_slli_si128(key, 4));
+    return _mm_xor_si128(key, assist);
+}
+
+static void ExpandKey(const std::array<u8, 16>& key, __m128i (&round_keys)[11]) {
+    // The round constant has to be an immediate, so the steps can't be a loop
+    round_keys[0] = _mm_loadu_si128(reinterpret_cast<const __m128i*>(key.data()));
+    round_keys[1] = ExpandKeyStep(round_keys[0], _mm_aeskeygenassist_si128(round_keys[0], 0x01));
+    round_keys[2] = ExpandKeyStep(round_keys[1], _mm_aeskeygenassist_si128(round_keys[1], 0x02));
+    round_keys[3] = ExpandKeyStep(round_keys[2], _mm_aeskeygenassist_si128(round_keys[2], 0x04));
+    round_keys[4] = ExpandKeyStep(round_keys[3], _mm_aeskeygenassist_si128(round_keys[3], 0x08));
+    round_keys[5] = ExpandKeyStep(round_keys[4], _mm_aeskeygenassist_si128(round_keys[4], 0x10));
+    round_keys[6] = ExpandKeyStep(round_keys[5], _mm_aeskeygenassist_si128(round_keys[5], 0x20));
+    round_keys[7] = ExpandKeyStep(round_keys[6], _mm_aeskeygenassist_si128(round_keys[6], 0x40));
+    round_keys[8] = ExpandKeyStep(round_keys[7], _mm_aeskeygenassist_si128(round_keys[7], 0x80));
+    round_keys[9] = ExpandKeyStep(round_keys[8], _mm_aeskeygenassist_si128(round_keys[8], 0x1B));
+    round_keys[10] = ExpandKeyStep(round_keys[9], _mm_aeskeygenassist_si128(round_keys[9], 0x36));
+}
+
+void AesNiCtrXorBlocks(u8* data, size_t blocks, const std::array<u8, 16>& key,
+                       std::array<u8, 16>& ctr) {
+    __m128i round_keys[11];
+    ExpandKey(key, round_keys);
+
+    // The counter is a 128-bit big endian integer, kept as two native halves
+    u64_be ctr_high, ctr_low;
+    std::memcpy(&ctr_high, ctr.data(), sizeof(u64));
+    std::memcpy(&ctr_low, ctr.data() + 8, sizeof(u64));
+    u64 high = ctr_high, low = ctr_low;
+
+    while (blocks > 0) {
+        const size_t count = blocks < pipeline_blocks ? blocks : pipeline_blocks;
+
+        __m128i state[pipeline_blocks];
+        for (size_t i = 0; i < count; ++i) {
+            state[i] = _mm_set_epi64x(static_cast<s64>(Common::swap64(low)),
+                                      static_cast<s64>(Common::swap64(high)));
+            if (++low == 0)
+                ++high;
+            state[i] = _mm_xor_si128(state[i], round_keys[0]);
+        }
+
+        for (size_t round = 1; round < 10; ++round) {
+            for (size_t i = 0; i < count; ++i)
+                state[i] = _mm_aesenc_si128(state[i], round_keys[round]);
+        }
+
+        __m128i* block = reinterpret_cast<__m128i*>(data);
+        for (size_t i = 0; i < count; ++i) {
+            const __m128i xorpad = _mm_aesenclast_si128(state[i], round_keys[10]);
+            _mm_storeu_si128(block + i, _mm_xor_si128(_mm_loadu_si128(block + i), xorpad));
+        }
+
+        data += count * 16;
+        blocks -= count;
+    }
+
+    ctr_high = high;
+    ctr_low = low;
+    std::memcpy(ctr.data(), &ctr_high, sizeof(u64));
+    std::memcpy(ctr.data() + 8, &ctr_low, sizeof(u64));
+}
+
+} // namespace AES
@@ -0,0 +1,24 @@
+// Copyright 2017 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include "common/common_types.h"
+
+namespace AES {
+
+/**
+ * XORs whole blocks with the AES-CTR keystream using the AES-NI instructions. Must only be called
+ * when the host CPU supports them.
+ * @param data Data to decrypt or encrypt in place.
+ * @param blocks Number of 16-byte blocks in data.
+ * @param key Key.
+ * @param ctr Counter of the first block. Advanced past the blocks processed.
+ */
+void AesNiCtrXorBlocks(u8* data, size_t blocks, const std::array<u8, 16>& key,
+                       std::array<u8, 16>& ctr);
+
+} // namespace AES
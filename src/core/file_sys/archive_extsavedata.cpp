@@ -21,9 +21,12 @@
 
 namespace FileSys {
 
+static const ResultCode ERROR_WRITE_BEYOND_END(ErrorDescription::FS_WriteBeyondEnd, ErrorModule::FS,
+                                               ErrorSummary::InvalidArgument, ErrorLevel::Usage);
+
 /**
  * A modified version of DiskFile for fixed-size file used by ExtSaveData
- * The file size can't be changed by SetSize or Write.
+ * The file size can't be changed by SetSize, Write or WriteGather.
  */
 class FixSizeDiskFile : public DiskFile {
 public:
@@ -38,8 +41,7 @@ public:
     ResultVal<size_t> Write(u64 offset, size_t length, bool flush,
                             const u8* buffer) const override {
         if (offset > size) {
-            return ResultCode(ErrorDescription::FS_WriteBeyondEnd, ErrorModule::FS,
-                              ErrorSummary::InvalidArgument, ErrorLevel::Usage);
+            return ERROR_WRITE_BEYOND_END;
         } else if (offset == size) {
             return MakeResult<size_t>(0);
         }
@@ -51,6 +53,28 @@ public:
         return DiskFile::Write(offset, length, flush, buffer);
     }
 
+    ResultVal<size_t> WriteGather(u64 offset, bool flush,
+                                  const std::vector<Memory::HostSpan>& spans) const override {
+        if (offset > size) {
+            return ERROR_WRITE_BEYOND_END;
+        } else if (offset == size) {
+            return MakeResult<size_t>(0);
+        }
+
+        // Drop the part of the buffers that would extend the file
+        std::vector<Memory::HostSpan> clamped_spans;
+        u64 remaining = size - offset;
+        for (const auto& span : spans) {
+            if (remaining == 0)
+                break;
+            const size_t span_size = static_cast<size_t>(std::min<u64>(span.size, remaining));
+            clamped_spans.push_back({span.pointer, span_size});
+            remaining -= span_size;
+        }
+
+        return DiskFile::WriteGather(offset, flush, clamped_spans);
+    }
+
 private:
     u64 size{};
 };
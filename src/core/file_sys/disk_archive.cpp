@@ -37,6 +37,42 @@ ResultVal<size_t> DiskFile::Write(const u64 offset, const size_t length, const b
     return MakeResult<size_t>(written);
 }
 
+ResultVal<size_t> DiskFile::ReadScatter(const u64 offset,
+                                        const std::vector<Memory::HostSpan>& spans) const {
+    if (!mode.read_flag)
+        return ResultCode(ErrorDescription::FS_InvalidOpenFlags, ErrorModule::FS,
+                          ErrorSummary::Canceled, ErrorLevel::Status);
+
+    file->Seek(offset, SEEK_SET);
+    size_t total_read = 0;
+    for (const auto& span : spans) {
+        const size_t read = file->ReadBytes(span.pointer, span.size);
+        total_read += read;
+        if (read != span.size)
+            break;
+    }
+    return MakeResult<size_t>(total_read);
+}
+
+ResultVal<size_t> DiskFile::WriteGather(const u64 offset, const bool flush,
+                                        const std::vector<Memory::HostSpan>& spans) const {
+    if (!mode.write_flag)
+        return ResultCode(ErrorDescription::FS_InvalidOpenFlags, ErrorModule::FS,
+                          ErrorSummary::Canceled, ErrorLevel::Status);
+
+    file->Seek(offset, SEEK_SET);
+    size_t total_written = 0;
+    for (const auto& span : spans) {
+        const size_t written = file->WriteBytes(span.pointer, span.size);
+        total_written += written;
+        if (written != span.size)
+            break;
+    }
+    if (flush)
+        file->Flush();
+    return MakeResult<size_t>(total_written);
+}
+
 u64 DiskFile::GetSize() const {
     return file->GetSize();
 }
@@ -29,6 +29,10 @@ public:
 
     ResultVal<size_t> Read(u64 offset, size_t length, u8* buffer) const override;
     ResultVal<size_t> Write(u64 offset, size_t length, bool flush, const u8* buffer) const override;
+    ResultVal<size_t> ReadScatter(u64 offset,
+                                  const std::vector<Memory::HostSpan>& spans) const override;
+    ResultVal<size_t> WriteGather(u64 offset, bool flush,
+                                  const std::vector<Memory::HostSpan>& spans) const override;
     u64 GetSize() const override;
     bool SetSize(u64 size) const override;
     bool Close() const override;
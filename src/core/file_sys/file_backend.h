@@ -5,8 +5,10 @@
 #pragma once
 
 #include <cstddef>
+#include <vector>
 #include "common/common_types.h"
 #include "core/hle/result.h"
+#include "core/memory.h"
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 // FileSys namespace
@@ -38,6 +40,49 @@ public:
     virtual ResultVal<size_t> Write(u64 offset, size_t length, bool flush,
                                     const u8* buffer) const = 0;
 
+    /**
+     * Read data from the file into several buffers, filling each before moving on to the next
+     * @param offset Offset in bytes to start reading data from
+     * @param spans Buffers to read data into
+     * @return Number of bytes read, or error code
+     */
+    virtual ResultVal<size_t> ReadScatter(u64 offset,
+                                          const std::vector<Memory::HostSpan>& spans) const {
+        size_t total_read = 0;
+        for (const auto& span : spans) {
+            ResultVal<size_t> read = Read(offset + total_read, span.size, span.pointer);
+            if (read.Failed())
+                return read;
+            total_read += *read;
+            if (*read != span.size)
+                break;
+        }
+        return MakeResult<size_t>(total_read);
+    }
+
+    /**
+     * Write data from several buffers to the file, one after another
+     * @param offset Offset in bytes to start writing data to
+     * @param flush The flush parameters (0 == do not flush)
+     * @param spans Buffers to read data from
+     * @return Number of bytes written, or error code
+     */
+    virtual ResultVal<size_t> WriteGather(u64 offset, bool flush,
+                                          const std::vector<Memory::HostSpan>& spans) const {
+        size_t total_written = 0;
+        for (size_t i = 0; i < spans.size(); ++i) {
+            const bool last_span = i + 1 == spans.size();
+            ResultVal<size_t> written = Write(offset + total_written, spans[i].size,
+                                              flush && last_span, spans[i].pointer);
+            if (written.Failed())
+                return written;
+            total_written += *written;
+            if (*written != spans[i].size)
+                break;
+        }
+        return MakeResult<size_t>(total_written);
+    }
+
     /**
      * Get the size of the file in bytes
      * @return Size of the file in bytes
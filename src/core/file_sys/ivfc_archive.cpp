@@ -13,6 +13,21 @@
 
 namespace FileSys {
 
+IVFCArchive::IVFCArchive(std::shared_ptr<FileUtil::IOFile> file, u64 offset, u64 size,
+                         const AES::AesContext& ac)
+    : romfs_file(file), data_offset(offset), data_size(size), aes_context(ac) {
+    if (!romfs_file)
+        return;
+
+    auto mapping = std::make_shared<const FileUtil::MappedFile>(*romfs_file);
+    if (mapping->IsOpen() && data_offset <= mapping->GetSize() &&
+        data_size <= mapping->GetSize() - data_offset) {
+        mapped_file = std::move(mapping);
+    } else {
+        LOG_WARNING(Service_FS, "Could not map the IVFC archive, reading it through stdio");
+    }
+}
+
 std::string IVFCArchive::GetName() const {
     return "IVFC";
 }
@@ -20,7 +35,7 @@ std::string IVFCArchive::GetName() const {
 ResultVal<std::unique_ptr<FileBackend>> IVFCArchive::OpenFile(const Path& path,
                                                               const Mode& mode) const {
     return MakeResult<std::unique_ptr<FileBackend>>(
-        std::make_unique<IVFCFile>(romfs_file, data_offset, data_size, aes_context));
+        std::make_unique<IVFCFile>(romfs_file, mapped_file, data_offset, data_size, aes_context));
 }
 
 ResultCode IVFCArchive::DeleteFile(const Path& path) const {
@@ -85,38 +100,23 @@ u64 IVFCArchive::GetFreeBytes() const {
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 
-u8 IVFCFile::ReadEncryptedByte(u64 offset) const {
-    u64 index = offset / 16;
-    u8 buf_offset = offset % 16;
-    if (!decrypt_buffered || index != buf_index) {
-        decrypt_buffered = true;
-        buf_index = index;
-        std::array<u8, 16> ctr = aes_context.ctr;
-        AES::AddCtr(ctr, index);
-        std::array<u8, 16> xorpad = AES::AesCipher(ctr, aes_context.key);
-        romfs_file->Seek(data_offset + index * 16, SEEK_SET);
-        romfs_file->ReadBytes(decrypt_buf.data(), 16);
-        for (int i = 0; i < 16; ++i)
-            decrypt_buf[i] ^= xorpad[i];
-    }
-    return decrypt_buf[buf_offset];
-}
-
 ResultVal<size_t> IVFCFile::Read(const u64 offset, const size_t length, u8* buffer) const {
     LOG_TRACE(Service_FS, "called offset=%llu, length=%zu", offset, length);
     if (!romfs_file)
         return MakeResult<size_t>(0);
+    if (offset > data_size)
+        return MakeResult<size_t>(0);
     size_t read_length = (size_t)std::min((u64)length, data_size - offset);
 
-    if (aes_context.encrypted) {
-        for (size_t i = 0; i < read_length; ++i) {
-            buffer[i] = ReadEncryptedByte(offset + i);
-        }
-        return MakeResult<size_t>(read_length);
+    if (mapped_file) {
+        std::memcpy(buffer, mapped_file->GetData() + data_offset + offset, read_length);
     } else {
         romfs_file->Seek(data_offset + offset, SEEK_SET);
-        return MakeResult<size_t>(romfs_file->ReadBytes(buffer, read_length));
+        read_length = romfs_file->ReadBytes(buffer, read_length);
     }
+    if (aes_context.encrypted)
+        AES::AesCtrDecrypt(buffer, read_length, aes_context.key, aes_context.ctr, offset);
+    return MakeResult<size_t>(read_length);
 }
 
 ResultVal<size_t> IVFCFile::Write(const u64 offset, const size_t length, const bool flush,
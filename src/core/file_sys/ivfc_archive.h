@@ -29,8 +29,7 @@ namespace FileSys {
 class IVFCArchive : public ArchiveBackend {
 public:
     IVFCArchive(std::shared_ptr<FileUtil::IOFile> file, u64 offset, u64 size,
-                const AES::AesContext& ac = AES::AesContext())
-        : romfs_file(file), data_offset(offset), data_size(size), aes_context(ac) {}
+                const AES::AesContext& ac = AES::AesContext());
 
     std::string GetName() const override;
 
@@ -48,6 +47,8 @@ public:
 
 protected:
     std::shared_ptr<FileUtil::IOFile> romfs_file;
+    /// View of romfs_file that reads are served from, or nullptr if it couldn't be mapped
+    std::shared_ptr<const FileUtil::MappedFile> mapped_file;
     u64 data_offset;
     u64 data_size;
     AES::AesContext aes_context;
@@ -55,9 +56,11 @@ protected:
 
 class IVFCFile : public FileBackend {
 public:
-    IVFCFile(std::shared_ptr<FileUtil::IOFile> file, u64 offset, u64 size,
+    IVFCFile(std::shared_ptr<FileUtil::IOFile> file,
+             std::shared_ptr<const FileUtil::MappedFile> mapped_file, u64 offset, u64 size,
              const AES::AesContext& ac)
-        : romfs_file(file), data_offset(offset), data_size(size), aes_context(ac) {}
+        : romfs_file(file), mapped_file(mapped_file), data_offset(offset), data_size(size),
+          aes_context(ac) {}
 		
     ResultVal<size_t> Read(u64 offset, size_t length, u8* buffer) const override;
     ResultVal<size_t> Write(u64 offset, size_t length, bool flush, const u8* buffer) const override;
@@ -69,14 +72,11 @@ public:
     void Flush() const override {}
 
 private:
-    u8 ReadEncryptedByte(u64 offset) const;
     std::shared_ptr<FileUtil::IOFile> romfs_file;
+    std::shared_ptr<const FileUtil::MappedFile> mapped_file;
     u64 data_offset;
     u64 data_size;
     AES::AesContext aes_context;
-    mutable std::array<u8, 16> decrypt_buf;
-    mutable u64 buf_index;
-    mutable bool decrypt_buffered = false;
 };
 
 class IVFCDirectory : public DirectoryBackend {
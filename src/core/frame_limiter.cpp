@@ -0,0 +1,78 @@
+// Copyright 2017 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <thread>
+#include "common/profiler_reporting.h"
+#include "core/frame_limiter.h"
+
+namespace Core {
+
+using std::chrono::duration_cast;
+using std::chrono::microseconds;
+using std::chrono::nanoseconds;
+
+/// Duration of one frame at native speed
+constexpr nanoseconds NATIVE_FRAME_TIME{1000000000 / 60};
+/// Max lag caused by slow frames. Frames that finish later than this behind their deadline no
+/// longer get to catch up by running faster, which keeps the limiter from fast-forwarding after
+/// spikes.
+constexpr microseconds MAX_LAG_TIME{18000};
+/// Bounds for the spin margin before the deadline
+constexpr microseconds MIN_SPIN_MARGIN{200};
+constexpr microseconds MAX_SPIN_MARGIN{4000};
+
+FrameLimiter::FrameLimiter() : spin_margin(microseconds{1000}) {
+    Reset();
+}
+
+void FrameLimiter::Reset() {
+    frame_start = frame_deadline = Clock::now();
+}
+
+void FrameLimiter::DoFrameLimiting(u32 speed_percent, double speed_factor) {
+    const Clock::time_point wait_start = Clock::now();
+
+    if (speed_percent == 0) {
+        // Unlimited: keep the deadline tracking the present so re-enabling the limiter does not
+        // start out with a backlog.
+        frame_deadline = wait_start;
+    } else {
+        const std::chrono::duration<double, std::nano> frame_time =
+            NATIVE_FRAME_TIME * (100.0 / (speed_percent * speed_factor));
+        frame_deadline += duration_cast<Clock::duration>(frame_time);
+        frame_deadline = std::max(frame_deadline, wait_start - MAX_LAG_TIME);
+        // A frame never waits longer than one period, e.g. after the speed limit was raised
+        frame_deadline =
+            std::min(frame_deadline, wait_start + duration_cast<Clock::duration>(frame_time));
+
+        const Clock::time_point sleep_until = frame_deadline - spin_margin;
+        if (wait_start < sleep_until) {
+            std::this_thread::sleep_until(sleep_until);
+
+            // Let the margin follow the worst recent oversleep, decaying slowly towards the
+            // minimum when sleeps are accurate.
+            const Clock::duration oversleep = Clock::now() - sleep_until;
+            spin_margin = std::max(oversleep + MIN_SPIN_MARGIN, spin_margin - spin_margin / 16);
+            spin_margin = std::min<Clock::duration>(
+                std::max<Clock::duration>(spin_margin, MIN_SPIN_MARGIN), MAX_SPIN_MARGIN);
+        }
+
+        while (Clock::now() < frame_deadline) {
+            std::this_thread::yield();
+        }
+    }
+
+    const Clock::time_point wait_end = Clock::now();
+
+    using Common::Profiling::Duration;
+    Common::Profiling::GetProfilingManager().SetFramePacingResults(
+        duration_cast<Duration>(wait_start - frame_start),
+        duration_cast<Duration>(wait_end - wait_start),
+        duration_cast<Duration>(std::max(wait_end - frame_deadline, Clock::duration::zero())));
+
+    frame_start = wait_end;
+}
+
+} // namespace Core
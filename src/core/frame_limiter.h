@@ -0,0 +1,46 @@
+// Copyright 2017 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <chrono>
+#include "common/common_types.h"
+
+namespace Core {
+
+/**
+ * Paces emulated frames against the host's steady clock. Each frame gets a deadline one frame
+ * period after the previous one; the limiter sleeps until shortly before the deadline and spins
+ * for the remainder, since OS sleeps routinely overshoot by a millisecond or more. Per-frame
+ * emulation time, wait time and overshoot are published through the profiling manager.
+ */
+class FrameLimiter final {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    FrameLimiter();
+
+    /// Restarts pacing from the current time, discarding any accumulated lag.
+    void Reset();
+
+    /**
+     * Waits until the deadline of the frame that just finished emulating.
+     * @param speed_percent Target emulation speed in percent of the console's native frame rate.
+     *                      0 disables waiting, but frame statistics are still recorded.
+     * @param speed_factor Fine adjustment applied on top of speed_percent, e.g. to keep pace
+     *                     with audio output.
+     */
+    void DoFrameLimiting(u32 speed_percent, double speed_factor);
+
+private:
+    /// Start of the current frame's emulation, i.e. when the previous wait ended
+    Clock::time_point frame_start;
+    /// Point in time at which the current frame should be presented
+    Clock::time_point frame_deadline;
+    /// How long before the deadline sleeping stops and spinning begins. Adapts to the observed
+    /// oversleep of the host's sleep primitive.
+    Clock::duration spin_margin;
+};
+
+} // namespace Core
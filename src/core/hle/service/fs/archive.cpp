@@ -110,13 +110,20 @@ void File::HandleSyncRequest(Kernel::SharedPtr<Kernel::ServerSession> server_ses
                       offset, length, backend->GetSize());
         }
 
-        std::vector<u8> data(length);
-        ResultVal<size_t> read = backend->Read(offset, data.size(), data.data());
+        ResultVal<size_t> read;
+        if (Memory::GetHostSpans(address, length, true, buffer_spans)) {
+            // Read straight into emulated memory
+            read = backend->ReadScatter(offset, buffer_spans);
+        } else {
+            std::vector<u8> data(length);
+            read = backend->Read(offset, data.size(), data.data());
+            if (read.Succeeded())
+                Memory::WriteBlock(address, data.data(), *read);
+        }
         if (read.Failed()) {
             cmd_buff[1] = read.Code().raw;
             return;
         }
-        Memory::WriteBlock(address, data.data(), *read);
         cmd_buff[2] = static_cast<u32>(*read);
         break;
     }
@@ -130,9 +137,15 @@ void File::HandleSyncRequest(Kernel::SharedPtr<Kernel::ServerSession> server_ses
         LOG_TRACE(Service_FS, "Write %s: offset=0x%llx length=%d address=0x%x, flush=0x%x",
                   GetName().c_str(), offset, length, address, flush);
 
-        std::vector<u8> data(length);
-        Memory::ReadBlock(address, data.data(), data.size());
-        ResultVal<size_t> written = backend->Write(offset, data.size(), flush != 0, data.data());
+        ResultVal<size_t> written;
+        if (Memory::GetHostSpans(address, length, false, buffer_spans)) {
+            // Write straight from emulated memory
+            written = backend->WriteGather(offset, flush != 0, buffer_spans);
+        } else {
+            std::vector<u8> data(length);
+            Memory::ReadBlock(address, data.data(), data.size());
+            written = backend->Write(offset, data.size(), flush != 0, data.data());
+        }
         if (written.Failed()) {
             cmd_buff[1] = written.Code().raw;
             return;
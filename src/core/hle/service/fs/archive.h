@@ -6,10 +6,12 @@
 
 #include <memory>
 #include <string>
+#include <vector>
 #include "common/common_types.h"
 #include "core/file_sys/archive_backend.h"
 #include "core/hle/kernel/server_session.h"
 #include "core/hle/result.h"
+#include "core/memory.h"
 
 namespace FileSys {
 class DirectoryBackend;
@@ -58,6 +60,10 @@ public:
 
 protected:
     void HandleSyncRequest(Kernel::SharedPtr<Kernel::ServerSession> server_session) override;
+
+private:
+    /// Host memory backing the guest buffer of the current request, kept to reuse its storage
+    std::vector<Memory::HostSpan> buffer_spans;
 };
 
 class Directory final : public SessionRequestHandler {
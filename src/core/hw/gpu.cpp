@@ -5,18 +5,18 @@
 #include <cstring>
 #include <numeric>
 #include <type_traits>
+#include "audio_core/audio_core.h"
 #include "common/color.h"
 #include "common/common_types.h"
 #include "common/logging/log.h"
-#include "common/math_util.h"
 #include "common/microprofile.h"
-#include "common/thread.h"
-#include "common/timer.h"
 #include "common/vector_math.h"
 #include "core/core_timing.h"
+#include "core/frame_limiter.h"
 #include "core/hle/service/gsp_gpu.h"
 #include "core/hle/service/hid/hid.h"
 #include "core/hw/gpu.h"
+#include "core/hw/gpu_kernels.h"
 #include "core/hw/hw.h"
 #include "core/memory.h"
 #include "core/settings.h"
@@ -35,14 +35,8 @@ Regs g_regs;
 static int vblank_event;
 /// Total number of frames drawn
 static u64 frame_count;
-/// Start clock for frame limiter
-static u32 time_point;
-/// Total delay caused by slow frames
-static float time_delay;
-constexpr float FIXED_FRAME_TIME = 1000.0f / 60;
-// Max lag caused by slow frames. Can be adjusted to compensate for too many slow frames. Higher
-// values increases time needed to limit frame rate after spikes
-constexpr float MAX_LAG_TIME = 18;
+/// Paces emulation to the configured speed
+static Core::FrameLimiter frame_limiter;
 
 template <typename T>
 inline void Read(T& var, const u32 raw_addr) {
@@ -122,27 +116,7 @@ static void MemoryFill(const Regs::MemoryFillConfig& config) {
     Memory::RasterizerFlushAndInvalidateRegion(config.GetStartAddress(),
                                                config.GetEndAddress() - config.GetStartAddress());
 
-    if (config.fill_24bit) {
-        // fill with 24-bit values
-        for (u8* ptr = start; ptr < end; ptr += 3) {
-            ptr[0] = config.value_24bit_r;
-            ptr[1] = config.value_24bit_g;
-            ptr[2] = config.value_24bit_b;
-        }
-    } else if (config.fill_32bit) {
-        // fill with 32-bit values
-        if (end > start) {
-            u32 value = config.value_32bit;
-            size_t len = (end - start) / sizeof(u32);
-            for (size_t i = 0; i < len; ++i)
-                memcpy(&start[i * sizeof(u32)], &value, sizeof(u32));
-        }
-    } else {
-        // fill with 16-bit values
-        u16 value_16bit = config.value_16bit.Value();
-        for (u8* ptr = start; ptr < end; ptr += sizeof(u16))
-            memcpy(ptr, &value_16bit, sizeof(u16));
-    }
+    Kernels::MemoryFill(config, start, end);
 }
 
 static void DisplayTransfer(const Regs::DisplayTransferConfig& config) {
@@ -212,6 +186,15 @@ static void DisplayTransfer(const Regs::DisplayTransferConfig& config) {
     Memory::RasterizerFlushRegion(config.GetPhysicalInputAddress(), input_size);
     Memory::RasterizerFlushAndInvalidateRegion(config.GetPhysicalOutputAddress(), output_size);
 
+    if (!src_pointer || !dst_pointer) {
+        LOG_CRITICAL(HW_GPU, "Invalid display transfer from 0x%08X to 0x%08X", src_addr, dst_addr);
+        return;
+    }
+
+    if (Kernels::DisplayTransfer(config, src_pointer, dst_pointer))
+        return;
+
+    // Generic per-pixel path for configurations the kernels don't handle
     for (u32 y = 0; y < output_height; ++y) {
         for (u32 x = 0; x < output_width; ++x) {
             Math::Vec4<u8> src_color;
@@ -273,10 +256,6 @@ static void DisplayTransfer(const Regs::DisplayTransferConfig& config) {
                                  out_coarse_y * out_stride;
                 }
             }
-                        if (!dst_pointer) {
-                            LOG_CRITICAL(HW_GPU, "Invalid address %08x", dst_pointer);
-                            break;
-                        }
             const u8* src_pixel = src_pointer + src_offset;
             src_color = DecodePixel(config.input_format, src_pixel);
             if (config.scaling == config.ScaleX) {
@@ -375,29 +354,8 @@ static void TextureCopy(const Regs::DisplayTransferConfig& config) {
     Memory::RasterizerFlushAndInvalidateRegion(config.GetPhysicalOutputAddress(),
                                                static_cast<u32>(contiguous_output_size));
 
-    u32 remaining_size = config.texture_copy.size;
-    u32 remaining_input = input_width;
-    u32 remaining_output = output_width;
-    while (remaining_size > 0) {
-        u32 copy_size = std::min({remaining_input, remaining_output, remaining_size});
-
-        std::memcpy(dst_pointer, src_pointer, copy_size);
-        src_pointer += copy_size;
-        dst_pointer += copy_size;
-
-        remaining_input -= copy_size;
-        remaining_output -= copy_size;
-        remaining_size -= copy_size;
-
-        if (remaining_input == 0) {
-            remaining_input = input_width;
-            src_pointer += input_gap;
-        }
-        if (remaining_output == 0) {
-            remaining_output = output_width;
-            dst_pointer += output_gap;
-        }
-    }
+    Kernels::TextureCopy(src_pointer, dst_pointer, config.texture_copy.size, input_width,
+                         input_gap, output_width, output_gap);
 }
 
 template <typename T>
@@ -491,7 +449,7 @@ inline void Write(u32 addr, const T data) {
                                                                 config.GetPhysicalAddress());
             }
 
-            Pica::CommandProcessor::ProcessCommandList(buffer, config.size);
+            Pica::CommandProcessor::ProcessCommandList(config.GetPhysicalAddress(), config.size);
 
             g_regs.command_processor_config.trigger = 0;
         }
@@ -523,21 +481,6 @@ template void Write<u32>(u32 addr, const u32 data);
 template void Write<u16>(u32 addr, const u16 data);
 template void Write<u8>(u32 addr, const u8 data);
 
-static void FrameLimiter() {
-    time_delay += FIXED_FRAME_TIME;
-    time_delay = MathUtil::Clamp(time_delay, -MAX_LAG_TIME, MAX_LAG_TIME);
-    s32 desired_time = static_cast<s32>(time_delay);
-    s32 elapsed_time = static_cast<s32>(Common::Timer::GetTimeMs() - time_point);
-
-    if (elapsed_time < desired_time) {
-        Common::SleepCurrentThread(desired_time - elapsed_time);
-    }
-
-    u32 frame_time = Common::Timer::GetTimeMs() - time_point;
-
-    time_delay -= frame_time;
-}
-
 /// Update hardware
 static void VBlankCallback(u64 userdata, int cycles_late) {
     frame_count++;
@@ -551,11 +494,10 @@ static void VBlankCallback(u64 userdata, int cycles_late) {
     Service::GSP::SignalInterrupt(Service::GSP::InterruptId::PDC0);
     Service::GSP::SignalInterrupt(Service::GSP::InterruptId::PDC1);
 
-    if (!Settings::values.use_vsync && Settings::values.toggle_framelimit) {
-        FrameLimiter();
-    }
-
-    time_point = Common::Timer::GetTimeMs();
+    // The limiter still runs when unlimited so that emulation times keep being reported
+    const bool limit = !Settings::values.use_vsync && Settings::values.toggle_framelimit;
+    frame_limiter.DoFrameLimiting(limit ? Settings::values.frame_limit : 0,
+                                  AudioCore::GetSpeedGovernorFactor());
 
     // Reschedule recurrent event
     CoreTiming::ScheduleEvent(frame_ticks - cycles_late, vblank_event);
@@ -592,7 +534,7 @@ void Init() {
     framebuffer_sub.active_fb = 0;
 
     frame_count = 0;
-    time_point = Common::Timer::GetTimeMs();
+    frame_limiter.Reset();
 
     vblank_event = CoreTiming::RegisterEvent("GPU::VBlankCallback", VBlankCallback);
     CoreTiming::ScheduleEvent(frame_ticks, vblank_event);
@@ -0,0 +1,619 @@
+// Copyright 2017 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstring>
+#include <vector>
+#include "common/assert.h"
+#include "common/color.h"
+#include "common/common_types.h"
+#include "common/vector_math.h"
+#include "core/hw/gpu.h"
+#include "core/hw/gpu_kernels.h"
+#include "video_core/utils.h"
+
+#ifdef ARCHITECTURE_x86_64
+#include <emmintrin.h>
+#endif // ARCHITECTURE_x86_64
+
+namespace GPU {
+namespace Kernels {
+
+using PixelFormat = Regs::PixelFormat;
+
+// Display transfers convert through an intermediate format with one byte each of R, G, B and A,
+// in this order in memory (i.e. the layout of Math::Vec4<u8>). Each pixel is handled as a u32.
+static_assert(sizeof(Math::Vec4<u8>) == sizeof(u32), "Intermediate pixels must fit into a u32");
+
+/// Decodes `count` consecutive pixels into the intermediate format
+using DecodeFunc = void (*)(const u8* src, u32* dst, size_t count);
+/// Encodes `count` consecutive pixels from the intermediate format
+using EncodeFunc = void (*)(const u32* src, u8* dst, size_t count);
+
+constexpr size_t TILE_SIZE = 8 * 8;
+
+static size_t BytesPerPixel(PixelFormat format) {
+    return static_cast<size_t>(Regs::BytesPerPixel(format));
+}
+
+template <PixelFormat format>
+static Math::Vec4<u8> DecodePixel(const u8* src) {
+    switch (format) {
+    case PixelFormat::RGBA8:
+        return Color::DecodeRGBA8(src);
+    case PixelFormat::RGB8:
+        return Color::DecodeRGB8(src);
+    case PixelFormat::RGB565:
+        return Color::DecodeRGB565(src);
+    case PixelFormat::RGB5A1:
+        return Color::DecodeRGB5A1(src);
+    case PixelFormat::RGBA4:
+        return Color::DecodeRGBA4(src);
+    default:
+        UNREACHABLE();
+    }
+}
+
+template <PixelFormat format>
+static void EncodePixel(const Math::Vec4<u8>& color, u8* dst) {
+    switch (format) {
+    case PixelFormat::RGBA8:
+        return Color::EncodeRGBA8(color, dst);
+    case PixelFormat::RGB8:
+        return Color::EncodeRGB8(color, dst);
+    case PixelFormat::RGB565:
+        return Color::EncodeRGB565(color, dst);
+    case PixelFormat::RGB5A1:
+        return Color::EncodeRGB5A1(color, dst);
+    case PixelFormat::RGBA4:
+        return Color::EncodeRGBA4(color, dst);
+    default:
+        UNREACHABLE();
+    }
+}
+
+/// Decodes pixels one by one, used for the tails of the vectorized kernels and for RGB8
+template <PixelFormat format, size_t bytes_per_pixel>
+static void DecodePixels(const u8* src, u32* dst, size_t count) {
+    for (size_t i = 0; i < count; ++i) {
+        Math::Vec4<u8> color = DecodePixel<format>(src + i * bytes_per_pixel);
+        std::memcpy(&dst[i], &color, sizeof(u32));
+    }
+}
+
+/// Encodes pixels one by one, used for the tails of the vectorized kernels and for RGB8
+template <PixelFormat format, size_t bytes_per_pixel>
+static void EncodePixels(const u32* src, u8* dst, size_t count) {
+    for (size_t i = 0; i < count; ++i) {
+        Math::Vec4<u8> color;
+        std::memcpy(&color, &src[i], sizeof(u32));
+        EncodePixel<format>(color, dst + i * bytes_per_pixel);
+    }
+}
+
+#ifdef ARCHITECTURE_x86_64
+
+/// Reverses the byte order of each 32-bit lane
+static __m128i ByteSwap32(__m128i value) {
+    value = _mm_or_si128(_mm_slli_epi16(value, 8), _mm_srli_epi16(value, 8));
+    return _mm_or_si128(_mm_slli_epi32(value, 16), _mm_srli_epi32(value, 16));
+}
+
+/// Widens a 4-bit component in each 16-bit lane to 8 bits
+static __m128i Expand4To8(__m128i value) {
+    return _mm_or_si128(_mm_slli_epi16(value, 4), value);
+}
+
+/// Widens a 5-bit component in each 16-bit lane to 8 bits
+static __m128i Expand5To8(__m128i value) {
+    return _mm_or_si128(_mm_slli_epi16(value, 3), _mm_srli_epi16(value, 2));
+}
+
+/// Widens a 6-bit component in each 16-bit lane to 8 bits
+static __m128i Expand6To8(__m128i value) {
+    return _mm_or_si128(_mm_slli_epi16(value, 2), _mm_srli_epi16(value, 4));
+}
+
+/**
+ * Decodes eight 16-bit pixels to the intermediate format.
+ * @param pixels Eight pixels, one per 16-bit lane
+ * @param dst Destination for the eight decoded pixels
+ */
+template <PixelFormat format>
+static void Decode16BitPixels(__m128i pixels, u32* dst) {
+    const __m128i mask4 = _mm_set1_epi16(0xF);
+    const __m128i mask5 = _mm_set1_epi16(0x1F);
+    const __m128i mask6 = _mm_set1_epi16(0x3F);
+    __m128i r, g, b, a;
+
+    switch (format) {
+    case PixelFormat::RGB565:
+        r = Expand5To8(_mm_srli_epi16(pixels, 11));
+        g = Expand6To8(_mm_and_si128(_mm_srli_epi16(pixels, 5), mask6));
+        b = Expand5To8(_mm_and_si128(pixels, mask5));
+        a = _mm_set1_epi16(0xFF);
+        break;
+    case PixelFormat::RGB5A1:
+        r = Expand5To8(_mm_srli_epi16(pixels, 11));
+        g = Expand5To8(_mm_and_si128(_mm_srli_epi16(pixels, 6), mask5));
+        b = Expand5To8(_mm_and_si128(_mm_srli_epi16(pixels, 1), mask5));
+        a = _mm_srli_epi16(_mm_sub_epi16(_mm_setzero_si128(),
+                                         _mm_and_si128(pixels, _mm_set1_epi16(1))),
+                           8);
+        break;
+    case PixelFormat::RGBA4:
+        r = Expand4To8(_mm_srli_epi16(pixels, 12));
+        g = Expand4To8(_mm_and_si128(_mm_srli_epi16(pixels, 8), mask4));
+        b = Expand4To8(_mm_and_si128(_mm_srli_epi16(pixels, 4), mask4));
+        a = Expand4To8(_mm_and_si128(pixels, mask4));
+        break;
+    default:
+        UNREACHABLE();
+    }
+
+    const __m128i rg = _mm_or_si128(r, _mm_slli_epi16(g, 8));
+    const __m128i ba = _mm_or_si128(b, _mm_slli_epi16(a, 8));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(dst), _mm_unpacklo_epi16(rg, ba));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + 4), _mm_unpackhi_epi16(rg, ba));
+}
+
+/**
+ * Encodes four pixels from the intermediate format to a 16-bit format.
+ * @returns The encoded pixels, sign-extended to 32 bits per lane so that they can be packed with
+ *          _mm_packs_epi32
+ */
+template <PixelFormat format>
+static __m128i Encode16BitPixels(__m128i pixels) {
+    const __m128i mask8 = _mm_set1_epi32(0xFF);
+    const __m128i r = _mm_and_si128(pixels, mask8);
+    const __m128i g = _mm_and_si128(_mm_srli_epi32(pixels, 8), mask8);
+    const __m128i b = _mm_and_si128(_mm_srli_epi32(pixels, 16), mask8);
+    const __m128i a = _mm_srli_epi32(pixels, 24);
+    __m128i result;
+
+    switch (format) {
+    case PixelFormat::RGB565:
+        result = _mm_or_si128(_mm_or_si128(_mm_slli_epi32(_mm_srli_epi32(r, 3), 11),
+                                           _mm_slli_epi32(_mm_srli_epi32(g, 2), 5)),
+                              _mm_srli_epi32(b, 3));
+        break;
+    case PixelFormat::RGB5A1:
+        result = _mm_or_si128(_mm_or_si128(_mm_slli_epi32(_mm_srli_epi32(r, 3), 11),
+                                           _mm_slli_epi32(_mm_srli_epi32(g, 3), 6)),
+                              _mm_or_si128(_mm_slli_epi32(_mm_srli_epi32(b, 3), 1),
+                                           _mm_srli_epi32(a, 7)));
+        break;
+    case PixelFormat::RGBA4:
+        result = _mm_or_si128(_mm_or_si128(_mm_slli_epi32(_mm_srli_epi32(r, 4), 12),
+                                           _mm_slli_epi32(_mm_srli_epi32(g, 4), 8)),
+                              _mm_or_si128(_mm_slli_epi32(_mm_srli_epi32(b, 4), 4),
+                                           _mm_srli_epi32(a, 4)));
+        break;
+    default:
+        UNREACHABLE();
+    }
+
+    return _mm_srai_epi32(_mm_slli_epi32(result, 16), 16);
+}
+
+static void DecodeRGBA8(const u8* src, u32* dst, size_t count) {
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        __m128i pixels = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i * 4));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), ByteSwap32(pixels));
+    }
+    DecodePixels<PixelFormat::RGBA8, 4>(src + i * 4, dst + i, count - i);
+}
+
+static void EncodeRGBA8(const u32* src, u8* dst, size_t count) {
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        __m128i pixels = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i * 4), ByteSwap32(pixels));
+    }
+    EncodePixels<PixelFormat::RGBA8, 4>(src + i, dst + i * 4, count - i);
+}
+
+template <PixelFormat format>
+static void Decode16Bit(const u8* src, u32* dst, size_t count) {
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        __m128i pixels = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i * 2));
+        Decode16BitPixels<format>(pixels, dst + i);
+    }
+    DecodePixels<format, 2>(src + i * 2, dst + i, count - i);
+}
+
+template <PixelFormat format>
+static void Encode16Bit(const u32* src, u8* dst, size_t count) {
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        __m128i lo = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+        __m128i hi = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i + 4));
+        __m128i pixels =
+            _mm_packs_epi32(Encode16BitPixels<format>(lo), Encode16BitPixels<format>(hi));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i * 2), pixels);
+    }
+    EncodePixels<format, 2>(src + i, dst + i * 2, count - i);
+}
+
+/// Computes floor((a + b) / 2) for each byte
+static __m128i AverageFloor(__m128i a, __m128i b) {
+    const __m128i half =
+        _mm_and_si128(_mm_srli_epi16(_mm_xor_si128(a, b), 1), _mm_set1_epi8(0x7F));
+    return _mm_add_epi8(_mm_and_si128(a, b), half);
+}
+
+/// Splits eight consecutive pixels into the even and the odd ones
+static void Deinterleave(const u32* src, __m128i& even, __m128i& odd) {
+    const __m128 lo = _mm_loadu_ps(reinterpret_cast<const float*>(src));
+    const __m128 hi = _mm_loadu_ps(reinterpret_cast<const float*>(src + 4));
+    even = _mm_castps_si128(_mm_shuffle_ps(lo, hi, _MM_SHUFFLE(2, 0, 2, 0)));
+    odd = _mm_castps_si128(_mm_shuffle_ps(lo, hi, _MM_SHUFFLE(3, 1, 3, 1)));
+}
+
+#endif // ARCHITECTURE_x86_64
+
+static DecodeFunc GetDecodeFunc(PixelFormat format) {
+#ifdef ARCHITECTURE_x86_64
+    switch (format) {
+    case PixelFormat::RGBA8:
+        return DecodeRGBA8;
+    case PixelFormat::RGB8:
+        return DecodePixels<PixelFormat::RGB8, 3>;
+    case PixelFormat::RGB565:
+        return Decode16Bit<PixelFormat::RGB565>;
+    case PixelFormat::RGB5A1:
+        return Decode16Bit<PixelFormat::RGB5A1>;
+    case PixelFormat::RGBA4:
+        return Decode16Bit<PixelFormat::RGBA4>;
+    }
+#else
+    switch (format) {
+    case PixelFormat::RGBA8:
+        return DecodePixels<PixelFormat::RGBA8, 4>;
+    case PixelFormat::RGB8:
+        return DecodePixels<PixelFormat::RGB8, 3>;
+    case PixelFormat::RGB565:
+        return DecodePixels<PixelFormat::RGB565, 2>;
+    case PixelFormat::RGB5A1:
+        return DecodePixels<PixelFormat::RGB5A1, 2>;
+    case PixelFormat::RGBA4:
+        return DecodePixels<PixelFormat::RGBA4, 2>;
+    }
+#endif // ARCHITECTURE_x86_64
+    return nullptr;
+}
+
+static EncodeFunc GetEncodeFunc(PixelFormat format) {
+#ifdef ARCHITECTURE_x86_64
+    switch (format) {
+    case PixelFormat::RGBA8:
+        return EncodeRGBA8;
+    case PixelFormat::RGB8:
+        return EncodePixels<PixelFormat::RGB8, 3>;
+    case PixelFormat::RGB565:
+        return Encode16Bit<PixelFormat::RGB565>;
+    case PixelFormat::RGB5A1:
+        return Encode16Bit<PixelFormat::RGB5A1>;
+    case PixelFormat::RGBA4:
+        return Encode16Bit<PixelFormat::RGBA4>;
+    }
+#else
+    switch (format) {
+    case PixelFormat::RGBA8:
+        return EncodePixels<PixelFormat::RGBA8, 4>;
+    case PixelFormat::RGB8:
+        return EncodePixels<PixelFormat::RGB8, 3>;
+    case PixelFormat::RGB565:
+        return EncodePixels<PixelFormat::RGB565, 2>;
+    case PixelFormat::RGB5A1:
+        return EncodePixels<PixelFormat::RGB5A1, 2>;
+    case PixelFormat::RGBA4:
+        return EncodePixels<PixelFormat::RGBA4, 2>;
+    }
+#endif // ARCHITECTURE_x86_64
+    return nullptr;
+}
+
+/// Length of the repeating pattern used by memory fills, a multiple of all element sizes
+constexpr size_t FILL_PATTERN_SIZE = 48;
+
+/// Fills `size` bytes with copies of the given pattern
+static void FillPattern(u8* dst, size_t size, const std::array<u8, FILL_PATTERN_SIZE>& pattern) {
+    size_t i = 0;
+#ifdef ARCHITECTURE_x86_64
+    const __m128i p0 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&pattern[0]));
+    const __m128i p1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&pattern[16]));
+    const __m128i p2 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&pattern[32]));
+    for (; i + FILL_PATTERN_SIZE <= size; i += FILL_PATTERN_SIZE) {
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), p0);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i + 16), p1);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i + 32), p2);
+    }
+#else
+    for (; i + FILL_PATTERN_SIZE <= size; i += FILL_PATTERN_SIZE)
+        std::memcpy(dst + i, pattern.data(), FILL_PATTERN_SIZE);
+#endif // ARCHITECTURE_x86_64
+    std::memcpy(dst + i, pattern.data(), size - i);
+}
+
+void MemoryFill(const Regs::MemoryFillConfig& config, u8* start, u8* end) {
+    size_t element_size;
+    u8 value[4];
+    if (config.fill_24bit) {
+        element_size = 3;
+        value[0] = config.value_24bit_r;
+        value[1] = config.value_24bit_g;
+        value[2] = config.value_24bit_b;
+    } else if (config.fill_32bit) {
+        element_size = 4;
+        u32 value_32bit = config.value_32bit;
+        std::memcpy(value, &value_32bit, sizeof(u32));
+    } else {
+        element_size = 2;
+        u16 value_16bit = config.value_16bit.Value();
+        std::memcpy(value, &value_16bit, sizeof(u16));
+    }
+
+    size_t size = end - start;
+    if (element_size == 4) {
+        size -= size % element_size;
+    } else {
+        // Round up to whole elements
+        size += (element_size - size % element_size) % element_size;
+    }
+
+    // Zero fills (and other values consisting of a single repeated byte) are plain memsets
+    if (std::all_of(value, value + element_size, [&](u8 byte) { return byte == value[0]; })) {
+        std::memset(start, value[0], size);
+        return;
+    }
+
+    std::array<u8, FILL_PATTERN_SIZE> pattern;
+    for (size_t i = 0; i < FILL_PATTERN_SIZE; ++i)
+        pattern[i] = value[i % element_size];
+
+    FillPattern(start, size, pattern);
+}
+
+/// Box-filters horizontal pairs of pixels of a row, producing `count` output pixels
+static void DownscaleX(const u32* src, u32* dst, size_t count) {
+    size_t i = 0;
+#ifdef ARCHITECTURE_x86_64
+    for (; i + 4 <= count; i += 4) {
+        __m128i even, odd;
+        Deinterleave(src + i * 2, even, odd);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), AverageFloor(even, odd));
+    }
+#endif // ARCHITECTURE_x86_64
+    for (; i < count; ++i) {
+        Math::Vec4<u8> a, b;
+        std::memcpy(&a, &src[i * 2], sizeof(u32));
+        std::memcpy(&b, &src[i * 2 + 1], sizeof(u32));
+        Math::Vec4<u8> color = ((a + b) / 2).Cast<u8>();
+        std::memcpy(&dst[i], &color, sizeof(u32));
+    }
+}
+
+/// Box-filters 2x2 blocks of pixels from two rows, producing `count` output pixels
+static void DownscaleXY(const u32* src0, const u32* src1, u32* dst, size_t count) {
+    size_t i = 0;
+#ifdef ARCHITECTURE_x86_64
+    const __m128i zero = _mm_setzero_si128();
+    for (; i + 4 <= count; i += 4) {
+        __m128i even0, odd0, even1, odd1;
+        Deinterleave(src0 + i * 2, even0, odd0);
+        Deinterleave(src1 + i * 2, even1, odd1);
+
+        // Sum up the components as 16-bit values to avoid overflows
+        const __m128i sum_lo = _mm_add_epi16(
+            _mm_add_epi16(_mm_unpacklo_epi8(even0, zero), _mm_unpacklo_epi8(odd0, zero)),
+            _mm_add_epi16(_mm_unpacklo_epi8(even1, zero), _mm_unpacklo_epi8(odd1, zero)));
+        const __m128i sum_hi = _mm_add_epi16(
+            _mm_add_epi16(_mm_unpackhi_epi8(even0, zero), _mm_unpackhi_epi8(odd0, zero)),
+            _mm_add_epi16(_mm_unpackhi_epi8(even1, zero), _mm_unpackhi_epi8(odd1, zero)));
+
+        const __m128i result =
+            _mm_packus_epi16(_mm_srli_epi16(sum_lo, 2), _mm_srli_epi16(sum_hi, 2));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), result);
+    }
+#endif // ARCHITECTURE_x86_64
+    for (; i < count; ++i) {
+        Math::Vec4<u8> a, b, c, d;
+        std::memcpy(&a, &src0[i * 2], sizeof(u32));
+        std::memcpy(&b, &src0[i * 2 + 1], sizeof(u32));
+        std::memcpy(&c, &src1[i * 2], sizeof(u32));
+        std::memcpy(&d, &src1[i * 2 + 1], sizeof(u32));
+        Math::Vec4<u8> color = (((a + b) + (c + d)) / 4).Cast<u8>();
+        std::memcpy(&dst[i], &color, sizeof(u32));
+    }
+}
+
+/// Position of each pixel of an 8x8 tile (indexed by y * 8 + x) within the tile's Morton order
+static const std::array<u8, TILE_SIZE> morton_offsets = [] {
+    std::array<u8, TILE_SIZE> offsets;
+    for (u32 y = 0; y < 8; ++y)
+        for (u32 x = 0; x < 8; ++x)
+            offsets[y * 8 + x] = static_cast<u8>(VideoCore::MortonInterleave(x, y));
+    return offsets;
+}();
+
+/**
+ * Converts a row of 8x8 tiles to 8 linear rows.
+ * @param tiled Pixels of the tile row, tile after tile
+ * @param linear Destination of the first linear row
+ * @param stride Distance between linear rows in pixels
+ * @param width Width of the tile row in pixels
+ */
+static void UntileRow(const u32* tiled, u32* linear, size_t stride, size_t width) {
+    for (size_t tile_x = 0; tile_x < width; tile_x += 8, tiled += TILE_SIZE) {
+        for (size_t y = 0; y < 8; ++y) {
+            u32* row = linear + y * stride + tile_x;
+            for (size_t x = 0; x < 8; ++x)
+                row[x] = tiled[morton_offsets[y * 8 + x]];
+        }
+    }
+}
+
+/**
+ * Converts 8 linear rows to a row of 8x8 tiles.
+ * @param linear First linear row
+ * @param stride Distance between linear rows in pixels, may be negative
+ * @param tiled Destination for the pixels of the tile row, tile after tile
+ * @param width Width of the tile row in pixels
+ */
+static void TileRow(const u32* linear, ptrdiff_t stride, u32* tiled, size_t width) {
+    for (size_t tile_x = 0; tile_x < width; tile_x += 8, tiled += TILE_SIZE) {
+        for (size_t y = 0; y < 8; ++y) {
+            const u32* row = linear + static_cast<ptrdiff_t>(y) * stride + tile_x;
+            for (size_t x = 0; x < 8; ++x)
+                tiled[morton_offsets[y * 8 + x]] = row[x];
+        }
+    }
+}
+
+bool DisplayTransfer(const Regs::DisplayTransferConfig& config, const u8* src, u8* dst) {
+    const PixelFormat input_format = config.input_format;
+    const PixelFormat output_format = config.output_format;
+    const DecodeFunc decode = GetDecodeFunc(input_format);
+    const EncodeFunc encode = GetEncodeFunc(output_format);
+    if (!decode || !encode)
+        return false;
+
+    if (config.scaling > config.ScaleXY ||
+        (config.input_linear && config.scaling != config.NoScale))
+        return false;
+
+    const size_t horizontal_scale = config.scaling != config.NoScale ? 1 : 0;
+    const size_t vertical_scale = config.scaling == config.ScaleXY ? 1 : 0;
+
+    const size_t output_width = config.output_width >> horizontal_scale;
+    const size_t output_height = config.output_height >> vertical_scale;
+    const size_t input_width = config.input_width;
+    const size_t input_columns = output_width << horizontal_scale;
+    const size_t input_rows = output_height << vertical_scale;
+
+    const bool input_tiled = !config.input_linear;
+    const bool output_tiled = config.input_linear != config.dont_swizzle;
+
+    // Rows wrapping around into the next one and partial tiles are left to the generic path
+    if (output_width == 0 || output_height == 0 || input_columns > input_width)
+        return false;
+    if (input_tiled && (input_width % 8 != 0 || input_rows % 8 != 0))
+        return false;
+    if (output_tiled && (output_width % 8 != 0 || output_height % 8 != 0))
+        return false;
+
+    const size_t input_bpp = BytesPerPixel(input_format);
+    const size_t output_bpp = BytesPerPixel(output_format);
+
+    // The buffers are kept around to avoid reallocating them on every transfer
+    static std::vector<u32> image;
+    static std::vector<u32> scaled;
+    static std::vector<u32> tile_row;
+
+    // Decode the input into a linear image
+    size_t image_stride;
+    if (input_tiled) {
+        image_stride = input_width;
+        image.resize(input_width * input_rows);
+        tile_row.resize(input_width * 8);
+        for (size_t y = 0; y < input_rows; y += 8) {
+            decode(src + y * input_width * input_bpp, tile_row.data(), input_width * 8);
+            UntileRow(tile_row.data(), &image[y * image_stride], image_stride, input_width);
+        }
+    } else {
+        image_stride = output_width;
+        image.resize(output_width * output_height);
+        for (size_t y = 0; y < output_height; ++y)
+            decode(src + y * input_width * input_bpp, &image[y * image_stride], output_width);
+    }
+
+    // Downscale
+    const u32* result = image.data();
+    size_t result_stride = image_stride;
+    if (config.scaling != config.NoScale) {
+        scaled.resize(output_width * output_height);
+        for (size_t y = 0; y < output_height; ++y) {
+            const u32* row = &image[(y << vertical_scale) * image_stride];
+            if (config.scaling == config.ScaleXY)
+                DownscaleXY(row, row + image_stride, &scaled[y * output_width], output_width);
+            else
+                DownscaleX(row, &scaled[y * output_width], output_width);
+        }
+        result = scaled.data();
+        result_stride = output_width;
+    }
+
+    // Encode the output, flipping it if requested
+    const ptrdiff_t row_step = config.flip_vertically ? -static_cast<ptrdiff_t>(result_stride)
+                                                      : static_cast<ptrdiff_t>(result_stride);
+    const u32* first_row =
+        config.flip_vertically ? result + (output_height - 1) * result_stride : result;
+
+    if (output_tiled) {
+        tile_row.resize(output_width * 8);
+        for (size_t y = 0; y < output_height; y += 8) {
+            TileRow(first_row + static_cast<ptrdiff_t>(y) * row_step, row_step, tile_row.data(),
+                    output_width);
+            encode(tile_row.data(), dst + y * output_width * output_bpp, output_width * 8);
+        }
+    } else {
+        for (size_t y = 0; y < output_height; ++y) {
+            encode(first_row + static_cast<ptrdiff_t>(y) * row_step,
+                   dst + y * output_width * output_bpp, output_width);
+        }
+    }
+
+    return true;
+}
+
+void TextureCopy(const u8* src, u8* dst, u32 size, u32 input_width, u32 input_gap,
+                 u32 output_width, u32 output_gap) {
+    if (input_gap == 0 && output_gap == 0) {
+        std::memcpy(dst, src, size);
+        return;
+    }
+
+    if (input_width == output_width) {
+        // Lines of both sides match up, so every line is a single copy
+        while (size > 0) {
+            u32 copy_size = std::min(input_width, size);
+            std::memcpy(dst, src, copy_size);
+            src += input_width + input_gap;
+            dst += output_width + output_gap;
+            size -= copy_size;
+        }
+        return;
+    }
+
+    u32 remaining_input = input_width;
+    u32 remaining_output = output_width;
+    while (size > 0) {
+        u32 copy_size = std::min({remaining_input, remaining_output, size});
+
+        std::memcpy(dst, src, copy_size);
+        src += copy_size;
+        dst += copy_size;
+
+        remaining_input -= copy_size;
+        remaining_output -= copy_size;
+        size -= copy_size;
+
+        if (remaining_input == 0) {
+            remaining_input = input_width;
+            src += input_gap;
+        }
+        if (remaining_output == 0) {
+            remaining_output = output_width;
+            dst += output_gap;
+        }
+    }
+}
+
+} // namespace Kernels
+} // namespace GPU
@@ -0,0 +1,41 @@
+// Copyright 2017 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include "common/common_types.h"
+#include "core/hw/gpu.h"
+
+namespace GPU {
+namespace Kernels {
+
+/**
+ * Fills guest memory with the value configured for a memory fill. 16-bit and 24-bit fills always
+ * write whole elements, so the last one may extend past `end`. 32-bit fills stop at the last
+ * element that fits.
+ * @param config Memory fill configuration providing the fill value and element size
+ * @param start Pointer to the first byte to fill
+ * @param end Pointer past the last byte to fill
+ */
+void MemoryFill(const Regs::MemoryFillConfig& config, u8* start, u8* end);
+
+/**
+ * Performs a display transfer on the CPU using format conversion kernels selected once for the
+ * whole transfer. Only configurations with tile-aligned dimensions are supported.
+ * @param config Display transfer configuration, assumed to be validated by the caller
+ * @param src Pointer to the input image
+ * @param dst Pointer to the output image
+ * @returns false if the configuration is not supported, in which case nothing is written
+ */
+bool DisplayTransfer(const Regs::DisplayTransferConfig& config, const u8* src, u8* dst);
+
+/**
+ * Copies `size` bytes from src to dst, skipping over `input_gap` bytes after every `input_width`
+ * bytes read and `output_gap` bytes after every `output_width` bytes written.
+ */
+void TextureCopy(const u8* src, u8* dst, u32 size, u32 input_width, u32 input_gap,
+                 u32 output_width, u32 output_gap);
+
+} // namespace Kernels
+} // namespace GPU
@@ -2,6 +2,7 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
+#include <algorithm>
 #include <array>
 #include <cstring>
 #include "common/assert.h"
@@ -285,6 +286,55 @@ u8* GetPointer(const VAddr vaddr) {
     return nullptr;
 }
 
+bool GetHostSpans(const VAddr vaddr, const size_t size, const bool for_write,
+                  std::vector<HostSpan>& spans) {
+    spans.clear();
+
+    size_t remaining_size = size;
+    size_t page_index = vaddr >> PAGE_BITS;
+    size_t page_offset = vaddr & PAGE_MASK;
+
+    while (remaining_size > 0) {
+        const size_t span_size = std::min(PAGE_SIZE - page_offset, remaining_size);
+        const VAddr current_vaddr = (page_index << PAGE_BITS) + page_offset;
+
+        u8* pointer;
+        switch (current_page_table->attributes[page_index]) {
+        case PageType::Memory: {
+            DEBUG_ASSERT(current_page_table->pointers[page_index]);
+
+            pointer = current_page_table->pointers[page_index] + page_offset;
+            break;
+        }
+        case PageType::RasterizerCachedMemory: {
+            if (for_write) {
+                RasterizerFlushAndInvalidateRegion(VirtualToPhysicalAddress(current_vaddr),
+                                                   span_size);
+            } else {
+                RasterizerFlushRegion(VirtualToPhysicalAddress(current_vaddr), span_size);
+            }
+
+            pointer = GetPointerFromVMA(current_vaddr);
+            break;
+        }
+        default:
+            return false;
+        }
+
+        if (!spans.empty() && spans.back().pointer + spans.back().size == pointer) {
+            spans.back().size += span_size;
+        } else {
+            spans.push_back({pointer, span_size});
+        }
+
+        page_index++;
+        page_offset = 0;
+        remaining_size -= span_size;
+    }
+
+    return true;
+}
+
 std::string ReadCString(VAddr vaddr, std::size_t max_length) {
     std::string string;
     string.reserve(max_length);
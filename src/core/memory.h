@@ -7,6 +7,7 @@
 #include <array>
 #include <cstddef>
 #include <string>
+#include <vector>
 #include "common/common_types.h"
 
 namespace Memory {
@@ -133,6 +134,27 @@ void CopyBlock(VAddr dest_addr, VAddr src_addr, size_t size);
 
 u8* GetPointer(VAddr virtual_address);
 
+/// A range of host memory backing a region of emulated memory
+struct HostSpan {
+    u8* pointer;
+    size_t size;
+};
+
+/**
+ * Resolves a region of virtual memory to the host memory backing it, so that it can be read or
+ * written directly instead of through ReadBlock or WriteBlock. Pages adjacent in host memory are
+ * merged into one span. Rasterizer cached pages are flushed, and invalidated if the region is
+ * going to be written, the same way ReadBlock and WriteBlock do.
+ * @param virtual_address Start of the region.
+ * @param size Size of the region in bytes.
+ * @param for_write Whether the region is going to be written.
+ * @param spans Receives the spans in address order, replacing its contents.
+ * @return false if part of the region isn't backed by memory, like unmapped or MMIO pages. The
+ *         region then has to be accessed through ReadBlock or WriteBlock.
+ */
+bool GetHostSpans(VAddr virtual_address, size_t size, bool for_write,
+                  std::vector<HostSpan>& spans);
+
 std::string ReadCString(VAddr virtual_address, std::size_t max_length);
 
 /**
@@ -29,6 +29,8 @@ void Apply() {
 
     AudioCore::SelectSink(values.sink_id);
     AudioCore::EnableStretching(values.enable_audio_stretching);
+    AudioCore::EnableSpeedGovernor(values.enable_audio_speed_governor);
+    AudioCore::EnablePolyphaseInterpolation(values.enable_polyphase_interpolation);
 
     InputCore::ReloadSettings();
 }
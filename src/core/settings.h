@@ -157,6 +157,7 @@ struct Values {
     float resolution_factor;
     bool use_vsync;
     bool toggle_framelimit;
+    u16 frame_limit;
 
     LayoutOption layout_option;
     bool swap_screen;
@@ -170,6 +171,8 @@ struct Values {
     // Audio
     std::string sink_id;
     bool enable_audio_stretching;
+    bool enable_audio_speed_governor;
+    bool enable_polyphase_interpolation;
 
     std::array<std::string, Service::CAM::NumCameras> camera_name;
     std::array<std::string, Service::CAM::NumCameras> camera_config;
@@ -0,0 +1,77 @@
+// Copyright 2017 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <random>
+#include <vector>
+#include <catch.hpp>
+#include "audio_core/audio_recording.h"
+#include "common/common_types.h"
+
+namespace AudioCore {
+namespace Recording {
+
+static std::vector<s16> RoundTrip(const std::vector<s16>& samples, std::vector<u8>& compressed) {
+    const size_t sample_count = samples.size() / 2;
+    CompressFrame(samples.data(), sample_count, compressed);
+
+    std::vector<s16> decompressed(samples.size(), 0x5555);
+    REQUIRE(DecompressFrame(compressed.data(), compressed.size(), decompressed.data(),
+                            sample_count));
+    return decompressed;
+}
+
+TEST_CASE("Recording: Compression round trip", "[audio_core]") {
+    std::vector<u8> compressed;
+
+    SECTION("random") {
+        std::mt19937 rng(42);
+        std::uniform_int_distribution<int> distribution(-32768, 32767);
+        std::vector<s16> samples(160 * 2);
+        for (auto& sample : samples)
+            sample = static_cast<s16>(distribution(rng));
+        REQUIRE(RoundTrip(samples, compressed) == samples);
+    }
+
+    SECTION("full scale") {
+        std::vector<s16> samples(160 * 2);
+        for (size_t i = 0; i < samples.size(); ++i)
+            samples[i] = (i / 2) % 2 ? 32767 : -32768;
+        REQUIRE(RoundTrip(samples, compressed) == samples);
+    }
+
+    SECTION("silence") {
+        const std::vector<s16> samples(160 * 2, 0);
+        REQUIRE(RoundTrip(samples, compressed) == samples);
+        // A single run per channel
+        REQUIRE(compressed.size() <= 4);
+    }
+
+    SECTION("empty") {
+        const std::vector<s16> samples;
+        REQUIRE(RoundTrip(samples, compressed) == samples);
+        REQUIRE(compressed.empty());
+    }
+}
+
+TEST_CASE("Recording: Malformed data is rejected", "[audio_core]") {
+    std::vector<s16> samples(16 * 2);
+    for (size_t i = 0; i < samples.size(); ++i)
+        samples[i] = static_cast<s16>(i * 1000);
+
+    std::vector<u8> compressed;
+    CompressFrame(samples.data(), 16, compressed);
+    std::vector<s16> decompressed(samples.size());
+
+    // Truncated data
+    REQUIRE(!DecompressFrame(compressed.data(), compressed.size() - 1, decompressed.data(), 16));
+    // Trailing data
+    compressed.push_back(0);
+    REQUIRE(!DecompressFrame(compressed.data(), compressed.size(), decompressed.data(), 16));
+    // A run longer than the frame
+    const std::vector<u8> long_run{{0x41, 0x41}};
+    REQUIRE(!DecompressFrame(long_run.data(), long_run.size(), decompressed.data(), 16));
+}
+
+} // namespace Recording
+} // namespace AudioCore
@@ -0,0 +1,124 @@
+// Copyright 2017 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <random>
+#include <catch.hpp>
+#include "audio_core/hle/common.h"
+#include "audio_core/hle/mix_kernels.h"
+#include "common/math_util.h"
+
+namespace DSP {
+namespace HLE {
+
+// The per-sample loops that were used before the mixing kernels
+
+static s16 ClampToS16(s32 value) {
+    return static_cast<s16>(MathUtil::Clamp(value, -32768, 32767));
+}
+
+static std::array<s16, 2> AddAndClampToS16(const std::array<s16, 2>& a,
+                                           const std::array<s16, 2>& b) {
+    return {ClampToS16(static_cast<s32>(a[0]) + static_cast<s32>(b[0])),
+            ClampToS16(static_cast<s32>(a[1]) + static_cast<s32>(b[1]))};
+}
+
+static void ReferenceGainMix(const StereoFrame16& samples, const std::array<float, 4>& gains,
+                             QuadFrame32& dest) {
+    for (size_t i = 0; i < samples_per_frame; i++) {
+        dest[i][0] += static_cast<s32>(gains[0] * samples[i][0]);
+        dest[i][1] += static_cast<s32>(gains[1] * samples[i][1]);
+        dest[i][2] += static_cast<s32>(gains[2] * samples[i][0]);
+        dest[i][3] += static_cast<s32>(gains[3] * samples[i][1]);
+    }
+}
+
+static void ReferenceDownmixStereo(float gain, const QuadFrame32& samples,
+                                   StereoFrame16& accumulator) {
+    for (size_t i = 0; i < samples_per_frame; i++) {
+        const auto& sample = samples[i];
+        s16 left = ClampToS16(static_cast<s32>(gain * sample[0] + gain * sample[2]));
+        s16 right = ClampToS16(static_cast<s32>(gain * sample[1] + gain * sample[3]));
+        accumulator[i] = AddAndClampToS16(accumulator[i], {left, right});
+    }
+}
+
+static void ReferenceDownmixMono(float gain, const QuadFrame32& samples,
+                                 StereoFrame16& accumulator) {
+    for (size_t i = 0; i < samples_per_frame; i++) {
+        const auto& sample = samples[i];
+        s16 mono = ClampToS16(static_cast<s32>(
+            (gain * sample[0] + gain * sample[1] + gain * sample[2] + gain * sample[3]) / 2));
+        accumulator[i] = AddAndClampToS16(accumulator[i], {mono, mono});
+    }
+}
+
+static StereoFrame16 RandomStereoFrame(std::mt19937& rng) {
+    std::uniform_int_distribution<int> dist(-32768, 32767);
+    StereoFrame16 frame;
+    for (auto& sample : frame) {
+        sample = {static_cast<s16>(dist(rng)), static_cast<s16>(dist(rng))};
+    }
+    return frame;
+}
+
+/// Mixes of up to 24 sources, so the values exceed the 16-bit range
+static QuadFrame32 RandomQuadFrame(std::mt19937& rng) {
+    std::uniform_int_distribution<s32> dist(-32768 * 24, 32767 * 24);
+    QuadFrame32 frame;
+    for (auto& sample : frame) {
+        sample = {dist(rng), dist(rng), dist(rng), dist(rng)};
+    }
+    return frame;
+}
+
+TEST_CASE("Mix kernels match per-sample mixing", "[audio_core][hle]") {
+    std::mt19937 rng(1234);
+    std::uniform_real_distribution<float> gain_dist(0.0f, 2.0f);
+
+    for (int iteration = 0; iteration < 200; ++iteration) {
+        const std::array<float, 4> gains{
+            {gain_dist(rng), gain_dist(rng), gain_dist(rng), gain_dist(rng)}};
+        const StereoFrame16 stereo = RandomStereoFrame(rng);
+        const QuadFrame32 quad = RandomQuadFrame(rng);
+
+        QuadFrame32 expected_quad = RandomQuadFrame(rng);
+        QuadFrame32 actual_quad = expected_quad;
+        ReferenceGainMix(stereo, gains, expected_quad);
+        Kernels::GainMix(stereo, gains, actual_quad);
+        REQUIRE(expected_quad == actual_quad);
+
+        StereoFrame16 expected_stereo = RandomStereoFrame(rng);
+        StereoFrame16 actual_stereo = expected_stereo;
+        ReferenceDownmixStereo(gains[0], quad, expected_stereo);
+        Kernels::DownmixStereoAndMix(gains[0], quad, actual_stereo);
+        REQUIRE(expected_stereo == actual_stereo);
+
+        ReferenceDownmixMono(gains[1], quad, expected_stereo);
+        Kernels::DownmixMonoAndMix(gains[1], quad, actual_stereo);
+        REQUIRE(expected_stereo == actual_stereo);
+    }
+}
+
+TEST_CASE("Mix kernels convert between sample and channel order", "[audio_core][hle]") {
+    std::mt19937 rng(5678);
+    const QuadFrame32 quad = RandomQuadFrame(rng);
+
+    s32_le pcm32[4][samples_per_frame];
+    Kernels::Deinterleave(quad, pcm32);
+
+    bool matches = true;
+    for (size_t sample = 0; sample < samples_per_frame; sample++) {
+        for (size_t channel = 0; channel < 4; channel++) {
+            matches = matches && pcm32[channel][sample] == quad[sample][channel];
+        }
+    }
+    REQUIRE(matches);
+
+    QuadFrame32 round_trip;
+    Kernels::Interleave(pcm32, round_trip);
+    REQUIRE(round_trip == quad);
+}
+
+} // namespace HLE
+} // namespace DSP
@@ -0,0 +1,168 @@
+// Copyright 2017 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <catch.hpp>
+#include "audio_core/interpolate.h"
+#include "common/math_util.h"
+
+namespace AudioInterp {
+
+/// The scalar linear interpolation that was used before the vectorized one
+static StereoBuffer16 ReferenceLinear(State& state, const StereoBuffer16& input,
+                                      float rate_multiplier) {
+    constexpr u64 scale_factor = 1 << 24;
+    constexpr u64 scale_mask = scale_factor - 1;
+
+    if (input.size() < 2)
+        return {};
+
+    auto lerp = [](u64 fraction, const std::array<s16, 2>& x0, const std::array<s16, 2>& x1) {
+        s64 delta0 = MathUtil::Clamp<s64>(x1[0] - x0[0], -32768, 32767);
+        s64 delta1 = MathUtil::Clamp<s64>(x1[1] - x0[1], -32768, 32767);
+        return std::array<s16, 2>{
+            static_cast<s16>(x0[0] + fraction * delta0 / scale_factor),
+            static_cast<s16>(x0[1] + fraction * delta1 / scale_factor),
+        };
+    };
+
+    StereoBuffer16 output;
+    const u64 step_size = static_cast<u64>(rate_multiplier * scale_factor);
+    const u64 max_fposition = input.size() * scale_factor;
+    for (u64 fposition = 0; fposition < max_fposition; fposition += step_size) {
+        const u64 fraction = fposition & scale_mask;
+        const size_t index = static_cast<size_t>(fposition / scale_factor);
+        const auto& x0 = index == 0 ? state.xn2 : index == 1 ? state.xn1 : input[index - 2];
+        const auto& x1 = index == 0 ? state.xn1 : input[index - 1];
+        output.push_back(lerp(fraction, x0, x1));
+    }
+
+    state.xn2 = input[input.size() - 2];
+    state.xn1 = input[input.size() - 1];
+    return output;
+}
+
+TEST_CASE("Linear interpolation matches scalar stepping", "[audio_core]") {
+    std::mt19937 rng(1234);
+    std::uniform_int_distribution<int> sample_dist(-32768, 32767);
+    std::uniform_int_distribution<size_t> size_dist(0, 300);
+    std::uniform_real_distribution<float> rate_dist(0.05f, 4.0f);
+
+    State expected_state;
+    State actual_state;
+
+    for (int iteration = 0; iteration < 500; ++iteration) {
+        StereoBuffer16 input(size_dist(rng));
+        for (auto& sample : input) {
+            // Full-scale steps exercise the saturated subtraction
+            if (rng() % 8 == 0) {
+                sample = {-32768, 32767};
+            } else {
+                sample = {static_cast<s16>(sample_dist(rng)), static_cast<s16>(sample_dist(rng))};
+            }
+        }
+        const float rate = iteration % 10 == 0 ? 1.0f : rate_dist(rng);
+
+        const StereoBuffer16 expected = ReferenceLinear(expected_state, input, rate);
+        const StereoBuffer16 actual = Linear(actual_state, input, rate);
+        REQUIRE(expected == actual);
+        REQUIRE(expected_state.xn1 == actual_state.xn1);
+        REQUIRE(expected_state.xn2 == actual_state.xn2);
+    }
+}
+
+/// Root mean square of the left channel, skipping the samples affected by the filter's startup
+static double LeftRms(const StereoBuffer16& samples) {
+    double sum = 0.0;
+    for (size_t i = polyphase_taps; i < samples.size(); ++i)
+        sum += static_cast<double>(samples[i][0]) * samples[i][0];
+    return std::sqrt(sum / (samples.size() - polyphase_taps));
+}
+
+/// A stereo tone at a frequency relative to the Nyquist frequency
+static StereoBuffer16 MakeTone(size_t size, double frequency, double amplitude) {
+    StereoBuffer16 tone(size);
+    for (size_t i = 0; i < size; ++i) {
+        const s16 value = static_cast<s16>(amplitude * std::sin(3.14159265358979 * frequency * i));
+        tone[i] = {value, static_cast<s16>(-value)};
+    }
+    return tone;
+}
+
+TEST_CASE("Polyphase interpolation passes samples through at the native rate", "[audio_core]") {
+    std::mt19937 rng(5678);
+    std::uniform_int_distribution<int> sample_dist(-32768, 32767);
+
+    StereoBuffer16 input(500);
+    for (auto& sample : input)
+        sample = {static_cast<s16>(sample_dist(rng)), static_cast<s16>(sample_dist(rng))};
+
+    State state;
+    const StereoBuffer16 output = Polyphase(state, input, 1.0f);
+
+    // Delayed by the two-sample predelay and half the filter
+    constexpr size_t delay = 2 + polyphase_taps / 2 - 1;
+    REQUIRE(output.size() == input.size());
+    for (size_t i = delay; i < output.size(); ++i)
+        REQUIRE(output[i] == input[i - delay]);
+    REQUIRE(state.xn1 == input[input.size() - 1]);
+    REQUIRE(state.xn2 == input[input.size() - 2]);
+}
+
+TEST_CASE("Polyphase interpolation is continuous across buffers", "[audio_core]") {
+    const StereoBuffer16 input = MakeTone(1000, 0.3, 20000.0);
+
+    State whole_state;
+    const StereoBuffer16 expected = Polyphase(whole_state, input, 0.5f);
+
+    State split_state;
+    StereoBuffer16 actual;
+    for (size_t begin = 0; begin < input.size(); begin += 125) {
+        const StereoBuffer16 part(input.begin() + begin, input.begin() + begin + 125);
+        const StereoBuffer16 output = Polyphase(split_state, part, 0.5f);
+        actual.insert(actual.end(), output.begin(), output.end());
+    }
+
+    REQUIRE(expected == actual);
+    REQUIRE(whole_state.xn_earlier == split_state.xn_earlier);
+}
+
+TEST_CASE("Polyphase decimation suppresses aliasing", "[audio_core]") {
+    // Above the Nyquist frequency of the output, so any of it that remains is aliased
+    const StereoBuffer16 input = MakeTone(4000, 0.9, 16000.0);
+
+    State linear_state;
+    State polyphase_state;
+    const double linear = LeftRms(Linear(linear_state, input, 2.0f));
+    const double polyphase = LeftRms(Polyphase(polyphase_state, input, 2.0f));
+
+    REQUIRE(polyphase < linear / 10);
+}
+
+TEST_CASE("Interpolation benchmark", "[.][benchmark]") {
+    constexpr int ITERATIONS = 200;
+    const StereoBuffer16 input = MakeTone(32728, 0.25, 16000.0);
+
+    for (float rate : {0.5f, 1.0f, 1.5f, 3.0f}) {
+        using Interpolator = StereoBuffer16 (*)(State&, const StereoBuffer16&, float);
+        auto measure = [&](Interpolator interpolate) {
+            State state;
+            const auto start = std::chrono::steady_clock::now();
+            for (int i = 0; i < ITERATIONS; ++i)
+                interpolate(state, input, rate);
+            const auto duration = std::chrono::steady_clock::now() - start;
+            return std::chrono::duration<double, std::micro>(duration).count() / ITERATIONS;
+        };
+
+        const double linear = measure(Linear);
+        const double polyphase = measure(Polyphase);
+        std::printf("One second at rate %.1f: linear %.1f us, polyphase %.1f us\n", rate, linear,
+                    polyphase);
+    }
+}
+
+} // namespace AudioInterp
@@ -0,0 +1,71 @@
+// Copyright 2017 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <array>
+#include <thread>
+#include <vector>
+#include <catch.hpp>
+#include "audio_core/ring_buffer.h"
+#include "common/common_types.h"
+
+namespace AudioCore {
+
+TEST_CASE("RingBuffer: Basic", "[audio_core]") {
+    RingBuffer<s16, 4, 2> buf;
+    REQUIRE(buf.Size() == 0);
+
+    const std::array<s16, 6> input{{1, 2, 3, 4, 5, 6}};
+    REQUIRE(buf.Push(input.data(), 3) == 3);
+    REQUIRE(buf.Size() == 3);
+
+    // Only one slot is left
+    REQUIRE(buf.Push(input.data(), 3) == 1);
+    REQUIRE(buf.Size() == 4);
+
+    std::array<s16, 8> output{};
+    REQUIRE(buf.Pop(output.data(), 2) == 2);
+    REQUIRE(output == (std::array<s16, 8>{{1, 2, 3, 4, 0, 0, 0, 0}}));
+    REQUIRE(buf.Size() == 2);
+
+    // Wrap around the end of the storage
+    REQUIRE(buf.Push(input.data() + 2, 2) == 2);
+    output = {};
+    REQUIRE(buf.Pop(output.data(), 8) == 4);
+    REQUIRE(output == (std::array<s16, 8>{{5, 6, 1, 2, 3, 4, 5, 6}}));
+    REQUIRE(buf.Size() == 0);
+    REQUIRE(buf.Pop(output.data(), 1) == 0);
+}
+
+TEST_CASE("RingBuffer: Threaded", "[audio_core]") {
+    RingBuffer<u32, 64> buf;
+    constexpr u32 count = 100000;
+
+    std::thread producer([&buf] {
+        u32 next = 0;
+        while (next < count) {
+            const std::array<u32, 3> values{{next, next + 1, next + 2}};
+            next += static_cast<u32>(buf.Push(values.data(), std::min<u32>(3, count - next)));
+            std::this_thread::yield();
+        }
+    });
+
+    std::vector<u32> received;
+    received.reserve(count);
+    while (received.size() < count) {
+        std::array<u32, 5> values;
+        size_t popped = buf.Pop(values.data(), values.size());
+        received.insert(received.end(), values.begin(), values.begin() + popped);
+    }
+    producer.join();
+
+    bool in_order = true;
+    for (u32 i = 0; i < count; ++i) {
+        in_order = in_order && received[i] == i;
+    }
+    REQUIRE(in_order);
+    REQUIRE(buf.Size() == 0);
+}
+
+} // namespace AudioCore
@@ -0,0 +1,74 @@
+// Copyright 2017 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <array>
+#include <random>
+#include <vector>
+#include <catch.hpp>
+#include "common/common_types.h"
+#include "core/aes/aes.h"
+
+namespace AES {
+
+/// The block at a time decryption that was used before the bulk implementation
+static void ReferenceCtrDecrypt(u8* data, size_t length, const std::array<u8, 16>& key,
+                                const std::array<u8, 16>& ctr, u64 offset) {
+    for (size_t i = 0; i < length; ++i) {
+        std::array<u8, 16> c = ctr;
+        AddCtr(c, static_cast<u32>((offset + i) / 16));
+        data[i] ^= AesCipher(c, key)[(offset + i) % 16];
+    }
+}
+
+static std::vector<u8> RandomBytes(size_t size, std::mt19937& rng) {
+    std::uniform_int_distribution<int> distribution(0, 255);
+    std::vector<u8> bytes(size);
+    for (auto& byte : bytes)
+        byte = static_cast<u8>(distribution(rng));
+    return bytes;
+}
+
+TEST_CASE("AES: CTR test vector", "[core][aes]") {
+    // NIST SP 800-38A, F.5.1 CTR-AES128.Encrypt
+    const std::array<u8, 16> key{{0x2b, 0x7e, 0x15, 0x16, 0x28, 0xae, 0xd2, 0xa6, 0xab, 0xf7,
+                                  0x15, 0x88, 0x09, 0xcf, 0x4f, 0x3c}};
+    const std::array<u8, 16> ctr{{0xf0, 0xf1, 0xf2, 0xf3, 0xf4, 0xf5, 0xf6, 0xf7, 0xf8, 0xf9,
+                                  0xfa, 0xfb, 0xfc, 0xfd, 0xfe, 0xff}};
+    std::vector<u8> data{{0x6b, 0xc1, 0xbe, 0xe2, 0x2e, 0x40, 0x9f, 0x96, 0xe9, 0x3d, 0x7e,
+                          0x11, 0x73, 0x93, 0x17, 0x2a, 0xae, 0x2d, 0x8a, 0x57, 0x1e, 0x03,
+                          0xac, 0x9c, 0x9e, 0xb7, 0x6f, 0xac, 0x45, 0xaf, 0x8e, 0x51}};
+    const std::vector<u8> expected{{0x87, 0x4d, 0x61, 0x91, 0xb6, 0x20, 0xe3, 0x26, 0x1b, 0xef, 0x68,
+                                    0x64, 0x99, 0x0d, 0xb6, 0xce, 0x98, 0x06, 0xf6, 0x6b, 0x79, 0x70,
+                                    0xfd, 0xff, 0x86, 0x17, 0x18, 0x7b, 0xb9, 0xff, 0xfd, 0xff}};
+
+    AesCtrDecrypt(data.data(), data.size(), key, ctr);
+    REQUIRE(data == expected);
+}
+
+TEST_CASE("AES: CTR ranges match block at a time decryption", "[core][aes]") {
+    std::mt19937 rng(0x3D5);
+    std::array<u8, 16> key, ctr;
+    const auto key_bytes = RandomBytes(16, rng);
+    std::copy(key_bytes.begin(), key_bytes.end(), key.begin());
+
+    SECTION("random counter") {
+        const auto ctr_bytes = RandomBytes(16, rng);
+        std::copy(ctr_bytes.begin(), ctr_bytes.end(), ctr.begin());
+    }
+    SECTION("counter carrying between halves") {
+        ctr = {{0, 0, 0, 0, 0, 0, 0, 0, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xfa}};
+    }
+
+    for (u64 offset : {0, 1, 15, 16, 100}) {
+        for (size_t length : {0, 1, 15, 16, 17, 127, 128, 129, 1000}) {
+            auto data = RandomBytes(length, rng);
+            auto expected = data;
+            ReferenceCtrDecrypt(expected.data(), length, key, ctr, offset);
+            AesCtrDecrypt(data.data(), length, key, ctr, offset);
+            REQUIRE(data == expected);
+        }
+    }
+}
+
+} // namespace AES
@@ -0,0 +1,61 @@
+// Copyright 2017 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <vector>
+#include <catch.hpp>
+#include "common/file_util.h"
+#include "core/file_sys/archive_extsavedata.h"
+#include "core/file_sys/file_backend.h"
+#include "core/hle/result.h"
+#include "core/memory.h"
+
+namespace FileSys {
+
+TEST_CASE("ExtSaveData: Gathered writes can't grow files", "[core][file_sys]") {
+    const std::string mount_location = "extsavedata_test/";
+    const Path archive_path = ConstructExtDataBinaryPath(1, 0x00048000, 0x00001234);
+    const Path file_path("/file.bin");
+    constexpr u64 file_size = 0x100;
+
+    ArchiveFactory_ExtSaveData factory(mount_location, false);
+    REQUIRE(factory.Initialize());
+    REQUIRE(factory.Format(archive_path, ArchiveFormatInfo{}).IsSuccess());
+    auto archive = factory.Open(archive_path).MoveFrom();
+    REQUIRE(archive->CreateFile(file_path, file_size).IsSuccess());
+
+    Mode mode{};
+    mode.read_flag.Assign(1);
+    mode.write_flag.Assign(1);
+    auto file = archive->OpenFile(file_path, mode).MoveFrom();
+
+    std::vector<u8> first(0x80, 0xAA), second(0x100, 0xBB);
+    const std::vector<Memory::HostSpan> spans{{first.data(), first.size()},
+                                              {second.data(), second.size()}};
+
+    // Only the part within the file is written
+    REQUIRE(file->WriteGather(0x40, true, spans).MoveFrom() == 0xC0);
+    REQUIRE(file->GetSize() == file_size);
+
+    std::vector<u8> contents(file_size);
+    REQUIRE(file->Read(0, contents.size(), contents.data()).MoveFrom() == file_size);
+    REQUIRE(std::all_of(contents.begin(), contents.begin() + 0x40, [](u8 b) { return b == 0; }));
+    REQUIRE(std::all_of(contents.begin() + 0x40, contents.begin() + 0xC0,
+                        [](u8 b) { return b == 0xAA; }));
+    REQUIRE(std::all_of(contents.begin() + 0xC0, contents.end(), [](u8 b) { return b == 0xBB; }));
+
+    REQUIRE(file->WriteGather(file_size, true, spans).MoveFrom() == 0);
+
+    const ResultVal<size_t> beyond_end = file->WriteGather(file_size + 1, true, spans);
+    REQUIRE(beyond_end.Failed());
+    REQUIRE(beyond_end.Code().description == ErrorDescription::FS_WriteBeyondEnd);
+    REQUIRE(file->GetSize() == file_size);
+
+    file->Close();
+    file.reset();
+    archive.reset();
+    FileUtil::DeleteDirRecursively(mount_location);
+}
+
+} // namespace FileSys
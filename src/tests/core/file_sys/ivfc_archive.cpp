@@ -0,0 +1,81 @@
+// Copyright 2017 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <memory>
+#include <vector>
+#include <catch.hpp>
+#include "common/file_util.h"
+#include "core/aes/aes.h"
+#include "core/file_sys/ivfc_archive.h"
+
+namespace FileSys {
+
+TEST_CASE("IVFCFile: Reads from a mapped file", "[core][file_sys]") {
+    const std::string filename = "ivfc_archive_test.bin";
+    constexpr u64 data_offset = 0x1000;
+    constexpr u64 data_size = 0x3000;
+
+    std::vector<u8> plaintext(data_size);
+    for (size_t i = 0; i < plaintext.size(); ++i)
+        plaintext[i] = static_cast<u8>(i * 7 + i / 256);
+
+    AES::AesContext aes_context;
+    std::vector<u8> contents(data_offset + data_size + 0x100, 0xEE);
+    std::copy(plaintext.begin(), plaintext.end(), contents.begin() + data_offset);
+
+    SECTION("encrypted") {
+        aes_context = AES::AesContext({{1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16}},
+                                      {{0xFF, 0xFF, 0xFF, 0xFF, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0}});
+        AES::AesCtrDecrypt(&contents[data_offset], data_size, aes_context.key, aes_context.ctr);
+    }
+    SECTION("unencrypted") {}
+
+    {
+        FileUtil::IOFile file(filename, "wb");
+        REQUIRE(file.WriteBytes(contents.data(), contents.size()) == contents.size());
+    }
+
+    {
+        auto file = std::make_shared<FileUtil::IOFile>(filename, "rb");
+        REQUIRE(FileUtil::MappedFile(*file).IsOpen());
+
+        IVFCArchive archive(file, data_offset, data_size, aes_context);
+        auto romfs = archive.OpenFile(Path(""), Mode{}).MoveFrom();
+        // The file can be closed by its owner while the archive is still in use
+        file->Close();
+
+        for (u64 offset : {0x0, 0x1, 0x7FF, 0x2FF0}) {
+            std::vector<u8> buffer(0x20, 0);
+            const size_t expected_length = std::min<size_t>(buffer.size(), data_size - offset);
+            REQUIRE(romfs->Read(offset, buffer.size(), buffer.data()).MoveFrom() ==
+                    expected_length);
+            REQUIRE(std::equal(buffer.begin(), buffer.begin() + expected_length,
+                               plaintext.begin() + offset));
+        }
+
+        // Scattered over several buffers, the last one only partially filled
+        std::vector<u8> first(0x30), second(0x100);
+        const std::vector<Memory::HostSpan> spans{{first.data(), first.size()},
+                                                  {second.data(), second.size()}};
+        REQUIRE(romfs->ReadScatter(data_size - 0x40, spans).MoveFrom() == 0x40);
+        REQUIRE(std::equal(first.begin(), first.end(), plaintext.end() - 0x40));
+        REQUIRE(std::equal(second.begin(), second.begin() + 0x10, plaintext.end() - 0x10));
+
+        u8 byte;
+        REQUIRE(romfs->Read(data_size, 1, &byte).MoveFrom() == 0);
+        REQUIRE(romfs->Read(data_size + 1, 1, &byte).MoveFrom() == 0);
+    }
+
+    FileUtil::Delete(filename);
+}
+
+TEST_CASE("MappedFile: Empty files can't be mapped", "[core][file_sys]") {
+    const std::string filename = "mapped_file_test.bin";
+    FileUtil::IOFile file(filename, "wb+");
+    REQUIRE(!FileUtil::MappedFile(file).IsOpen());
+    file.Close();
+    FileUtil::Delete(filename);
+}
+
+} // namespace FileSys
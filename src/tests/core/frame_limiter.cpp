@@ -0,0 +1,48 @@
+// Copyright 2017 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <chrono>
+#include <catch.hpp>
+#include "core/frame_limiter.h"
+
+namespace Core {
+
+using Clock = FrameLimiter::Clock;
+using std::chrono::milliseconds;
+
+/// Runs a number of empty frames and returns how long they took
+static Clock::duration RunFrames(FrameLimiter& limiter, int frames, u32 speed_percent) {
+    const Clock::time_point start = Clock::now();
+    limiter.Reset();
+    for (int i = 0; i < frames; ++i) {
+        limiter.DoFrameLimiting(speed_percent, 1.0);
+    }
+    return Clock::now() - start;
+}
+
+TEST_CASE("FrameLimiter paces frames at the speed limit", "[core][frame_limiter]") {
+    FrameLimiter limiter;
+    const int frames = 6;
+
+    SECTION("native speed") {
+        // 6 frames at 60 fps
+        const Clock::duration elapsed = RunFrames(limiter, frames, 100);
+        REQUIRE(elapsed >= milliseconds(99));
+        REQUIRE(elapsed < milliseconds(1000));
+    }
+
+    SECTION("below native speed") {
+        // 6 frames at 30 fps, each waiting longer than the maximum lag
+        const Clock::duration elapsed = RunFrames(limiter, frames, 50);
+        REQUIRE(elapsed >= milliseconds(199));
+        REQUIRE(elapsed < milliseconds(2000));
+    }
+
+    SECTION("unlimited") {
+        const Clock::duration elapsed = RunFrames(limiter, frames, 0);
+        REQUIRE(elapsed < milliseconds(50));
+    }
+}
+
+} // namespace Core
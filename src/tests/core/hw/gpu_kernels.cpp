@@ -0,0 +1,281 @@
+// Copyright 2017 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <cstring>
+#include <random>
+#include <vector>
+#include <catch.hpp>
+#include "common/color.h"
+#include "common/common_types.h"
+#include "common/vector_math.h"
+#include "core/hw/gpu.h"
+#include "core/hw/gpu_kernels.h"
+#include "video_core/utils.h"
+
+namespace GPU {
+
+/// The per-element fill loops that were used before the fill kernels
+static void ReferenceMemoryFill(const Regs::MemoryFillConfig& config, u8* start, u8* end) {
+    if (config.fill_24bit) {
+        for (u8* ptr = start; ptr < end; ptr += 3) {
+            ptr[0] = config.value_24bit_r;
+            ptr[1] = config.value_24bit_g;
+            ptr[2] = config.value_24bit_b;
+        }
+    } else if (config.fill_32bit) {
+        u32 value = config.value_32bit;
+        size_t len = (end - start) / sizeof(u32);
+        for (size_t i = 0; i < len; ++i)
+            std::memcpy(&start[i * sizeof(u32)], &value, sizeof(u32));
+    } else {
+        u16 value_16bit = config.value_16bit.Value();
+        for (u8* ptr = start; ptr < end; ptr += sizeof(u16))
+            std::memcpy(ptr, &value_16bit, sizeof(u16));
+    }
+}
+
+static Regs::MemoryFillConfig MakeFillConfig(unsigned element_size, u32 value) {
+    Regs::MemoryFillConfig config{};
+    config.value_32bit = value;
+    config.fill_24bit.Assign(element_size == 3);
+    config.fill_32bit.Assign(element_size == 4);
+    return config;
+}
+
+TEST_CASE("MemoryFill matches per-element fill", "[core][hw][gpu]") {
+    std::mt19937 rng(1234);
+    // Leave some slack at the end for fills writing past their end pointer
+    constexpr size_t BUFFER_SIZE = 4096 + 64;
+
+    for (unsigned element_size : {2, 3, 4}) {
+        for (u32 value : {0x00000000u, 0xFFFFFFFFu, 0x12345678u, 0x00FF00FFu, 0xA5A5A5A5u}) {
+            const auto config = MakeFillConfig(element_size, value);
+
+            for (int iteration = 0; iteration < 64; ++iteration) {
+                const size_t offset = rng() % 32;
+                const size_t size = rng() % 4000 + 1;
+
+                std::vector<u8> expected(BUFFER_SIZE, 0xCD);
+                std::vector<u8> actual(BUFFER_SIZE, 0xCD);
+                ReferenceMemoryFill(config, &expected[offset], &expected[offset + size]);
+                Kernels::MemoryFill(config, &actual[offset], &actual[offset + size]);
+
+                INFO("element size " << element_size << ", value " << value << ", offset "
+                                     << offset << ", size " << size);
+                REQUIRE(actual == expected);
+            }
+        }
+    }
+}
+
+static Math::Vec4<u8> ReferenceDecodePixel(Regs::PixelFormat format, const u8* pixel) {
+    switch (format) {
+    case Regs::PixelFormat::RGBA8:
+        return Color::DecodeRGBA8(pixel);
+    case Regs::PixelFormat::RGB8:
+        return Color::DecodeRGB8(pixel);
+    case Regs::PixelFormat::RGB565:
+        return Color::DecodeRGB565(pixel);
+    case Regs::PixelFormat::RGB5A1:
+        return Color::DecodeRGB5A1(pixel);
+    default:
+        return Color::DecodeRGBA4(pixel);
+    }
+}
+
+static void ReferenceEncodePixel(Regs::PixelFormat format, const Math::Vec4<u8>& color,
+                                 u8* pixel) {
+    switch (format) {
+    case Regs::PixelFormat::RGBA8:
+        Color::EncodeRGBA8(color, pixel);
+        break;
+    case Regs::PixelFormat::RGB8:
+        Color::EncodeRGB8(color, pixel);
+        break;
+    case Regs::PixelFormat::RGB565:
+        Color::EncodeRGB565(color, pixel);
+        break;
+    case Regs::PixelFormat::RGB5A1:
+        Color::EncodeRGB5A1(color, pixel);
+        break;
+    default:
+        Color::EncodeRGBA4(color, pixel);
+        break;
+    }
+}
+
+/// The per-pixel display transfer loop that the kernels replace
+static void ReferenceDisplayTransfer(const Regs::DisplayTransferConfig& config, const u8* src,
+                                     u8* dst) {
+    const u32 horizontal_scale = config.scaling != config.NoScale ? 1 : 0;
+    const u32 vertical_scale = config.scaling == config.ScaleXY ? 1 : 0;
+    const u32 output_width = config.output_width >> horizontal_scale;
+    const u32 output_height = config.output_height >> vertical_scale;
+    const u32 src_bpp = Regs::BytesPerPixel(config.input_format);
+    const u32 dst_bpp = Regs::BytesPerPixel(config.output_format);
+
+    for (u32 y = 0; y < output_height; ++y) {
+        for (u32 x = 0; x < output_width; ++x) {
+            const u32 input_x = x << horizontal_scale;
+            const u32 input_y = y << vertical_scale;
+            const u32 output_y = config.flip_vertically ? output_height - y - 1 : y;
+
+            u32 src_offset;
+            u32 dst_offset;
+            if (config.input_linear) {
+                src_offset = (input_x + input_y * config.input_width) * src_bpp;
+                if (!config.dont_swizzle) {
+                    dst_offset = VideoCore::GetMortonOffset(x, output_y, dst_bpp) +
+                                 (output_y & ~7) * output_width * dst_bpp;
+                } else {
+                    dst_offset = (x + output_y * output_width) * dst_bpp;
+                }
+            } else {
+                src_offset = VideoCore::GetMortonOffset(input_x, input_y, src_bpp) +
+                             (input_y & ~7) * config.input_width * src_bpp;
+                if (!config.dont_swizzle) {
+                    dst_offset = (x + output_y * output_width) * dst_bpp;
+                } else {
+                    dst_offset = VideoCore::GetMortonOffset(x, output_y, dst_bpp) +
+                                 (output_y & ~7) * output_width * dst_bpp;
+                }
+            }
+
+            const u8* src_pixel = src + src_offset;
+            Math::Vec4<u8> color = ReferenceDecodePixel(config.input_format, src_pixel);
+            if (config.scaling == config.ScaleX) {
+                const auto pixel = ReferenceDecodePixel(config.input_format, src_pixel + src_bpp);
+                color = ((color + pixel) / 2).Cast<u8>();
+            } else if (config.scaling == config.ScaleXY) {
+                const auto pixel1 = ReferenceDecodePixel(config.input_format, src_pixel + src_bpp);
+                const auto pixel2 =
+                    ReferenceDecodePixel(config.input_format, src_pixel + 2 * src_bpp);
+                const auto pixel3 =
+                    ReferenceDecodePixel(config.input_format, src_pixel + 3 * src_bpp);
+                color = (((color + pixel1) + (pixel2 + pixel3)) / 4).Cast<u8>();
+            }
+            ReferenceEncodePixel(config.output_format, color, dst + dst_offset);
+        }
+    }
+}
+
+TEST_CASE("DisplayTransfer matches per-pixel transfer", "[core][hw][gpu]") {
+    using PixelFormat = Regs::PixelFormat;
+    using Config = Regs::DisplayTransferConfig;
+    std::mt19937 rng(5678);
+
+    const PixelFormat formats[] = {PixelFormat::RGBA8, PixelFormat::RGB8, PixelFormat::RGB565,
+                                   PixelFormat::RGB5A1, PixelFormat::RGBA4};
+    constexpr u32 WIDTH = 48;
+    constexpr u32 HEIGHT = 32;
+
+    std::vector<u8> input(WIDTH * HEIGHT * 4);
+    std::generate(input.begin(), input.end(), [&rng] { return static_cast<u8>(rng()); });
+
+    for (PixelFormat input_format : formats) {
+        for (PixelFormat output_format : formats) {
+            for (unsigned flags = 0; flags < 8; ++flags) {
+                for (Config::ScalingMode scaling : {Config::NoScale, Config::ScaleX,
+                                                    Config::ScaleXY}) {
+                    Config config{};
+                    config.input_width.Assign(WIDTH);
+                    config.input_height.Assign(HEIGHT);
+                    config.output_width.Assign(WIDTH);
+                    config.output_height.Assign(HEIGHT);
+                    config.input_format.Assign(input_format);
+                    config.output_format.Assign(output_format);
+                    config.flip_vertically.Assign(flags & 1);
+                    config.input_linear.Assign((flags >> 1) & 1);
+                    config.dont_swizzle.Assign((flags >> 2) & 1);
+                    config.scaling.Assign(scaling);
+                    // Scaling is only implemented for tiled input
+                    if (config.input_linear && scaling != Config::NoScale)
+                        continue;
+
+                    const size_t output_size =
+                        WIDTH * HEIGHT * Regs::BytesPerPixel(output_format);
+                    std::vector<u8> expected(output_size, 0xCD);
+                    std::vector<u8> actual(output_size, 0xCD);
+                    ReferenceDisplayTransfer(config, input.data(), expected.data());
+
+                    INFO("input format " << static_cast<int>(input_format) << ", output format "
+                                         << static_cast<int>(output_format) << ", flags "
+                                         << flags << ", scaling " << scaling);
+                    REQUIRE(Kernels::DisplayTransfer(config, input.data(), actual.data()));
+                    REQUIRE(actual == expected);
+                }
+            }
+        }
+    }
+}
+
+TEST_CASE("DisplayTransfer leaves partial tiles to the generic path", "[core][hw][gpu]") {
+    Regs::DisplayTransferConfig config{};
+    config.input_width.Assign(12);
+    config.input_height.Assign(8);
+    config.output_width.Assign(12);
+    config.output_height.Assign(8);
+    config.input_format.Assign(Regs::PixelFormat::RGBA8);
+    config.output_format.Assign(Regs::PixelFormat::RGBA8);
+
+    const std::vector<u8> input(12 * 8 * 4, 0x55);
+    std::vector<u8> output(12 * 8 * 4, 0xCD);
+    REQUIRE(!Kernels::DisplayTransfer(config, input.data(), output.data()));
+    REQUIRE(std::all_of(output.begin(), output.end(), [](u8 b) { return b == 0xCD; }));
+}
+
+/// The copy loop that the texture copy kernel replaces
+static void ReferenceTextureCopy(const u8* src, u8* dst, u32 size, u32 input_width,
+                                 u32 input_gap, u32 output_width, u32 output_gap) {
+    u32 remaining_input = input_width;
+    u32 remaining_output = output_width;
+    while (size > 0) {
+        const u32 copy_size = std::min({remaining_input, remaining_output, size});
+        std::memcpy(dst, src, copy_size);
+        src += copy_size;
+        dst += copy_size;
+        remaining_input -= copy_size;
+        remaining_output -= copy_size;
+        size -= copy_size;
+        if (remaining_input == 0) {
+            remaining_input = input_width;
+            src += input_gap;
+        }
+        if (remaining_output == 0) {
+            remaining_output = output_width;
+            dst += output_gap;
+        }
+    }
+}
+
+TEST_CASE("TextureCopy matches per-line copy", "[core][hw][gpu]") {
+    std::mt19937 rng(91011);
+    constexpr size_t BUFFER_SIZE = 16384;
+
+    std::vector<u8> input(BUFFER_SIZE);
+    std::generate(input.begin(), input.end(), [&rng] { return static_cast<u8>(rng()); });
+
+    for (int iteration = 0; iteration < 256; ++iteration) {
+        // Cover copies without gaps and with matching line widths too
+        const u32 input_width = (rng() % 16 + 1) * 16;
+        const u32 output_width = iteration % 4 == 0 ? input_width : (rng() % 16 + 1) * 16;
+        const u32 input_gap = iteration % 8 == 1 ? 0 : rng() % 4 * 16;
+        const u32 output_gap = iteration % 8 == 1 ? 0 : rng() % 4 * 16;
+        const u32 size = (rng() % 256 + 1) * 16;
+
+        std::vector<u8> expected(BUFFER_SIZE, 0xCD);
+        std::vector<u8> actual(BUFFER_SIZE, 0xCD);
+        ReferenceTextureCopy(input.data(), expected.data(), size, input_width, input_gap,
+                             output_width, output_gap);
+        Kernels::TextureCopy(input.data(), actual.data(), size, input_width, input_gap,
+                             output_width, output_gap);
+
+        INFO("size " << size << ", input " << input_width << "+" << input_gap << ", output "
+                     << output_width << "+" << output_gap);
+        REQUIRE(actual == expected);
+    }
+}
+
+} // namespace GPU
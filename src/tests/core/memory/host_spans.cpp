@@ -0,0 +1,38 @@
+// Copyright 2017 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <vector>
+#include <catch.hpp>
+#include "core/memory.h"
+#include "core/memory_setup.h"
+
+namespace Memory {
+
+TEST_CASE("GetHostSpans", "[core][memory]") {
+    const VAddr base = 0x10000000;
+    std::vector<u8> contiguous(3 * PAGE_SIZE);
+    std::vector<u8> separate(PAGE_SIZE);
+
+    // Two pages backed by one buffer, followed by a page from another buffer
+    MapMemoryRegion(base, 2 * PAGE_SIZE, contiguous.data());
+    MapMemoryRegion(base + 2 * PAGE_SIZE, PAGE_SIZE, separate.data());
+
+    std::vector<HostSpan> spans;
+    REQUIRE(GetHostSpans(base + 0x10, 2 * PAGE_SIZE, true, spans));
+    REQUIRE(spans.size() == 2);
+    REQUIRE(spans[0].pointer == contiguous.data() + 0x10);
+    REQUIRE(spans[0].size == 2 * PAGE_SIZE - 0x10);
+    REQUIRE(spans[1].pointer == separate.data());
+    REQUIRE(spans[1].size == 0x10);
+
+    REQUIRE(GetHostSpans(base + PAGE_SIZE, 0, false, spans));
+    REQUIRE(spans.empty());
+
+    // The region runs into an unmapped page
+    REQUIRE(!GetHostSpans(base + 2 * PAGE_SIZE, 2 * PAGE_SIZE, false, spans));
+
+    UnmapRegion(base, 3 * PAGE_SIZE);
+}
+
+} // namespace Memory
@@ -0,0 +1,539 @@
+// Copyright 2017 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <cstring>
+#include <memory>
+#include <ostream>
+#include <random>
+#include <vector>
+#include <catch.hpp>
+#include "core/memory.h"
+#include "core/memory_setup.h"
+#include "video_core/command_processor.h"
+#include "video_core/pica.h"
+#include "video_core/pica_state.h"
+#include "video_core/rasterizer_interface.h"
+#include "video_core/renderer_base.h"
+#include "video_core/video_core.h"
+
+namespace {
+
+/// Queues draws like the hardware rasterizer and records the state each queued draw is flushed
+/// with, which is the state at the time its batch is submitted.
+class BatchingRasterizer : public VideoCore::RasterizerInterface {
+public:
+    void AddTriangle(const Pica::Shader::OutputVertex& v0, const Pica::Shader::OutputVertex& v1,
+                     const Pica::Shader::OutputVertex& v2) override {}
+
+    void DrawTriangles() override {
+        draw_queued = true;
+    }
+
+    void FlushDrawBatch() override {
+        Flush();
+    }
+
+    void NotifyPicaRegisterWrite(u32 id, u32 value) override {
+        if (draw_queued && Pica::g_state.regs[id] != value)
+            Flush();
+    }
+
+    void NotifyPicaRegisterChanged(u32 id) override {}
+
+    void FlushAll() override {
+        Flush();
+    }
+
+    void FlushRegion(PAddr addr, u32 size) override {
+        Flush();
+    }
+
+    void FlushAndInvalidateRegion(PAddr addr, u32 size) override {
+        Flush();
+    }
+
+    std::vector<u32> flushed_texture_addresses;
+
+private:
+    void Flush() {
+        if (!draw_queued)
+            return;
+        flushed_texture_addresses.push_back(Pica::g_state.regs.texture0.address);
+        draw_queued = false;
+    }
+
+    bool draw_queued = false;
+};
+
+/// Records every notification in the order the rasterizer receives them
+class RecordingRasterizer : public VideoCore::RasterizerInterface {
+public:
+    struct Notification {
+        enum class Type { RegisterWrite, RegisterChanged, DrawTriangles, FlushDrawBatch };
+
+        Type type;
+        u32 id;
+        u32 value;
+
+        bool operator==(const Notification& other) const {
+            return type == other.type && id == other.id && value == other.value;
+        }
+
+        friend std::ostream& operator<<(std::ostream& os, const Notification& notification) {
+            return os << static_cast<int>(notification.type) << ":" << std::hex << notification.id
+                      << "=" << notification.value << std::dec;
+        }
+    };
+
+    void AddTriangle(const Pica::Shader::OutputVertex& v0, const Pica::Shader::OutputVertex& v1,
+                     const Pica::Shader::OutputVertex& v2) override {}
+
+    void DrawTriangles() override {
+        notifications.push_back({Notification::Type::DrawTriangles, 0, 0});
+    }
+
+    void FlushDrawBatch() override {
+        notifications.push_back({Notification::Type::FlushDrawBatch, 0, 0});
+    }
+
+    void NotifyPicaRegisterWrite(u32 id, u32 value) override {
+        notifications.push_back({Notification::Type::RegisterWrite, id, value});
+    }
+
+    void NotifyPicaRegisterChanged(u32 id) override {
+        notifications.push_back({Notification::Type::RegisterChanged, id, 0});
+    }
+
+    void FlushAll() override {}
+    void FlushRegion(PAddr addr, u32 size) override {}
+    void FlushAndInvalidateRegion(PAddr addr, u32 size) override {}
+
+    std::vector<Notification> notifications;
+};
+
+class TestRenderer : public RendererBase {
+public:
+    explicit TestRenderer(std::unique_ptr<VideoCore::RasterizerInterface> test_rasterizer) {
+        rasterizer = std::move(test_rasterizer);
+    }
+
+    void SwapBuffers() override {}
+    void SetWindow(EmuWindow* window) override {}
+    bool Init() override {
+        return true;
+    }
+    void ShutDown() override {}
+};
+
+/// Appends a write of a single register with all bytes enabled
+void AppendWrite(std::vector<u32>& list, u32 id, u32 value) {
+    list.push_back(value);
+    list.push_back(id | (0xF << 16));
+}
+
+/**
+ * Appends a command header writing several values, padded to the 8-byte alignment of headers.
+ * @param group Whether the values go to consecutive registers starting at `id`, rather than all
+ *              to `id`
+ */
+void AppendWrites(std::vector<u32>& list, u32 id, u32 mask, bool group,
+                  const std::vector<u32>& values) {
+    Pica::CommandProcessor::CommandHeader header;
+    header.hex = 0;
+    header.cmd_id.Assign(id);
+    header.parameter_mask.Assign(mask);
+    header.extra_data_length.Assign(static_cast<u32>(values.size() - 1));
+    header.group_commands.Assign(group ? 1 : 0);
+
+    list.push_back(values[0]);
+    list.push_back(header.hex);
+    list.insert(list.end(), values.begin() + 1, values.end());
+    if (list.size() % 2 != 0)
+        list.push_back(0);
+}
+
+template <typename T>
+std::vector<u8> GetBytes(const T& object) {
+    const u8* bytes = reinterpret_cast<const u8*>(&object);
+    return std::vector<u8>(bytes, bytes + sizeof(T));
+}
+
+/// The parts of the PICA state command lists write to
+struct PicaSnapshot {
+    std::vector<u8> regs;
+    std::vector<u8> uniforms;
+    std::vector<u8> lighting_luts;
+    std::vector<u8> fog_lut;
+    u32 lighting_dirty_begin;
+    u32 lighting_dirty_end;
+    u32 fog_dirty_begin;
+    u32 fog_dirty_end;
+    std::vector<RecordingRasterizer::Notification> notifications;
+};
+
+/**
+ * Runs a command list test with VRAM mapped and a rasterizer recording its notifications. Each
+ * list is copied to VRAM and processed from a cleared state.
+ */
+class CommandListRunner {
+public:
+    CommandListRunner() : vram(VRAM_SIZE) {
+        Memory::MapMemoryRegion(Memory::VRAM_VADDR, VRAM_SIZE, vram.data());
+
+        auto recording_rasterizer = std::make_unique<RecordingRasterizer>();
+        rasterizer = recording_rasterizer.get();
+        VideoCore::g_renderer = std::make_unique<TestRenderer>(std::move(recording_rasterizer));
+        Pica::CommandProcessor::ClearCommandListCache();
+    }
+
+    ~CommandListRunner() {
+        Pica::CommandProcessor::ClearCommandListCache();
+        VideoCore::g_renderer.reset();
+        Memory::UnmapRegion(Memory::VRAM_VADDR, VRAM_SIZE);
+    }
+
+    /// Processes the list stored at `offset` in VRAM and returns the state it left
+    PicaSnapshot Run(u32 offset, const std::vector<u32>& list) {
+        const u32 size = static_cast<u32>(list.size() * sizeof(u32));
+        REQUIRE(offset + size <= vram.size());
+        std::memcpy(vram.data() + offset, list.data(), size);
+
+        auto& state = Pica::g_state;
+        state.Reset();
+        // Draws read their vertices from here, the lists' draws have none
+        state.regs.vertex_attributes.base_address.Assign(Memory::VRAM_PADDR >> 3);
+        for (auto& lut : state.lighting.luts)
+            for (auto& entry : lut)
+                entry.raw = 0;
+        for (auto& entry : state.fog.lut)
+            entry.raw = 0;
+        state.lighting.dirty.Reset();
+        state.fog.dirty.Reset();
+        rasterizer->notifications.clear();
+
+        Pica::CommandProcessor::ProcessCommandList(Memory::VRAM_PADDR + offset, size);
+
+        return {GetBytes(state.regs),
+                GetBytes(state.vs.uniforms),
+                GetBytes(state.lighting.luts),
+                GetBytes(state.fog.lut),
+                state.lighting.dirty.begin,
+                state.lighting.dirty.end,
+                state.fog.dirty.begin,
+                state.fog.dirty.end,
+                rasterizer->notifications};
+    }
+
+private:
+    static constexpr u32 VRAM_SIZE = 0x10000;
+
+    std::vector<u8> vram;
+    RecordingRasterizer* rasterizer;
+};
+
+void RequireSameState(const PicaSnapshot& result, const PicaSnapshot& expected) {
+    REQUIRE(result.regs == expected.regs);
+    REQUIRE(result.uniforms == expected.uniforms);
+    REQUIRE(result.lighting_luts == expected.lighting_luts);
+    REQUIRE(result.fog_lut == expected.fog_lut);
+    REQUIRE(result.lighting_dirty_begin == expected.lighting_dirty_begin);
+    REQUIRE(result.lighting_dirty_end == expected.lighting_dirty_end);
+    REQUIRE(result.fog_dirty_begin == expected.fog_dirty_begin);
+    REQUIRE(result.fog_dirty_end == expected.fog_dirty_end);
+}
+
+/**
+ * Builds a command list covering the kinds of writes the command list cache handles differently:
+ * masked writes, runs of consecutive registers, repeated writes to one register, data port
+ * uploads and draws. `seed` varies the written values.
+ */
+std::vector<u32> BuildStateList(u32 seed, bool with_luts) {
+    std::vector<u32> list;
+    const u32 border_color = PICA_REG_INDEX(texture0.border_color);
+
+    AppendWrite(list, border_color, 0x11223344 + seed);
+    AppendWrites(list, border_color, 0x5, false, {0xAABBCCDD ^ seed});
+    AppendWrites(list, border_color, 0xF, false, {seed, seed * 3, 0x55667788});
+    AppendWrites(list, PICA_REG_INDEX(tev_stage0), 0xF, true,
+                 {0x0F0E0D0C + seed, 0x1000, 0x2000 + seed, 0x3, 0xFFFFFFFF});
+    AppendWrites(list, PICA_REG_INDEX(tev_stage1), 0x3, true, {0xDEADBEEF, 0x12345678 + seed});
+
+    AppendWrite(list, PICA_REG_INDEX(vs.bool_uniforms), 0xA5A5 ^ seed);
+    AppendWrites(list, PICA_REG_INDEX_WORKAROUND(vs.int_uniforms[0], 0x2b1), 0xF, true,
+                 {0x01020304, 0x05060708 + seed, 0x090A0B0C, 0x0D0E0F10});
+
+    // Two float24 vectors through one port register, then float32 vectors through consecutive
+    // port registers
+    const u32 uniform_setup = PICA_REG_INDEX(vs.uniform_setup);
+    const u32 set_value = PICA_REG_INDEX_WORKAROUND(vs.uniform_setup.set_value[0], 0x2c1);
+    AppendWrite(list, uniform_setup, 3);
+    AppendWrites(list, set_value, 0xF, false,
+                 {0x3F800000 + seed, 0x00123456, 0x789ABCDE, 0x40000000, 0x00000000, seed});
+    AppendWrite(list, uniform_setup, 10 | (1u << 31));
+    AppendWrites(list, set_value, 0xF, true,
+                 {0x3F800000, 0xBF800000, 0x7F800000 + seed, 0x00000001, 0x42280000, 0xC2280000,
+                  0x3F000000, seed});
+
+    // Masked data port writes go through the regular register path
+    AppendWrite(list, uniform_setup, 20);
+    AppendWrites(list, set_value, 0x3, false, {0x11111111, 0x22222222 + seed, 0x33333333});
+
+    if (with_luts) {
+        AppendWrite(list, PICA_REG_INDEX_WORKAROUND(lighting.lut_config, 0x1c5),
+                    (2 << 8) | 250);
+        AppendWrites(list, PICA_REG_INDEX_WORKAROUND(lighting.lut_data[0], 0x1c8), 0xF, true,
+                     {1, 2, 3, 4, 5, 6, 7 + seed, 8, 9, 10});
+        AppendWrite(list, PICA_REG_INDEX(fog_lut_offset), 120);
+        AppendWrites(list, PICA_REG_INDEX_WORKAROUND(fog_lut_data[0], 0xe8), 0xF, false,
+                     {11, 12, 13, 14, 15, 16, 17, 18, 19, 20 + seed, 21, 22});
+    }
+
+    AppendWrite(list, PICA_REG_INDEX(num_vertices), 0);
+    AppendWrite(list, PICA_REG_INDEX(trigger_draw), 1);
+    AppendWrite(list, border_color, seed);
+    return list;
+}
+
+/**
+ * Pair of command lists uploading the same data: `bulk` writes each run of data port words with one
+ * command header, while `word_by_word` writes every word with a header of its own, which always
+ * goes through the per-register path.
+ */
+struct DataPortLists {
+    std::vector<u32> bulk;
+    std::vector<u32> word_by_word;
+
+    void AppendWrite(u32 id, u32 value) {
+        ::AppendWrite(bulk, id, value);
+        ::AppendWrite(word_by_word, id, value);
+    }
+
+    void AppendRun(u32 id, bool group, const std::vector<u32>& values) {
+        AppendWrites(bulk, id, 0xF, group, values);
+        for (size_t i = 0; i < values.size(); ++i)
+            ::AppendWrite(word_by_word, group ? id + static_cast<u32>(i) : id, values[i]);
+    }
+};
+
+/// Returns a random data word, often one whose packed float24 values are (signed) zeros
+u32 RandomDataWord(std::mt19937& rng) {
+    static const u32 special_words[] = {0x00000000, 0x80000000, 0x00800000, 0x00008000,
+                                        0x00000080, 0xFFFFFFFF, 0x7F800000, 0xFF800000};
+    if (rng() % 4 == 0)
+        return special_words[rng() % 8];
+    return static_cast<u32>(rng());
+}
+
+std::vector<u32> RandomDataWords(std::mt19937& rng, u32 count) {
+    std::vector<u32> values(count);
+    for (u32& value : values)
+        value = RandomDataWord(rng);
+    return values;
+}
+
+/**
+ * Appends a run of random words to one of the eight registers of a data port at `port_id`,
+ * either all to the same register or to consecutive ones.
+ */
+void AppendRandomRun(DataPortLists& lists, std::mt19937& rng, u32 port_id, u32 count) {
+    const u32 first_register = rng() % 8;
+    const bool group = rng() % 2 == 0 && first_register + count <= 8;
+    lists.AppendRun(port_id + first_register, group, RandomDataWords(rng, count));
+}
+
+/// Requires the bulk list to leave the same state as the word by word one, processed and replayed
+void RequireSameAsWordByWord(CommandListRunner& runner, DataPortLists lists) {
+    // The processor reads a whole header after padding at the end of a list, so end both lists
+    // with a single write
+    lists.AppendWrite(PICA_REG_INDEX(texture0.border_color), 0);
+
+    const PicaSnapshot expected = runner.Run(0x100, lists.word_by_word);
+    for (int submission = 0; submission < 3; ++submission)
+        RequireSameState(runner.Run(0x8000, lists.bulk), expected);
+}
+
+} // namespace
+
+TEST_CASE("ProcessCommandList flushes queued draws before their state changes",
+          "[video_core][command_processor]") {
+    std::vector<u8> vram(Memory::PAGE_SIZE);
+    Memory::MapMemoryRegion(Memory::VRAM_VADDR, Memory::PAGE_SIZE, vram.data());
+
+    auto rasterizer = std::make_unique<BatchingRasterizer>();
+    BatchingRasterizer* batching_rasterizer = rasterizer.get();
+    VideoCore::g_renderer = std::make_unique<TestRenderer>(std::move(rasterizer));
+    Pica::CommandProcessor::ClearCommandListCache();
+
+    const u32 old_texture = 0x18100000 >> 3;
+    const u32 new_texture = 0x18200000 >> 3;
+
+    // The draw has no vertices, so the vertex base address only has to point at valid memory
+    std::vector<u32> list;
+    AppendWrite(list, PICA_REG_INDEX(vertex_attributes), Memory::VRAM_PADDR >> 3);
+    AppendWrite(list, PICA_REG_INDEX(num_vertices), 0);
+    AppendWrite(list, PICA_REG_INDEX(texture0.address), old_texture);
+    AppendWrite(list, PICA_REG_INDEX(trigger_draw), 1);
+    AppendWrite(list, PICA_REG_INDEX(texture0.address), new_texture);
+
+    const u32 list_offset = 0x100;
+    const u32 list_size = static_cast<u32>(list.size() * sizeof(u32));
+    std::memcpy(vram.data() + list_offset, list.data(), list_size);
+
+    // Lists are decoded and replayed from the cache once they are submitted again unchanged,
+    // so cover both paths
+    for (int submission = 0; submission < 3; ++submission) {
+        batching_rasterizer->flushed_texture_addresses.clear();
+        Pica::CommandProcessor::ProcessCommandList(Memory::VRAM_PADDR + list_offset, list_size);
+
+        REQUIRE(batching_rasterizer->flushed_texture_addresses.size() == 1);
+        REQUIRE(batching_rasterizer->flushed_texture_addresses[0] == old_texture);
+        REQUIRE(Pica::g_state.regs.texture0.address == new_texture);
+    }
+
+    Pica::CommandProcessor::ClearCommandListCache();
+    VideoCore::g_renderer.reset();
+    Memory::UnmapRegion(Memory::VRAM_VADDR, Memory::PAGE_SIZE);
+}
+
+TEST_CASE("ProcessCommandList submits queued draws before signalling the interrupt",
+          "[video_core][command_processor]") {
+    std::vector<u8> vram(Memory::PAGE_SIZE);
+    Memory::MapMemoryRegion(Memory::VRAM_VADDR, Memory::PAGE_SIZE, vram.data());
+
+    auto rasterizer = std::make_unique<BatchingRasterizer>();
+    BatchingRasterizer* batching_rasterizer = rasterizer.get();
+    VideoCore::g_renderer = std::make_unique<TestRenderer>(std::move(rasterizer));
+    Pica::CommandProcessor::ClearCommandListCache();
+
+    const u32 texture = 0x18100000 >> 3;
+
+    std::vector<u32> list;
+    AppendWrite(list, PICA_REG_INDEX(vertex_attributes), Memory::VRAM_PADDR >> 3);
+    AppendWrite(list, PICA_REG_INDEX(num_vertices), 0);
+    AppendWrite(list, PICA_REG_INDEX(texture0.address), texture);
+    AppendWrite(list, PICA_REG_INDEX(trigger_draw), 1);
+    AppendWrite(list, PICA_REG_INDEX(trigger_irq), 0x12345678);
+
+    const u32 list_offset = 0x100;
+    const u32 list_size = static_cast<u32>(list.size() * sizeof(u32));
+    std::memcpy(vram.data() + list_offset, list.data(), list_size);
+
+    // Nothing is left queued for the application to overwrite once it has been signalled
+    for (int submission = 0; submission < 3; ++submission) {
+        batching_rasterizer->flushed_texture_addresses.clear();
+        Pica::CommandProcessor::ProcessCommandList(Memory::VRAM_PADDR + list_offset, list_size);
+
+        REQUIRE(batching_rasterizer->flushed_texture_addresses.size() == 1);
+        REQUIRE(batching_rasterizer->flushed_texture_addresses[0] == texture);
+    }
+
+    Pica::CommandProcessor::ClearCommandListCache();
+    VideoCore::g_renderer.reset();
+    Memory::UnmapRegion(Memory::VRAM_VADDR, Memory::PAGE_SIZE);
+}
+
+TEST_CASE("Replayed command lists leave the same state as processed ones",
+          "[video_core][command_processor]") {
+    CommandListRunner runner;
+    const std::vector<u32> list = BuildStateList(0, true);
+
+    // The first submission is processed directly, later ones are decoded and replayed
+    const PicaSnapshot expected = runner.Run(0x100, list);
+    REQUIRE_FALSE(expected.notifications.empty());
+    for (int submission = 1; submission < 4; ++submission) {
+        const PicaSnapshot result = runner.Run(0x100, list);
+        RequireSameState(result, expected);
+        REQUIRE(result.notifications == expected.notifications);
+    }
+}
+
+TEST_CASE("Command lists changed at the same address are not replayed stale",
+          "[video_core][command_processor]") {
+    CommandListRunner runner;
+    const u32 address = 0x100;
+
+    const std::vector<u32> first = BuildStateList(0, true);
+    const std::vector<u32> same_size = BuildStateList(7, true);
+    const std::vector<u32> shorter = BuildStateList(0, false);
+    REQUIRE(same_size.size() == first.size());
+    REQUIRE(shorter.size() < first.size());
+
+    u32 other_address = 0x4000;
+    for (const auto* list : {&first, &same_size, &shorter, &first}) {
+        // Lists seen at an address for the first time are processed directly
+        const PicaSnapshot expected = runner.Run(other_address, *list);
+        other_address += 0x1000;
+
+        for (int submission = 0; submission < 3; ++submission) {
+            const PicaSnapshot result = runner.Run(address, *list);
+            RequireSameState(result, expected);
+            REQUIRE(result.notifications == expected.notifications);
+        }
+    }
+}
+
+TEST_CASE("Uniform uploads in bulk match uploads word by word", "[video_core][command_processor]") {
+    CommandListRunner runner;
+    std::mt19937 rng(2017);
+    const u32 uniform_setup = PICA_REG_INDEX(vs.uniform_setup);
+    const u32 set_value = PICA_REG_INDEX_WORKAROUND(vs.uniform_setup.set_value[0], 0x2c1);
+
+    for (int iteration = 0; iteration < 50; ++iteration) {
+        DataPortLists lists;
+        // Words of the current vector written so far. Changing the format doesn't reset it, so
+        // runs start and end at any position within a vector.
+        u32 vector_words = 0;
+        u32 words_per_uniform = 3;
+        const auto append_run = [&](u32 count) {
+            AppendRandomRun(lists, rng, set_value, count);
+            for (u32 i = 0; i < count; ++i) {
+                if (++vector_words >= words_per_uniform)
+                    vector_words = 0;
+            }
+        };
+
+        for (int segment = 0; segment < 4; ++segment) {
+            // Indices close to the end of the uniforms cover vectors past the last valid one
+            const bool is_float32 = rng() % 2 == 0;
+            words_per_uniform = is_float32 ? 4 : 3;
+            lists.AppendWrite(uniform_setup, (rng() % 100) | (is_float32 ? 1u << 31 : 0));
+
+            for (int run = 0; run < 3; ++run)
+                append_run(1 + rng() % 14);
+        }
+
+        // Leave no partially written vector behind for the next list
+        if (vector_words != 0)
+            append_run(words_per_uniform - vector_words);
+
+        RequireSameAsWordByWord(runner, lists);
+    }
+}
+
+TEST_CASE("LUT uploads in bulk match uploads word by word", "[video_core][command_processor]") {
+    CommandListRunner runner;
+    std::mt19937 rng(1234);
+    const u32 lut_config = PICA_REG_INDEX_WORKAROUND(lighting.lut_config, 0x1c5);
+    const u32 lut_data = PICA_REG_INDEX_WORKAROUND(lighting.lut_data[0], 0x1c8);
+    const u32 fog_lut_offset = PICA_REG_INDEX(fog_lut_offset);
+    const u32 fog_lut_data = PICA_REG_INDEX_WORKAROUND(fog_lut_data[0], 0xe8);
+
+    for (int iteration = 0; iteration < 50; ++iteration) {
+        DataPortLists lists;
+
+        // Runs are long enough to wrap around the end of the LUTs and their index registers
+        for (int segment = 0; segment < 3; ++segment) {
+            const u32 type = rng() % 24;
+            lists.AppendWrite(lut_config, (type << 8) | (rng() % 256));
+            for (int run = 0; run < 2; ++run)
+                AppendRandomRun(lists, rng, lut_data, 1 + rng() % 300);
+
+            lists.AppendWrite(fog_lut_offset, rng() % 2 == 0 ? rng() % 128 : 0xFF80 + rng() % 128);
+            for (int run = 0; run < 2; ++run)
+                AppendRandomRun(lists, rng, fog_lut_data, 1 + rng() % 150);
+        }
+
+        RequireSameAsWordByWord(runner, lists);
+    }
+}
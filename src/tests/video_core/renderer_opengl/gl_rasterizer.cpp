@@ -0,0 +1,247 @@
+// Copyright 2017 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <cstring>
+#include <memory>
+#include <vector>
+#include <catch.hpp>
+#include <glad/glad.h>
+#include "core/frontend/emu_window.h"
+#include "core/hle/kernel/process.h"
+#include "core/memory.h"
+#include "core/settings.h"
+#include "video_core/pica.h"
+#include "video_core/pica_state.h"
+#include "video_core/renderer_base.h"
+#include "video_core/renderer_opengl/gl_rasterizer.h"
+#include "video_core/video_core.h"
+
+namespace {
+
+/**
+ * Driver entry points that do nothing, apart from handing out object names, reporting shaders as
+ * compiled and recording draws. They are enough to run the rasterizer without a GL context.
+ */
+namespace FakeGL {
+
+/// Number of vertices of each draw
+std::vector<GLsizei> draws;
+
+template <typename F>
+struct NoOp;
+
+template <typename R, typename... Args>
+struct NoOp<R(APIENTRY*)(Args...)> {
+    static R APIENTRY Call(Args...) {
+        return R();
+    }
+};
+
+void APIENTRY GenNames(GLsizei n, GLuint* names) {
+    static GLuint next_name = 1;
+    for (GLsizei i = 0; i < n; ++i)
+        names[i] = next_name++;
+}
+
+GLuint APIENTRY CreateShader(GLenum type) {
+    GLuint name;
+    GenNames(1, &name);
+    return name;
+}
+
+GLuint APIENTRY CreateProgram() {
+    return CreateShader(0);
+}
+
+void APIENTRY GetObjectiv(GLuint object, GLenum pname, GLint* params) {
+    const bool is_status = pname == GL_COMPILE_STATUS || pname == GL_LINK_STATUS ||
+                           pname == GL_COMPLETION_STATUS_ARB;
+    *params = is_status ? GL_TRUE : 0;
+}
+
+void APIENTRY GetIntegerv(GLenum pname, GLint* data) {
+    *data = pname == GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT ? 256 : 0;
+}
+
+GLint APIENTRY GetUniformLocation(GLuint program, const GLchar* name) {
+    return -1;
+}
+
+GLuint APIENTRY GetUniformBlockIndex(GLuint program, const GLchar* name) {
+    return std::strcmp(name, "uber_config") == 0 ? 1 : 0;
+}
+
+void APIENTRY GetActiveUniformBlockiv(GLuint program, GLuint index, GLenum pname, GLint* params) {
+    // The sizes the rasterizer checks its uniform blocks against
+    *params = index == 1 ? 0x1E0 : 0x3C0;
+}
+
+void APIENTRY DrawArrays(GLenum mode, GLint first, GLsizei count) {
+    draws.push_back(count);
+}
+
+#define NO_OP(name) glad_##name = NoOp<decltype(glad_##name)>::Call
+
+void Install() {
+    draws.clear();
+    GLAD_GL_ARB_buffer_storage = 0;
+    GLAD_GL_ARB_get_program_binary = 0;
+    GLAD_GL_ARB_parallel_shader_compile = 0;
+
+    NO_OP(glActiveTexture);
+    NO_OP(glAttachShader);
+    NO_OP(glBindBuffer);
+    NO_OP(glBindBufferBase);
+    NO_OP(glBindBufferRange);
+    NO_OP(glBindFramebuffer);
+    NO_OP(glBindSampler);
+    NO_OP(glBindTexture);
+    NO_OP(glBindVertexArray);
+    NO_OP(glBlendColor);
+    NO_OP(glBlendEquationSeparate);
+    NO_OP(glBlendFuncSeparate);
+    NO_OP(glBlitFramebuffer);
+    NO_OP(glBufferData);
+    NO_OP(glBufferStorage);
+    NO_OP(glBufferSubData);
+    NO_OP(glClearBufferfi);
+    NO_OP(glClearBufferfv);
+    NO_OP(glClientWaitSync);
+    NO_OP(glColorMask);
+    NO_OP(glCompileShader);
+    NO_OP(glCullFace);
+    NO_OP(glDeleteBuffers);
+    NO_OP(glDeleteFramebuffers);
+    NO_OP(glDeleteProgram);
+    NO_OP(glDeleteSamplers);
+    NO_OP(glDeleteShader);
+    NO_OP(glDeleteSync);
+    NO_OP(glDeleteTextures);
+    NO_OP(glDeleteVertexArrays);
+    NO_OP(glDepthFunc);
+    NO_OP(glDepthMask);
+    NO_OP(glDisable);
+    NO_OP(glEnable);
+    NO_OP(glEnableVertexAttribArray);
+    NO_OP(glFenceSync);
+    NO_OP(glFramebufferTexture2D);
+    NO_OP(glFrontFace);
+    NO_OP(glGetProgramBinary);
+    NO_OP(glGetProgramInfoLog);
+    NO_OP(glGetShaderInfoLog);
+    NO_OP(glGetString);
+    NO_OP(glGetTexImage);
+    NO_OP(glLinkProgram);
+    NO_OP(glLogicOp);
+    NO_OP(glMapBufferRange);
+    NO_OP(glMaxShaderCompilerThreadsARB);
+    NO_OP(glPixelStorei);
+    NO_OP(glProgramBinary);
+    NO_OP(glProgramParameteri);
+    NO_OP(glReadPixels);
+    NO_OP(glSamplerParameterfv);
+    NO_OP(glSamplerParameteri);
+    NO_OP(glShaderSource);
+    NO_OP(glStencilFunc);
+    NO_OP(glStencilMask);
+    NO_OP(glStencilOp);
+    NO_OP(glTexBuffer);
+    NO_OP(glTexImage2D);
+    NO_OP(glTexParameteri);
+    NO_OP(glTexParameteriv);
+    NO_OP(glUniform1i);
+    NO_OP(glUniform4iv);
+    NO_OP(glUniformBlockBinding);
+    NO_OP(glUnmapBuffer);
+    NO_OP(glUseProgram);
+    NO_OP(glVertexAttribPointer);
+    NO_OP(glViewport);
+
+    glad_glGenBuffers = GenNames;
+    glad_glGenFramebuffers = GenNames;
+    glad_glGenSamplers = GenNames;
+    glad_glGenTextures = GenNames;
+    glad_glGenVertexArrays = GenNames;
+    glad_glCreateShader = CreateShader;
+    glad_glCreateProgram = CreateProgram;
+    glad_glGetShaderiv = GetObjectiv;
+    glad_glGetProgramiv = GetObjectiv;
+    glad_glGetIntegerv = GetIntegerv;
+    glad_glGetUniformLocation = GetUniformLocation;
+    glad_glGetUniformBlockIndex = GetUniformBlockIndex;
+    glad_glGetActiveUniformBlockiv = GetActiveUniformBlockiv;
+    glad_glDrawArrays = DrawArrays;
+}
+
+#undef NO_OP
+
+} // namespace FakeGL
+
+class TestWindow : public EmuWindow {
+public:
+    void SwapBuffers() override {}
+    void PollEvents() override {}
+    void MakeCurrent() override {}
+    void DoneCurrent() override {}
+};
+
+class TestRenderer : public RendererBase {
+public:
+    TestRenderer() {
+        rasterizer = std::make_unique<RasterizerOpenGL>();
+    }
+
+    void SwapBuffers() override {}
+    void SetWindow(EmuWindow* window) override {}
+    bool Init() override {
+        return true;
+    }
+    void ShutDown() override {}
+};
+
+} // namespace
+
+TEST_CASE("RasterizerOpenGL submits draws to uncached framebuffers once",
+          "[video_core][renderer_opengl]") {
+    // Cached surfaces are read through the VMAs of the current process, which maps VRAM
+    Kernel::g_current_process = Kernel::Process::Create(Kernel::CodeSet::Create("", 0));
+
+    FakeGL::Install();
+    TestWindow window;
+    VideoCore::g_emu_window = &window;
+    Settings::values.resolution_factor = 1.0f;
+
+    auto& framebuffer = Pica::g_state.regs.framebuffer;
+    framebuffer.color_format.Assign(Pica::Regs::ColorFormat::RGBA8);
+    framebuffer.color_buffer_address = Memory::VRAM_PADDR >> 3;
+    framebuffer.depth_buffer_address = 0;
+    framebuffer.width.Assign(64);
+    framebuffer.height.Assign(64 - 1);
+
+    VideoCore::g_renderer = std::make_unique<TestRenderer>();
+    VideoCore::RasterizerInterface* rasterizer = VideoCore::g_renderer->Rasterizer();
+
+    // Loading the framebuffer surface flushes its memory region through the rasterizer, while
+    // the draw is being submitted. The tile converter loading it draws single triangles.
+    const auto count_batch_draws = [] {
+        return std::count(FakeGL::draws.begin(), FakeGL::draws.end(), 6);
+    };
+    const Pica::Shader::OutputVertex vertex{};
+    rasterizer->AddTriangle(vertex, vertex, vertex);
+    rasterizer->AddTriangle(vertex, vertex, vertex);
+    rasterizer->DrawTriangles();
+    REQUIRE(FakeGL::draws.empty());
+
+    rasterizer->FlushAll();
+    REQUIRE(count_batch_draws() == 1);
+
+    rasterizer->FlushAll();
+    REQUIRE(count_batch_draws() == 1);
+
+    VideoCore::g_renderer.reset();
+    VideoCore::g_emu_window = nullptr;
+    std::memset(&framebuffer, 0, sizeof(framebuffer));
+    Kernel::g_current_process = nullptr;
+}
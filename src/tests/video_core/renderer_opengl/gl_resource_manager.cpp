@@ -0,0 +1,256 @@
+// Copyright 2017 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <cstdint>
+#include <cstring>
+#include <set>
+#include <tuple>
+#include <vector>
+#include <catch.hpp>
+#include <glad/glad.h>
+#include "common/common_types.h"
+#include "video_core/renderer_opengl/gl_resource_manager.h"
+
+namespace {
+
+/**
+ * Minimal stand-in for the driver entry points used by OGLStreamBuffer. Draws are tracked as the
+ * ranges of the buffer they read, which stay in use by the "GPU" until a fence inserted after
+ * them has been waited on.
+ */
+namespace FakeGL {
+
+struct PendingRead {
+    GLintptr offset;
+    GLsizeiptr size;
+    u64 sequence;
+};
+
+std::vector<u8> storage;
+bool mapped = false;
+std::vector<PendingRead> pending_reads;
+u64 sequence = 0;
+/// Sequence number each fence was inserted at, indexed by its handle
+std::vector<u64> fence_sequences;
+std::set<GLsync> live_fences;
+unsigned num_waits = 0;
+
+void Reset() {
+    storage.clear();
+    mapped = false;
+    pending_reads.clear();
+    sequence = 0;
+    fence_sequences.clear();
+    live_fences.clear();
+    num_waits = 0;
+}
+
+void Draw(GLintptr offset, GLsizeiptr size) {
+    pending_reads.push_back({offset, size, ++sequence});
+}
+
+bool IsPendingRead(GLintptr offset, GLsizeiptr size) {
+    for (const PendingRead& read : pending_reads) {
+        if (offset < read.offset + read.size && read.offset < offset + size)
+            return true;
+    }
+    return false;
+}
+
+void APIENTRY GenBuffers(GLsizei n, GLuint* buffers) {
+    static GLuint next_buffer = 1;
+    for (GLsizei i = 0; i < n; ++i)
+        buffers[i] = next_buffer++;
+}
+
+void APIENTRY DeleteBuffers(GLsizei n, const GLuint* buffers) {}
+
+void APIENTRY BindBuffer(GLenum target, GLuint buffer) {}
+
+void APIENTRY BufferData(GLenum target, GLsizeiptr size, const void* data, GLenum usage) {
+    storage.assign(static_cast<size_t>(size), 0);
+}
+
+void APIENTRY BufferStorage(GLenum target, GLsizeiptr size, const void* data, GLbitfield flags) {
+    storage.assign(static_cast<size_t>(size), 0);
+}
+
+void APIENTRY BufferSubData(GLenum target, GLintptr offset, GLsizeiptr size, const void* data) {
+    REQUIRE(offset + size <= static_cast<GLintptr>(storage.size()));
+    std::memcpy(storage.data() + offset, data, static_cast<size_t>(size));
+}
+
+void* APIENTRY MapBufferRange(GLenum target, GLintptr offset, GLsizeiptr length,
+                              GLbitfield access) {
+    mapped = true;
+    return storage.data() + offset;
+}
+
+GLboolean APIENTRY UnmapBuffer(GLenum target) {
+    mapped = false;
+    return GL_TRUE;
+}
+
+GLsync APIENTRY FenceSync(GLenum condition, GLbitfield flags) {
+    fence_sequences.push_back(sequence);
+    GLsync fence = reinterpret_cast<GLsync>(static_cast<uintptr_t>(fence_sequences.size()));
+    live_fences.insert(fence);
+    return fence;
+}
+
+void APIENTRY DeleteSync(GLsync sync) {
+    REQUIRE(live_fences.erase(sync) == 1);
+}
+
+GLenum APIENTRY ClientWaitSync(GLsync sync, GLbitfield flags, GLuint64 timeout) {
+    REQUIRE(live_fences.count(sync) == 1);
+    ++num_waits;
+
+    // Everything submitted before the fence has completed
+    const u64 fence_sequence = fence_sequences[reinterpret_cast<uintptr_t>(sync) - 1];
+    std::vector<PendingRead> still_pending;
+    for (const PendingRead& read : pending_reads) {
+        if (read.sequence > fence_sequence)
+            still_pending.push_back(read);
+    }
+    pending_reads = std::move(still_pending);
+    return GL_ALREADY_SIGNALED;
+}
+
+/// Installs the fake entry points for the lifetime of the object
+class Scope {
+public:
+    explicit Scope(bool buffer_storage) : old_buffer_storage(GLAD_GL_ARB_buffer_storage) {
+        Reset();
+        GLAD_GL_ARB_buffer_storage = buffer_storage ? 1 : 0;
+        glad_glGenBuffers = GenBuffers;
+        glad_glDeleteBuffers = DeleteBuffers;
+        glad_glBindBuffer = BindBuffer;
+        glad_glBufferData = BufferData;
+        glad_glBufferStorage = BufferStorage;
+        glad_glBufferSubData = BufferSubData;
+        glad_glMapBufferRange = MapBufferRange;
+        glad_glUnmapBuffer = UnmapBuffer;
+        glad_glFenceSync = FenceSync;
+        glad_glDeleteSync = DeleteSync;
+        glad_glClientWaitSync = ClientWaitSync;
+    }
+
+    ~Scope() {
+        GLAD_GL_ARB_buffer_storage = old_buffer_storage;
+    }
+
+private:
+    int old_buffer_storage;
+};
+
+} // namespace FakeGL
+
+constexpr GLsizeiptr BUFFER_SIZE = 0x1000;
+
+} // namespace
+
+TEST_CASE("OGLStreamBuffer aligns and wraps offsets", "[video_core][renderer_opengl]") {
+    FakeGL::Scope scope(true);
+    OGLStreamBuffer buffer(GL_ARRAY_BUFFER, BUFFER_SIZE);
+
+    u8* ptr;
+    GLintptr offset;
+
+    std::tie(ptr, offset) = buffer.Map(0x30, 4);
+    REQUIRE(offset == 0);
+    REQUIRE(ptr == FakeGL::storage.data());
+    buffer.Unmap(0x30);
+
+    std::tie(ptr, offset) = buffer.Map(0x10, 0x40);
+    REQUIRE(offset == 0x40);
+    REQUIRE(ptr == FakeGL::storage.data() + 0x40);
+
+    // Only the committed part of a mapping is skipped by the next one
+    buffer.Unmap(0x8);
+    std::tie(ptr, offset) = buffer.Map(0x4, 4);
+    REQUIRE(offset == 0x48);
+    buffer.Unmap(0x4);
+
+    // Data that doesn't fit in the rest of the ring starts over at its beginning
+    std::tie(ptr, offset) = buffer.Map(BUFFER_SIZE - 0x40, 4);
+    REQUIRE(offset == 0);
+    buffer.Unmap(BUFFER_SIZE - 0x40);
+
+    std::tie(ptr, offset) = buffer.Map(BUFFER_SIZE, 4);
+    REQUIRE(offset == 0);
+    buffer.Unmap(BUFFER_SIZE);
+}
+
+TEST_CASE("OGLStreamBuffer never hands out data the GPU may still read",
+          "[video_core][renderer_opengl]") {
+    FakeGL::Scope scope(true);
+
+    {
+        OGLStreamBuffer buffer(GL_ARRAY_BUFFER, BUFFER_SIZE);
+        REQUIRE(FakeGL::mapped);
+
+        u32 random = 1;
+        GLintptr last_offset = 0;
+        bool wrapped = false;
+        for (int i = 0; i < 2000; ++i) {
+            random = random * 1103515245 + 12345;
+            const GLsizeiptr size = 1 + (random >> 16) % 0x180;
+            const GLintptr alignment = (random & 0x100) ? 0x100 : 0x10;
+
+            u8* ptr;
+            GLintptr offset;
+            std::tie(ptr, offset) = buffer.Map(size, alignment);
+            REQUIRE(offset % alignment == 0);
+            REQUIRE(offset + size <= BUFFER_SIZE);
+            REQUIRE_FALSE(FakeGL::IsPendingRead(offset, size));
+
+            // Filling the ring for the first time never has to wait for the GPU
+            wrapped = wrapped || offset < last_offset;
+            if (!wrapped)
+                REQUIRE(FakeGL::num_waits == 0);
+            last_offset = offset;
+
+            std::memset(ptr, 0xAB, static_cast<size_t>(size));
+            buffer.Unmap(size);
+            FakeGL::Draw(offset, size);
+        }
+        REQUIRE(wrapped);
+    }
+
+    // Destroying the buffer releases every fence and the mapping
+    REQUIRE(FakeGL::live_fences.empty());
+    REQUIRE_FALSE(FakeGL::mapped);
+}
+
+TEST_CASE("OGLStreamBuffer uploads staged data without buffer storage",
+          "[video_core][renderer_opengl]") {
+    FakeGL::Scope scope(false);
+    OGLStreamBuffer buffer(GL_UNIFORM_BUFFER, BUFFER_SIZE);
+    REQUIRE(FakeGL::storage.size() == static_cast<size_t>(BUFFER_SIZE));
+
+    u8* ptr;
+    GLintptr offset;
+
+    std::tie(ptr, offset) = buffer.Map(0x20, 0x100);
+    REQUIRE(offset == 0);
+    std::memset(ptr, 0x11, 0x20);
+    buffer.Unmap(0x20);
+
+    std::tie(ptr, offset) = buffer.Map(0x20, 0x100);
+    REQUIRE(offset == 0x100);
+    std::memset(ptr, 0x22, 0x20);
+    buffer.Unmap(0x10);
+
+    REQUIRE(FakeGL::storage[0x00] == 0x11);
+    REQUIRE(FakeGL::storage[0x1F] == 0x11);
+    REQUIRE(FakeGL::storage[0x20] == 0x00);
+    REQUIRE(FakeGL::storage[0x100] == 0x22);
+    REQUIRE(FakeGL::storage[0x10F] == 0x22);
+    // Only the committed part of the mapping is uploaded
+    REQUIRE(FakeGL::storage[0x110] == 0x00);
+
+    // The fallback relies on the driver to synchronize uploads
+    REQUIRE(FakeGL::fence_sequences.empty());
+}
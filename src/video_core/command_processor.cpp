@@ -2,11 +2,16 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
+#include <algorithm>
 #include <array>
 #include <cstddef>
+#include <cstring>
 #include <memory>
+#include <unordered_map>
 #include <utility>
+#include <vector>
 #include "common/assert.h"
+#include "common/hash.h"
 #include "common/logging/log.h"
 #include "common/microprofile.h"
 #include "common/vector_math.h"
@@ -26,6 +31,10 @@
 #include "video_core/vertex_loader.h"
 #include "video_core/video_core.h"
 
+#ifdef ARCHITECTURE_x86_64
+#include <emmintrin.h>
+#endif // ARCHITECTURE_x86_64
+
 namespace Pica {
 
 namespace CommandProcessor {
@@ -46,6 +55,181 @@ static const u32 expand_bits_to_bytes[] = {
 
 MICROPROFILE_DEFINE(GPU_Drawing, "GPU", "Drawing", MP_RGB(50, 50, 240));
 
+static void WriteUniformData(u32 value) {
+    auto& uniform_setup = g_state.regs.vs.uniform_setup;
+
+    // TODO: Does actual hardware indeed keep an intermediate buffer or does
+    //       it directly write the values?
+    uniform_write_buffer[float_regs_counter++] = value;
+
+    // Uniforms are written in a packed format such that four float24 values are encoded in
+    // three 32-bit numbers. We write to internal memory once a full such vector is
+    // written.
+    if ((float_regs_counter >= 4 && uniform_setup.IsFloat32()) ||
+        (float_regs_counter >= 3 && !uniform_setup.IsFloat32())) {
+        float_regs_counter = 0;
+
+        if (uniform_setup.index > 95) {
+            LOG_ERROR(HW_GPU, "Invalid VS uniform index %d", (int)uniform_setup.index);
+            return;
+        }
+
+        auto& uniform = g_state.vs.uniforms.f[uniform_setup.index];
+
+        // NOTE: The destination component order indeed is "backwards"
+        if (uniform_setup.IsFloat32()) {
+            for (auto i : {0, 1, 2, 3})
+                uniform[3 - i] = float24::FromFloat32(*(float*)(&uniform_write_buffer[i]));
+        } else {
+            // TODO: Untested
+            uniform.w = float24::FromRaw(uniform_write_buffer[0] >> 8);
+            uniform.z = float24::FromRaw(((uniform_write_buffer[0] & 0xFF) << 16) |
+                                         ((uniform_write_buffer[1] >> 16) & 0xFFFF));
+            uniform.y = float24::FromRaw(((uniform_write_buffer[1] & 0xFFFF) << 8) |
+                                         ((uniform_write_buffer[2] >> 24) & 0xFF));
+            uniform.x = float24::FromRaw(uniform_write_buffer[2] & 0xFFFFFF);
+        }
+
+        LOG_TRACE(HW_GPU, "Set uniform %x to (%f %f %f %f)", (int)uniform_setup.index,
+                  uniform.x.ToFloat32(), uniform.y.ToFloat32(), uniform.z.ToFloat32(),
+                  uniform.w.ToFloat32());
+
+        // TODO: Verify that this actually modifies the register!
+        uniform_setup.index.Assign(uniform_setup.index + 1);
+    }
+}
+
+static void WriteLightingLutData(u32 value) {
+    auto& lut_config = g_state.regs.lighting.lut_config;
+
+    ASSERT_MSG(lut_config.index < 256, "lut_config.index exceeded maximum value of 255!");
+
+    g_state.lighting.luts[lut_config.type][lut_config.index].raw = value;
+    g_state.lighting.dirty.Add(lut_config.type * 256 + lut_config.index, 1);
+    lut_config.index.Assign(lut_config.index + 1);
+}
+
+static void WriteFogLutData(u32 value) {
+    auto& regs = g_state.regs;
+
+    g_state.fog.lut[regs.fog_lut_offset % 128].raw = value;
+    g_state.fog.dirty.Add(regs.fog_lut_offset % 128, 1);
+    regs.fog_lut_offset.Assign(regs.fog_lut_offset + 1);
+}
+
+static_assert(sizeof(Math::Vec4<float24>) == 4 * sizeof(float),
+              "Uniform vectors must be laid out as four consecutive floats");
+
+/// Stores a uniform written as four float32 values, in reverse component order
+static void UnpackFloat32Uniform(const u32* words, Math::Vec4<float24>& uniform) {
+#ifdef ARCHITECTURE_x86_64
+    __m128i data = _mm_loadu_si128(reinterpret_cast<const __m128i*>(words));
+    data = _mm_shuffle_epi32(data, _MM_SHUFFLE(0, 1, 2, 3));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(&uniform), data);
+#else
+    for (auto i : {0, 1, 2, 3})
+        uniform[3 - i] = float24::FromFloat32(*(float*)(&words[i]));
+#endif // ARCHITECTURE_x86_64
+}
+
+/// Stores a uniform written as four float24 values packed into three words
+static void UnpackFloat24Uniform(const u32* words, Math::Vec4<float24>& uniform) {
+#ifdef ARCHITECTURE_x86_64
+    // Split the packed words into one 24-bit value per lane, in x, y, z, w order
+    const __m128i raw = _mm_and_si128(
+        _mm_setr_epi32(words[2], (words[1] << 8) | (words[2] >> 24),
+                       (words[0] << 16) | (words[1] >> 16), words[0] >> 8),
+        _mm_set1_epi32(0xFFFFFF));
+
+    // Same conversion as float24::FromRaw: rebias the 7-bit exponent and widen the 16-bit
+    // mantissa. Values with all non-sign bits cleared become a signed zero.
+    const __m128i sign = _mm_slli_epi32(_mm_srli_epi32(raw, 23), 31);
+    const __m128i mantissa = _mm_slli_epi32(_mm_and_si128(raw, _mm_set1_epi32(0xFFFF)), 7);
+    const __m128i exponent = _mm_slli_epi32(
+        _mm_add_epi32(_mm_and_si128(_mm_srli_epi32(raw, 16), _mm_set1_epi32(0x7F)),
+                      _mm_set1_epi32(64)),
+        23);
+    const __m128i is_zero =
+        _mm_cmpeq_epi32(_mm_and_si128(raw, _mm_set1_epi32(0x7FFFFF)), _mm_setzero_si128());
+    const __m128i result =
+        _mm_or_si128(sign, _mm_andnot_si128(is_zero, _mm_or_si128(mantissa, exponent)));
+
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(&uniform), result);
+#else
+    uniform.w = float24::FromRaw(words[0] >> 8);
+    uniform.z = float24::FromRaw(((words[0] & 0xFF) << 16) | ((words[1] >> 16) & 0xFFFF));
+    uniform.y = float24::FromRaw(((words[1] & 0xFFFF) << 8) | ((words[2] >> 24) & 0xFF));
+    uniform.x = float24::FromRaw(words[2] & 0xFFFFFF);
+#endif // ARCHITECTURE_x86_64
+}
+
+/// Feeds a run of words written to vs.uniform_setup.set_value into the uniform state machine
+static void WriteUniformDataRun(const u32* values, size_t count) {
+    auto& uniform_setup = g_state.regs.vs.uniform_setup;
+
+    // Finish any partially written vector first
+    for (; count > 0 && float_regs_counter != 0; --count)
+        WriteUniformData(*values++);
+
+    // Whole vectors are converted directly from the command data
+    const bool is_float32 = uniform_setup.IsFloat32();
+    const size_t words_per_uniform = is_float32 ? 4 : 3;
+    for (; count >= words_per_uniform && uniform_setup.index <= 95;
+         count -= words_per_uniform, values += words_per_uniform) {
+        auto& uniform = g_state.vs.uniforms.f[uniform_setup.index];
+        if (is_float32)
+            UnpackFloat32Uniform(values, uniform);
+        else
+            UnpackFloat24Uniform(values, uniform);
+
+        LOG_TRACE(HW_GPU, "Set uniform %x to (%f %f %f %f)", (int)uniform_setup.index,
+                  uniform.x.ToFloat32(), uniform.y.ToFloat32(), uniform.z.ToFloat32(),
+                  uniform.w.ToFloat32());
+
+        uniform_setup.index.Assign(uniform_setup.index + 1);
+    }
+
+    // Trailing words and invalid indices take the regular path
+    for (; count > 0; --count)
+        WriteUniformData(*values++);
+}
+
+/// Copies a run of words written to lighting.lut_data into the selected lighting LUT
+static void WriteLightingLutDataRun(const u32* values, size_t count) {
+    auto& lut_config = g_state.regs.lighting.lut_config;
+    auto& lut = g_state.lighting.luts[lut_config.type];
+
+    while (count > 0) {
+        // The 8-bit index wraps around at the end of the LUT
+        const size_t index = lut_config.index;
+        const size_t chunk = std::min(count, lut.size() - index);
+        std::memcpy(&lut[index], values, chunk * sizeof(u32));
+        g_state.lighting.dirty.Add(static_cast<u32>(lut_config.type * lut.size() + index),
+                                   static_cast<u32>(chunk));
+        lut_config.index.Assign(static_cast<u32>(index + chunk));
+
+        values += chunk;
+        count -= chunk;
+    }
+}
+
+/// Copies a run of words written to fog_lut_data into the fog LUT
+static void WriteFogLutDataRun(const u32* values, size_t count) {
+    auto& regs = g_state.regs;
+    auto& lut = g_state.fog.lut;
+
+    while (count > 0) {
+        const size_t index = regs.fog_lut_offset % lut.size();
+        const size_t chunk = std::min(count, lut.size() - index);
+        std::memcpy(&lut[index], values, chunk * sizeof(u32));
+        g_state.fog.dirty.Add(static_cast<u32>(index), static_cast<u32>(chunk));
+        regs.fog_lut_offset.Assign(static_cast<u32>(regs.fog_lut_offset + chunk));
+
+        values += chunk;
+        count -= chunk;
+    }
+}
+
 static void WritePicaReg(u32 id, u32 value, u32 mask) {
     auto& regs = g_state.regs;
 
@@ -56,8 +240,10 @@ static void WritePicaReg(u32 id, u32 value, u32 mask) {
     u32 old_value = regs[id];
 
     const u32 write_mask = expand_bits_to_bytes[mask];
+    const u32 new_value = (old_value & ~write_mask) | (value & write_mask);
 
-    regs[id] = (old_value & ~write_mask) | (value & write_mask);
+    VideoCore::g_renderer->Rasterizer()->NotifyPicaRegisterWrite(id, new_value);
+    regs[id] = new_value;
 
     // Double check for is_pica_tracing to avoid call overhead
     if (DebugUtils::IsPicaTracing()) {
@@ -71,6 +257,8 @@ static void WritePicaReg(u32 id, u32 value, u32 mask) {
     switch (id) {
     // Trigger IRQ
     case PICA_REG_INDEX(trigger_irq):
+        // The application may change the memory read by queued draws once it is signalled
+        VideoCore::g_renderer->Rasterizer()->FlushDrawBatch();
         Service::GSP::SignalInterrupt(Service::GSP::InterruptId::P3D);
         break;
 
@@ -354,47 +542,7 @@ static void WritePicaReg(u32 id, u32 value, u32 mask) {
     case PICA_REG_INDEX_WORKAROUND(vs.uniform_setup.set_value[5], 0x2c6):
     case PICA_REG_INDEX_WORKAROUND(vs.uniform_setup.set_value[6], 0x2c7):
     case PICA_REG_INDEX_WORKAROUND(vs.uniform_setup.set_value[7], 0x2c8): {
-        auto& uniform_setup = regs.vs.uniform_setup;
-
-        // TODO: Does actual hardware indeed keep an intermediate buffer or does
-        //       it directly write the values?
-        uniform_write_buffer[float_regs_counter++] = value;
-
-        // Uniforms are written in a packed format such that four float24 values are encoded in
-        // three 32-bit numbers. We write to internal memory once a full such vector is
-        // written.
-        if ((float_regs_counter >= 4 && uniform_setup.IsFloat32()) ||
-            (float_regs_counter >= 3 && !uniform_setup.IsFloat32())) {
-            float_regs_counter = 0;
-
-            auto& uniform = g_state.vs.uniforms.f[uniform_setup.index];
-
-            if (uniform_setup.index > 95) {
-                LOG_ERROR(HW_GPU, "Invalid VS uniform index %d", (int)uniform_setup.index);
-                break;
-            }
-
-            // NOTE: The destination component order indeed is "backwards"
-            if (uniform_setup.IsFloat32()) {
-                for (auto i : {0, 1, 2, 3})
-                    uniform[3 - i] = float24::FromFloat32(*(float*)(&uniform_write_buffer[i]));
-            } else {
-                // TODO: Untested
-                uniform.w = float24::FromRaw(uniform_write_buffer[0] >> 8);
-                uniform.z = float24::FromRaw(((uniform_write_buffer[0] & 0xFF) << 16) |
-                                             ((uniform_write_buffer[1] >> 16) & 0xFFFF));
-                uniform.y = float24::FromRaw(((uniform_write_buffer[1] & 0xFFFF) << 8) |
-                                             ((uniform_write_buffer[2] >> 24) & 0xFF));
-                uniform.x = float24::FromRaw(uniform_write_buffer[2] & 0xFFFFFF);
-            }
-
-            LOG_TRACE(HW_GPU, "Set uniform %x to (%f %f %f %f)", (int)uniform_setup.index,
-                      uniform.x.ToFloat32(), uniform.y.ToFloat32(), uniform.z.ToFloat32(),
-                      uniform.w.ToFloat32());
-
-            // TODO: Verify that this actually modifies the register!
-            uniform_setup.index.Assign(uniform_setup.index + 1);
-        }
+        WriteUniformData(value);
         break;
     }
 
@@ -434,12 +582,7 @@ static void WritePicaReg(u32 id, u32 value, u32 mask) {
     case PICA_REG_INDEX_WORKAROUND(lighting.lut_data[5], 0x1cd):
     case PICA_REG_INDEX_WORKAROUND(lighting.lut_data[6], 0x1ce):
     case PICA_REG_INDEX_WORKAROUND(lighting.lut_data[7], 0x1cf): {
-        auto& lut_config = regs.lighting.lut_config;
-
-        ASSERT_MSG(lut_config.index < 256, "lut_config.index exceeded maximum value of 255!");
-
-        g_state.lighting.luts[lut_config.type][lut_config.index].raw = value;
-        lut_config.index.Assign(lut_config.index + 1);
+        WriteLightingLutData(value);
         break;
     }
 
@@ -451,8 +594,7 @@ static void WritePicaReg(u32 id, u32 value, u32 mask) {
     case PICA_REG_INDEX_WORKAROUND(fog_lut_data[5], 0xed):
     case PICA_REG_INDEX_WORKAROUND(fog_lut_data[6], 0xee):
     case PICA_REG_INDEX_WORKAROUND(fog_lut_data[7], 0xef): {
-        g_state.fog.lut[regs.fog_lut_offset % 128].raw = value;
-        regs.fog_lut_offset.Assign(regs.fog_lut_offset + 1);
+        WriteFogLutData(value);
         break;
     }
 
@@ -467,10 +609,366 @@ static void WritePicaReg(u32 id, u32 value, u32 mask) {
                                  reinterpret_cast<void*>(&id));
 }
 
-void ProcessCommandList(const u32* list, u32 size) {
-    g_state.cmd_list.head_ptr = g_state.cmd_list.current_ptr = list;
-    g_state.cmd_list.length = size / sizeof(u32);
+/// Returns true if writes may be applied in bulk without emitting per-register debug events
+static bool CanWriteInBulk() {
+    if (DebugUtils::IsPicaTracing())
+        return false;
+
+    if (g_debug_context) {
+        const auto& breakpoints = g_debug_context->breakpoints;
+        if (breakpoints[(int)DebugContext::Event::PicaCommandLoaded].enabled ||
+            breakpoints[(int)DebugContext::Event::PicaCommandProcessed].enabled)
+            return false;
+    }
+
+    return true;
+}
+
+using DataRunWriter = void (*)(const u32* values, size_t count);
+
+/**
+ * Applies a run of full-mask writes to a data port register (e.g. a uniform or LUT upload) in one
+ * go, bypassing the register dispatch in WritePicaReg. The rasterizer is notified once per run.
+ * @param ids Register ids written by each word of the run
+ * @param values Data words of the run
+ * @param count Number of words in the run
+ * @param write_run Function feeding the data words into the port's state machine
+ */
+static void WriteDataRun(const u16* ids, const u32* values, size_t count,
+                         DataRunWriter write_run) {
+    if (!CanWriteInBulk()) {
+        for (size_t i = 0; i < count; ++i)
+            WritePicaReg(ids[i], values[i], 0xF);
+        return;
+    }
+
+    // All words of the run go to the same port, so one notification covers them
+    VideoCore::g_renderer->Rasterizer()->NotifyPicaRegisterWrite(ids[0], values[0]);
+
+    auto& regs = g_state.regs;
+    for (size_t i = 0; i < count; ++i)
+        regs[ids[i]] = values[i];
+
+    write_run(values, count);
+
+    VideoCore::g_renderer->Rasterizer()->NotifyPicaRegisterChanged(ids[count - 1]);
+}
+
+namespace {
+
+/// Command list decoded into groups of register writes, ready to be replayed
+struct DecodedCommandList {
+    enum class OpType : u8 {
+        /// Writes to ordinary registers, replayed one by one through WritePicaReg
+        StateGroup,
+        /// Run of full-mask writes to vs.uniform_setup.set_value
+        UniformUpload,
+        /// Run of full-mask writes to lighting.lut_data
+        LightingLutUpload,
+        /// Run of full-mask writes to fog_lut_data
+        FogLutUpload,
+        /// Write to a register that kicks off rendering
+        Draw,
+        /// Write to command_buffer.trigger, which continues processing in another command list
+        Jump,
+    };
+
+    struct Op {
+        OpType type;
+        u32 offset; ///< Index of the first write of this op
+        u32 count;  ///< Number of writes in this op
+    };
+
+    std::vector<Op> ops;
+
+    // Register writes of all ops. These are stored as separate arrays so that the data words of
+    // bulk uploads are contiguous in memory.
+    std::vector<u16> ids;
+    std::vector<u8> masks;
+    std::vector<u32> values;
+
+    void Clear() {
+        ops.clear();
+        ids.clear();
+        masks.clear();
+        values.clear();
+    }
+
+    /**
+     * Appends a write, merging it into the previous op if that is of the same type.
+     * @param new_op Whether the write has to start an op of its own. Draws and jumps always do.
+     */
+    void AddWrite(OpType type, u32 id, u32 mask, u32 value, bool new_op) {
+        bool mergeable = !new_op && type != OpType::Draw && type != OpType::Jump;
+        if (!mergeable || ops.empty() || ops.back().type != type)
+            ops.push_back({type, static_cast<u32>(values.size()), 0});
+
+        ops.back().count++;
+        ids.push_back(static_cast<u16>(id));
+        masks.push_back(static_cast<u8>(mask));
+        values.push_back(value);
+    }
+};
+
+struct CachedCommandList {
+    u32 size;
+    u64 hash;
+    /// Whether `list` holds the decoded contents. Lists are only decoded once they have been
+    /// submitted twice with the same contents, to avoid paying for lists that are rebuilt
+    /// every frame.
+    bool decoded;
+    /// Cleared if decoding failed, in which case the list is processed directly until its
+    /// contents change
+    bool decodable;
+    DecodedCommandList list;
+};
+
+} // namespace
+
+/// Cache of decoded command lists, indexed by their physical address
+static std::unordered_map<PAddr, CachedCommandList> command_list_cache;
+
+/// Upper bound on the number of cached command lists; the cache is reset when it is exceeded
+constexpr size_t MAX_CACHED_COMMAND_LISTS = 1024;
+
+MICROPROFILE_DEFINE(GPU_CmdlistDecoding, "GPU", "Cmdlist Decoding", MP_RGB(100, 200, 100));
+
+static DecodedCommandList::OpType ClassifyWrite(u32 id, u32 mask) {
+    using OpType = DecodedCommandList::OpType;
 
+    switch (id) {
+    case PICA_REG_INDEX_WORKAROUND(vs.uniform_setup.set_value[0], 0x2c1):
+    case PICA_REG_INDEX_WORKAROUND(vs.uniform_setup.set_value[1], 0x2c2):
+    case PICA_REG_INDEX_WORKAROUND(vs.uniform_setup.set_value[2], 0x2c3):
+    case PICA_REG_INDEX_WORKAROUND(vs.uniform_setup.set_value[3], 0x2c4):
+    case PICA_REG_INDEX_WORKAROUND(vs.uniform_setup.set_value[4], 0x2c5):
+    case PICA_REG_INDEX_WORKAROUND(vs.uniform_setup.set_value[5], 0x2c6):
+    case PICA_REG_INDEX_WORKAROUND(vs.uniform_setup.set_value[6], 0x2c7):
+    case PICA_REG_INDEX_WORKAROUND(vs.uniform_setup.set_value[7], 0x2c8):
+        return mask == 0xF ? OpType::UniformUpload : OpType::StateGroup;
+
+    case PICA_REG_INDEX_WORKAROUND(lighting.lut_data[0], 0x1c8):
+    case PICA_REG_INDEX_WORKAROUND(lighting.lut_data[1], 0x1c9):
+    case PICA_REG_INDEX_WORKAROUND(lighting.lut_data[2], 0x1ca):
+    case PICA_REG_INDEX_WORKAROUND(lighting.lut_data[3], 0x1cb):
+    case PICA_REG_INDEX_WORKAROUND(lighting.lut_data[4], 0x1cc):
+    case PICA_REG_INDEX_WORKAROUND(lighting.lut_data[5], 0x1cd):
+    case PICA_REG_INDEX_WORKAROUND(lighting.lut_data[6], 0x1ce):
+    case PICA_REG_INDEX_WORKAROUND(lighting.lut_data[7], 0x1cf):
+        return mask == 0xF ? OpType::LightingLutUpload : OpType::StateGroup;
+
+    case PICA_REG_INDEX_WORKAROUND(fog_lut_data[0], 0xe8):
+    case PICA_REG_INDEX_WORKAROUND(fog_lut_data[1], 0xe9):
+    case PICA_REG_INDEX_WORKAROUND(fog_lut_data[2], 0xea):
+    case PICA_REG_INDEX_WORKAROUND(fog_lut_data[3], 0xeb):
+    case PICA_REG_INDEX_WORKAROUND(fog_lut_data[4], 0xec):
+    case PICA_REG_INDEX_WORKAROUND(fog_lut_data[5], 0xed):
+    case PICA_REG_INDEX_WORKAROUND(fog_lut_data[6], 0xee):
+    case PICA_REG_INDEX_WORKAROUND(fog_lut_data[7], 0xef):
+        return mask == 0xF ? OpType::FogLutUpload : OpType::StateGroup;
+
+    case PICA_REG_INDEX(trigger_draw):
+    case PICA_REG_INDEX(trigger_draw_indexed):
+    case PICA_REG_INDEX(gpu_mode):
+        return OpType::Draw;
+
+    case PICA_REG_INDEX_WORKAROUND(command_buffer.trigger[0], 0x23c):
+    case PICA_REG_INDEX_WORKAROUND(command_buffer.trigger[1], 0x23d):
+        return OpType::Jump;
+
+    default:
+        return OpType::StateGroup;
+    }
+}
+
+/// Returns the bulk writer for data port upload ops, or nullptr for other op types
+static DataRunWriter GetDataRunWriter(DecodedCommandList::OpType type) {
+    using OpType = DecodedCommandList::OpType;
+
+    switch (type) {
+    case OpType::UniformUpload:
+        return WriteUniformDataRun;
+    case OpType::LightingLutUpload:
+        return WriteLightingLutDataRun;
+    case OpType::FogLutUpload:
+        return WriteFogLutDataRun;
+    default:
+        return nullptr;
+    }
+}
+
+/**
+ * Decodes the given command list into a sequence of ops.
+ * @returns false if the list can't be represented as decoded ops (it is then processed directly)
+ */
+static bool DecodeCommandList(const u32* list, u32 length, DecodedCommandList& decoded) {
+    MICROPROFILE_SCOPE(GPU_CmdlistDecoding);
+    using OpType = DecodedCommandList::OpType;
+
+    decoded.Clear();
+
+    const u32* current = list;
+    const u32* end = list + length;
+    while (current < end) {
+        // Align read pointer to 8 bytes
+        if ((list - current) % 2 != 0)
+            ++current;
+
+        if (current + 2 > end)
+            return false;
+
+        u32 value = *current++;
+        const CommandHeader header = {*current++};
+        const u32 num_writes = header.extra_data_length + 1;
+
+        if (current + header.extra_data_length > end)
+            return false;
+
+        // Like in ProcessCommandListDirect, the writes of a header form one data port run only if
+        // all of them go to the same port, so that the rasterizer is notified the same way
+        const u32 last_id = header.cmd_id + (header.group_commands ? num_writes - 1 : 0);
+        const OpType header_type = ClassifyWrite(header.cmd_id, header.parameter_mask);
+        const bool is_data_run = GetDataRunWriter(header_type) && last_id < Regs::NumIds() &&
+                                 ClassifyWrite(last_id, header.parameter_mask) == header_type;
+
+        for (u32 i = 0; i < num_writes; ++i) {
+            u32 id = header.cmd_id + (header.group_commands ? i : 0);
+            if (i > 0)
+                value = *current++;
+
+            if (id >= Regs::NumIds())
+                continue;
+
+            OpType type = ClassifyWrite(id, header.parameter_mask);
+            if (GetDataRunWriter(type) && !is_data_run)
+                type = OpType::StateGroup;
+            decoded.AddWrite(type, id, header.parameter_mask, value, is_data_run && i == 0);
+
+            if (type == OpType::Jump) {
+                // Any parameters following the jump would be read from the new command list
+                if (i + 1 != num_writes)
+                    return false;
+
+                // Nothing after the jump is processed
+                return true;
+            }
+        }
+    }
+
+    return true;
+}
+
+static void ReplayCommandList(const DecodedCommandList& decoded) {
+    using OpType = DecodedCommandList::OpType;
+
+    for (const auto& op : decoded.ops) {
+        const u16* ids = &decoded.ids[op.offset];
+        const u8* masks = &decoded.masks[op.offset];
+        const u32* values = &decoded.values[op.offset];
+
+        switch (op.type) {
+        case OpType::UniformUpload:
+        case OpType::LightingLutUpload:
+        case OpType::FogLutUpload:
+            WriteDataRun(ids, values, op.count, GetDataRunWriter(op.type));
+            break;
+
+        case OpType::StateGroup:
+        case OpType::Draw:
+        case OpType::Jump:
+            for (u32 i = 0; i < op.count; ++i)
+                WritePicaReg(ids[i], values[i], masks[i]);
+            break;
+        }
+    }
+}
+
+/**
+ * Looks up the decoded form of the given command list, decoding it if it has been seen before with
+ * the same contents.
+ * @returns The decoded list, or nullptr if the list should be processed directly
+ */
+static const DecodedCommandList* LookupCommandList(PAddr list_addr, const u32* list, u32 length) {
+    const u32 size = length * sizeof(u32);
+    const u64 hash = Common::ComputeHash64(list, size);
+
+    auto it = command_list_cache.find(list_addr);
+    if (it == command_list_cache.end()) {
+        if (command_list_cache.size() >= MAX_CACHED_COMMAND_LISTS)
+            command_list_cache.clear();
+
+        command_list_cache.emplace(list_addr, CachedCommandList{size, hash, false, true, {}});
+        return nullptr;
+    }
+
+    CachedCommandList& cached = it->second;
+    if (cached.size != size || cached.hash != hash) {
+        // Contents changed since the last submission, only remember the new contents for now
+        cached.size = size;
+        cached.hash = hash;
+        cached.decoded = false;
+        cached.decodable = true;
+        cached.list.Clear();
+        return nullptr;
+    }
+
+    if (!cached.decodable)
+        return nullptr;
+
+    if (!cached.decoded) {
+        if (!DecodeCommandList(list, length, cached.list)) {
+            cached.decodable = false;
+            cached.list.Clear();
+            return nullptr;
+        }
+        cached.decoded = true;
+    }
+
+    return &cached.list;
+}
+
+/**
+ * Applies all writes of a command header to a data port (uniforms or LUTs) as a single run.
+ * @returns false if the header doesn't qualify for this, in which case nothing is written
+ */
+static bool WriteHeaderDataRun(const CommandHeader& header, u32 value, const u32* extra_data,
+                               const u32* end) {
+    const u32 num_extra = header.extra_data_length;
+    if (header.parameter_mask != 0xF || extra_data + num_extra > end)
+        return false;
+
+    // All writes of the header need to target the same port. The ports are blocks of consecutive
+    // registers, so for grouped commands checking the first and last register is sufficient.
+    const u32 first_id = header.cmd_id;
+    const u32 last_id = first_id + (header.group_commands ? num_extra : 0);
+    if (last_id >= Regs::NumIds())
+        return false;
+
+    const auto type = ClassifyWrite(first_id, 0xF);
+    DataRunWriter write_run = GetDataRunWriter(type);
+    if (!write_run || ClassifyWrite(last_id, 0xF) != type || !CanWriteInBulk())
+        return false;
+
+    VideoCore::g_renderer->Rasterizer()->NotifyPicaRegisterWrite(first_id, value);
+
+    auto& regs = g_state.regs;
+    if (header.group_commands) {
+        regs[first_id] = value;
+        for (u32 i = 0; i < num_extra; ++i)
+            regs[first_id + 1 + i] = extra_data[i];
+    } else {
+        regs[first_id] = num_extra ? extra_data[num_extra - 1] : value;
+    }
+
+    // The first data word is stored in front of the header, the others follow it
+    write_run(&value, 1);
+    write_run(extra_data, num_extra);
+
+    VideoCore::g_renderer->Rasterizer()->NotifyPicaRegisterChanged(last_id);
+    return true;
+}
+
+static void ProcessCommandListDirect() {
     while (g_state.cmd_list.current_ptr < g_state.cmd_list.head_ptr + g_state.cmd_list.length) {
 
         // Align read pointer to 8 bytes
@@ -480,6 +978,13 @@ void ProcessCommandList(const u32* list, u32 size) {
         u32 value = *g_state.cmd_list.current_ptr++;
         const CommandHeader header = {*g_state.cmd_list.current_ptr++};
 
+        if (header.extra_data_length != 0 &&
+            WriteHeaderDataRun(header, value, g_state.cmd_list.current_ptr,
+                               g_state.cmd_list.head_ptr + g_state.cmd_list.length)) {
+            g_state.cmd_list.current_ptr += header.extra_data_length;
+            continue;
+        }
+
         WritePicaReg(header.cmd_id, value, header.parameter_mask);
 
         for (unsigned i = 0; i < header.extra_data_length; ++i) {
@@ -489,6 +994,43 @@ void ProcessCommandList(const u32* list, u32 size) {
     }
 }
 
+void ProcessCommandList(PAddr list_addr, u32 size) {
+    while (true) {
+        const u32* list = reinterpret_cast<const u32*>(Memory::GetPhysicalPointer(list_addr));
+        if (!list) {
+            LOG_ERROR(HW_GPU, "Invalid command list address 0x%08X", list_addr);
+            return;
+        }
+
+        g_state.cmd_list.head_ptr = g_state.cmd_list.current_ptr = list;
+        g_state.cmd_list.length = size / sizeof(u32);
+
+        const DecodedCommandList* decoded =
+            LookupCommandList(list_addr, list, g_state.cmd_list.length);
+        if (!decoded) {
+            // Jumps to other command lists are followed inline here
+            ProcessCommandListDirect();
+            return;
+        }
+
+        ReplayCommandList(*decoded);
+
+        if (decoded->ops.empty() || decoded->ops.back().type != DecodedCommandList::OpType::Jump)
+            return;
+
+        // Continue with the command list the jump pointed to
+        const auto& last = decoded->ops.back();
+        const unsigned index = static_cast<unsigned>(
+            decoded->ids[last.offset] - PICA_REG_INDEX(command_buffer.trigger[0]));
+        list_addr = g_state.regs.command_buffer.GetPhysicalAddress(index);
+        size = g_state.regs.command_buffer.GetSize(index);
+    }
+}
+
+void ClearCommandListCache() {
+    command_list_cache.clear();
+}
+
 } // namespace
 
 } // namespace
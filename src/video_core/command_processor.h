@@ -34,7 +34,16 @@ static_assert(std::is_standard_layout<CommandHeader>::value == true,
               "CommandHeader does not use standard layout");
 static_assert(sizeof(CommandHeader) == sizeof(u32), "CommandHeader has incorrect size!");
 
-void ProcessCommandList(const u32* list, u32 size);
+/**
+ * Processes the command list located at the given physical address. Lists that are submitted
+ * repeatedly with unchanged contents are decoded once and replayed from a cache afterwards.
+ * @param list_addr Physical address of the command list
+ * @param size Size of the command list in bytes
+ */
+void ProcessCommandList(PAddr list_addr, u32 size);
+
+/// Discards all cached decoded command lists
+void ClearCommandListCache();
 
 } // namespace
 
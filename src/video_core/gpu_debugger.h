@@ -33,6 +33,24 @@ public:
             LOG_TRACE(Debug_GPU, "Received command: id=%x", (int)cmd.id.Value());
         }
 
+        /**
+        * Called when the hardware renderer has finished a frame.
+        * @param guest_draws Number of draws triggered by the PICA during the frame
+        * @param host_draws Number of draw calls the renderer submitted for them
+        * @note Called from the GPU thread
+        */
+        virtual void FrameDrawStatsUpdated(u32 guest_draws, u32 host_draws) {}
+
+        /**
+        * Called when the hardware renderer has finished a frame.
+        * @param hits Surface lookups satisfied by the surface cache during the frame
+        * @param uploads Surfaces decoded and uploaded from guest memory
+        * @param reuses Surfaces restored by content hash instead of being uploaded
+        * @param evictions Surfaces evicted to stay within the memory budget
+        * @note Called from the GPU thread
+        */
+        virtual void FrameSurfaceStatsUpdated(u32 hits, u32 uploads, u32 reuses, u32 evictions) {}
+
     protected:
         const GraphicsDebugger* GetDebugger() const {
             return observed;
@@ -58,6 +76,18 @@ public:
         });
     }
 
+    void FrameDrawStatsUpdated(u32 guest_draws, u32 host_draws) {
+        ForEachObserver([guest_draws, host_draws](DebuggerObserver* observer) {
+            observer->FrameDrawStatsUpdated(guest_draws, host_draws);
+        });
+    }
+
+    void FrameSurfaceStatsUpdated(u32 hits, u32 uploads, u32 reuses, u32 evictions) {
+        ForEachObserver([hits, uploads, reuses, evictions](DebuggerObserver* observer) {
+            observer->FrameSurfaceStatsUpdated(hits, uploads, reuses, evictions);
+        });
+    }
+
     const Service::GSP::Command& ReadGXCommandHistory(int index) const {
         // TODO: Is this thread-safe?
         return gx_command_history[index];
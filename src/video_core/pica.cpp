@@ -6,6 +6,7 @@
 #include <iterator>
 #include <unordered_map>
 #include <utility>
+#include "video_core/command_processor.h"
 #include "video_core/pica.h"
 #include "video_core/pica_state.h"
 #include "video_core/primitive_assembly.h"
@@ -499,6 +500,7 @@ void Init() {
 }
 
 void Shutdown() {
+    CommandProcessor::ClearCommandListCache();
     Shader::Shutdown();
 }
 
@@ -4,6 +4,7 @@
 
 #pragma once
 
+#include <algorithm>
 #include <array>
 #include "common/bit_field.h"
 #include "common/common_types.h"
@@ -25,6 +26,30 @@ struct State {
 
     std::array<Math::Vec4<float24>, 16> vs_default_attributes;
 
+    /// Range of LUT entries written since a renderer last uploaded them
+    struct DirtyRange {
+        u32 begin = 0;
+        u32 end = 0;
+
+        void Add(u32 first, u32 count) {
+            if (IsEmpty()) {
+                begin = first;
+                end = first + count;
+            } else {
+                begin = std::min(begin, first);
+                end = std::max(end, first + count);
+            }
+        }
+
+        bool IsEmpty() const {
+            return begin == end;
+        }
+
+        void Reset() {
+            begin = end = 0;
+        }
+    };
+
     struct {
         union LutEntry {
             // Used for raw access
@@ -42,6 +67,9 @@ struct State {
         };
 
         std::array<std::array<LutEntry, 256>, 24> luts;
+
+        /// Dirty entries, indexed as lut * 256 + entry
+        DirtyRange dirty;
     } lighting;
 
     struct {
@@ -54,6 +82,8 @@ struct State {
         };
 
         std::array<LutEntry, 128> lut;
+
+        DirtyRange dirty;
     } fog;
 
     /// Current Pica command list
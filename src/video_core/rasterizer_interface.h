@@ -29,6 +29,13 @@ public:
     /// Draw the current batch of triangles
     virtual void DrawTriangles() = 0;
 
+    /// Submit the draws the rasterizer has queued instead of drawing them right away
+    virtual void FlushDrawBatch() {}
+
+    /// Notify rasterizer that the specified PICA register is about to be written. The register
+    /// still holds its old value.
+    virtual void NotifyPicaRegisterWrite(u32 id, u32 value) {}
+
     /// Notify rasterizer that the specified PICA register has been changed
     virtual void NotifyPicaRegisterChanged(u32 id) = 0;
 
@@ -42,6 +49,9 @@ public:
     /// and invalidated
     virtual void FlushAndInvalidateRegion(PAddr addr, u32 size) = 0;
 
+    /// Notify rasterizer that the current frame has been presented
+    virtual void NotifyFrameFinished() {}
+
     /// Attempt to use a faster method to perform a display transfer with is_texture_copy = 0
     virtual bool AccelerateDisplayTransfer(const GPU::Regs::DisplayTransferConfig& config) {
         return false;
@@ -2,18 +2,23 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
+#include <algorithm>
+#include <cstring>
 #include <memory>
 #include <string>
 #include <tuple>
 #include <utility>
+#include <vector>
 #include <glad/glad.h>
 #include "common/assert.h"
 #include "common/color.h"
+#include "common/file_util.h"
 #include "common/logging/log.h"
 #include "common/math_util.h"
 #include "common/microprofile.h"
 #include "common/vector_math.h"
 #include "core/hw/gpu.h"
+#include "video_core/gpu_debugger.h"
 #include "video_core/pica.h"
 #include "video_core/pica_state.h"
 #include "video_core/renderer_opengl/gl_rasterizer.h"
@@ -22,9 +27,20 @@
 #include "video_core/renderer_opengl/pica_to_gl.h"
 #include "video_core/renderer_opengl/renderer_opengl.h"
 
+extern GraphicsDebugger g_debugger;
+
 MICROPROFILE_DEFINE(OpenGL_Drawing, "OpenGL", "Drawing", MP_RGB(128, 128, 192));
 MICROPROFILE_DEFINE(OpenGL_Blits, "OpenGL", "Blits", MP_RGB(100, 100, 255));
 MICROPROFILE_DEFINE(OpenGL_CacheManagement, "OpenGL", "Cache Mgmt", MP_RGB(100, 255, 100));
+MICROPROFILE_DEFINE(OpenGL_LUTUpload, "OpenGL", "LUT Upload", MP_RGB(192, 128, 64));
+
+/// Capacity of the stream buffers vertices and uniform blocks are appended to
+constexpr GLsizeiptr VERTEX_BUFFER_SIZE = 4 * 1024 * 1024;
+constexpr GLsizeiptr UNIFORM_BUFFER_SIZE = 1024 * 1024;
+
+/// Entry offset of the fog LUT in the LUT buffer, matching FOG_LUT_OFFSET in the shaders
+constexpr u32 FOG_LUT_OFFSET = 24 * 256;
+constexpr GLsizeiptr LUT_BUFFER_SIZE = (FOG_LUT_OFFSET + 128) * sizeof(u32);
 
 static bool IsPassThroughTevStage(const Pica::Regs::TevStageConfig& stage) {
     return (stage.color_op == Pica::Regs::TevStageConfig::Operation::Replace &&
@@ -36,34 +52,30 @@ static bool IsPassThroughTevStage(const Pica::Regs::TevStageConfig& stage) {
             stage.GetColorMultiplier() == 1 && stage.GetAlphaMultiplier() == 1);
 }
 
-RasterizerOpenGL::RasterizerOpenGL() : shader_dirty(true) {
+RasterizerOpenGL::RasterizerOpenGL()
+    : shader_dirty(true), vertex_buffer(GL_ARRAY_BUFFER, VERTEX_BUFFER_SIZE),
+      uniform_buffer(GL_UNIFORM_BUFFER, UNIFORM_BUFFER_SIZE) {
     // Create sampler objects
     for (size_t i = 0; i < texture_samplers.size(); ++i) {
         texture_samplers[i].Create();
         state.texture_units[i].sampler = texture_samplers[i].sampler.handle;
     }
 
-    // Generate VBO, VAO and UBO
-    vertex_buffer.Create();
+    // Generate VAO, the VBO and UBO are stream buffers created with the rasterizer
     vertex_array.Create();
-    uniform_buffer.Create();
 
     state.draw.vertex_array = vertex_array.handle;
-    state.draw.vertex_buffer = vertex_buffer.handle;
-    state.draw.uniform_buffer = uniform_buffer.handle;
+    state.draw.vertex_buffer = vertex_buffer.GetHandle();
+    state.draw.uniform_buffer = uniform_buffer.GetHandle();
     state.Apply();
 
-    // Bind the UBO to binding point 0
-    glBindBufferBase(GL_UNIFORM_BUFFER, 0, uniform_buffer.handle);
+    // Uniform blocks are bound to binding point 0 at their offset in the stream buffer on upload
+    GLint alignment;
+    glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &alignment);
+    uniform_buffer_alignment = std::max<GLint>(alignment, 1);
 
     uniform_block_data.dirty = true;
 
-    for (unsigned index = 0; index < lighting_luts.size(); index++) {
-        uniform_block_data.lut_dirty[index] = true;
-    }
-
-    uniform_block_data.fog_lut_dirty = true;
-
     // Set vertex attributes
     glVertexAttribPointer(GLShader::ATTRIBUTE_POSITION, 4, GL_FLOAT, GL_FALSE,
                           sizeof(HardwareVertex), (GLvoid*)offsetof(HardwareVertex, position));
@@ -98,31 +110,23 @@ RasterizerOpenGL::RasterizerOpenGL() : shader_dirty(true) {
     // Create render framebuffer
     framebuffer.Create();
 
-    // Allocate and bind lighting lut textures
-    for (size_t i = 0; i < lighting_luts.size(); ++i) {
-        lighting_luts[i].Create();
-        state.lighting_luts[i].texture_1d = lighting_luts[i].handle;
-    }
+    // Allocate the lookup table buffer with the current contents of all tables. Later writes
+    // only upload the entries that changed.
+    lut_buffer.Create();
+    glBindBuffer(GL_TEXTURE_BUFFER, lut_buffer.handle);
+    glBufferData(GL_TEXTURE_BUFFER, LUT_BUFFER_SIZE, nullptr, GL_DYNAMIC_DRAW);
+    glBufferSubData(GL_TEXTURE_BUFFER, 0, sizeof(Pica::g_state.lighting.luts),
+                    Pica::g_state.lighting.luts.data());
+    glBufferSubData(GL_TEXTURE_BUFFER, FOG_LUT_OFFSET * sizeof(u32),
+                    sizeof(Pica::g_state.fog.lut), Pica::g_state.fog.lut.data());
+    Pica::g_state.lighting.dirty.Reset();
+    Pica::g_state.fog.dirty.Reset();
+
+    lut_texture.Create();
+    state.lut.texture_buffer = lut_texture.handle;
     state.Apply();
-
-    for (size_t i = 0; i < lighting_luts.size(); ++i) {
-        glActiveTexture(static_cast<GLenum>(GL_TEXTURE3 + i));
-        glTexImage1D(GL_TEXTURE_1D, 0, GL_RGBA32F, 256, 0, GL_RGBA, GL_FLOAT, nullptr);
-        glTexParameteri(GL_TEXTURE_1D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-        glTexParameteri(GL_TEXTURE_1D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-    }
-
-    // Setup the LUT for the fog
-    {
-        fog_lut.Create();
-        state.fog_lut.texture_1d = fog_lut.handle;
-    }
-    state.Apply();
-
-    glActiveTexture(GL_TEXTURE9);
-    glTexImage1D(GL_TEXTURE_1D, 0, GL_R32UI, 128, 0, GL_RED_INTEGER, GL_UNSIGNED_INT, nullptr);
-    glTexParameteri(GL_TEXTURE_1D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
-    glTexParameteri(GL_TEXTURE_1D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glActiveTexture(GL_TEXTURE3);
+    glTexBuffer(GL_TEXTURE_BUFFER, GL_R32UI, lut_buffer.handle);
 
     // Sync fixed function OpenGL state
     SyncCullMode();
@@ -135,9 +139,53 @@ RasterizerOpenGL::RasterizerOpenGL() : shader_dirty(true) {
     SyncColorWriteMask();
     SyncStencilWriteMask();
     SyncDepthWriteMask();
+
+    // The uber-shader draws while specialized shaders are generated and compiled in the
+    // background. Its configuration block is bound to binding point 1.
+    vertex_shader_source = GLShader::GenerateVertexShader();
+    uber_shader.Create(vertex_shader_source.c_str(),
+                       GLShader::GenerateUberFragmentShader().c_str());
+    SetupShaderProgram(uber_shader.handle);
+
+    unsigned int uber_block_index = glGetUniformBlockIndex(uber_shader.handle, "uber_config");
+    GLint uber_block_size;
+    glGetActiveUniformBlockiv(uber_shader.handle, uber_block_index, GL_UNIFORM_BLOCK_DATA_SIZE,
+                              &uber_block_size);
+    ASSERT_MSG(uber_block_size == sizeof(UberShaderData),
+               "Uber-shader block size did not match! Got %d, expected %zu",
+               static_cast<int>(uber_block_size), sizeof(UberShaderData));
+    glUniformBlockBinding(uber_shader.handle, uber_block_index, 1);
+
+    uber_config_buffer.Create();
+    glBindBuffer(GL_UNIFORM_BUFFER, uber_config_buffer.handle);
+    glBufferData(GL_UNIFORM_BUFFER, sizeof(UberShaderData), nullptr, GL_DYNAMIC_DRAW);
+    glBindBufferBase(GL_UNIFORM_BUFFER, 1, uber_config_buffer.handle);
+    glBindBuffer(GL_UNIFORM_BUFFER, OpenGLState::GetCurState().draw.uniform_buffer);
+
+    if (GLAD_GL_ARB_parallel_shader_compile) {
+        glMaxShaderCompilerThreadsARB(0xFFFFFFFF);
+    }
+
+    // Shaders loaded from the disk cache are used without going through a cache miss, which
+    // would otherwise have synced the uniforms
+    LoadShaderDiskCache();
+    SyncShaderUniforms();
+
+    shader_worker = std::thread(&RasterizerOpenGL::ShaderWorkerThread, this);
 }
 
-RasterizerOpenGL::~RasterizerOpenGL() {}
+RasterizerOpenGL::~RasterizerOpenGL() {
+    {
+        std::lock_guard<std::mutex> lock(shader_worker_mutex);
+        shader_worker_exit = true;
+    }
+    shader_worker_cv.notify_one();
+    shader_worker.join();
+
+    if (shader_disk_cache_dirty) {
+        shader_disk_cache.Sync();
+    }
+}
 
 /**
  * This is a helper function to resolve an issue with opposite quaternions being interpolated by
@@ -170,9 +218,42 @@ void RasterizerOpenGL::AddTriangle(const Pica::Shader::OutputVertex& v0,
 }
 
 void RasterizerOpenGL::DrawTriangles() {
+    if (vertex_batch.size() == draw_batch_vertices)
+        return;
+
+    // The draw is only queued. It is submitted together with the draws following it, right
+    // before a register it depends on is written or once its results are needed.
+    draw_batch_vertices = vertex_batch.size();
+    ++draw_stats.guest_draws;
+    MICROPROFILE_META_CPU("Guest Draws", 1);
+
+    // Upload the lookup tables while they still hold the data of the queued draws
+    SyncLUTs();
+}
+
+bool RasterizerOpenGL::IsDrawBatchAffected(u32 id, u32 value) const {
+    if (id < DRAW_BATCH_REGS_BEGIN || id >= DRAW_BATCH_REGS_END)
+        return false;
+
+    // Writes to the lookup table data ports change the tables even if the same value is written
+    if ((id >= PICA_REG_INDEX_WORKAROUND(fog_lut_data[0], 0xe8) &&
+         id <= PICA_REG_INDEX_WORKAROUND(fog_lut_data[7], 0xef)) ||
+        (id >= PICA_REG_INDEX_WORKAROUND(lighting.lut_data[0], 0x1c8) &&
+         id <= PICA_REG_INDEX_WORKAROUND(lighting.lut_data[7], 0x1cf)))
+        return true;
+
+    return Pica::g_state.regs[id] != value;
+}
+
+void RasterizerOpenGL::FlushDrawBatch() {
     if (vertex_batch.empty())
         return;
 
+    // Syncing the surfaces can flush the rasterizer again when they aren't cached yet, which must
+    // not submit the same draws. Take them out of the queue first.
+    flushing_batch.swap(vertex_batch);
+    draw_batch_vertices = 0;
+
     MICROPROFILE_SCOPE(OpenGL_Drawing);
     const auto& regs = Pica::g_state.regs;
 
@@ -263,46 +344,53 @@ void RasterizerOpenGL::DrawTriangles() {
         shader_dirty = false;
     }
 
-    // Sync the lighting luts
-    for (unsigned index = 0; index < lighting_luts.size(); index++) {
-        if (uniform_block_data.lut_dirty[index]) {
-            SyncLightingLUT(index);
-            uniform_block_data.lut_dirty[index] = false;
-        }
-    }
-
-    // Sync the fog lut
-    if (uniform_block_data.fog_lut_dirty) {
-        SyncFogLUT();
-        uniform_block_data.fog_lut_dirty = false;
-    }
+    state.Apply();
 
-    // Sync the uniform data
+    // Sync the uniform data. A new copy is appended for each change, so blocks still in use by
+    // earlier draws are never overwritten.
     if (uniform_block_data.dirty) {
-        glBufferData(GL_UNIFORM_BUFFER, sizeof(UniformData), &uniform_block_data.data,
-                     GL_STATIC_DRAW);
+        u8* uniforms;
+        GLintptr offset;
+        std::tie(uniforms, offset) =
+            uniform_buffer.Map(sizeof(UniformData), uniform_buffer_alignment);
+        std::memcpy(uniforms, &uniform_block_data.data, sizeof(UniformData));
+        uniform_buffer.Unmap(sizeof(UniformData));
+        glBindBufferRange(GL_UNIFORM_BUFFER, 0, uniform_buffer.GetHandle(), offset,
+                          sizeof(UniformData));
         uniform_block_data.dirty = false;
     }
 
-    state.Apply();
-
-    // Draw the vertex batch
-    glBufferData(GL_ARRAY_BUFFER, vertex_batch.size() * sizeof(HardwareVertex), vertex_batch.data(),
-                 GL_STREAM_DRAW);
-    glDrawArrays(GL_TRIANGLES, 0, (GLsizei)vertex_batch.size());
+    // Draw the vertex batch, split into several draws if it does not fit the stream buffer
+    const size_t max_vertices = VERTEX_BUFFER_SIZE / sizeof(HardwareVertex) / 3 * 3;
+    for (size_t first = 0; first < flushing_batch.size(); first += max_vertices) {
+        const size_t count = std::min(flushing_batch.size() - first, max_vertices);
+        const GLsizeiptr size = static_cast<GLsizeiptr>(count * sizeof(HardwareVertex));
+
+        u8* vertices;
+        GLintptr offset;
+        std::tie(vertices, offset) = vertex_buffer.Map(size, sizeof(HardwareVertex));
+        std::memcpy(vertices, flushing_batch.data() + first, size);
+        vertex_buffer.Unmap(size);
+
+        // Offsets are aligned to the vertex size so the attribute pointers never need to change
+        glDrawArrays(GL_TRIANGLES, static_cast<GLint>(offset / sizeof(HardwareVertex)),
+                     static_cast<GLsizei>(count));
+        ++draw_stats.host_draws;
+        MICROPROFILE_META_CPU("Host Draws", 1);
+    }
 
     // Mark framebuffer surfaces as dirty
     // TODO: Restrict invalidation area to the viewport
     if (color_surface != nullptr) {
-        color_surface->dirty = true;
+        res_cache.MarkSurfaceDirty(color_surface);
         res_cache.FlushRegion(color_surface->addr, color_surface->size, color_surface, true);
     }
     if (depth_surface != nullptr) {
-        depth_surface->dirty = true;
+        res_cache.MarkSurfaceDirty(depth_surface);
         res_cache.FlushRegion(depth_surface->addr, depth_surface->size, depth_surface, true);
     }
 
-    vertex_batch.clear();
+    flushing_batch.clear();
 
     // Unbind textures for potential future use as framebuffer attachments
     for (unsigned texture_index = 0; texture_index < pica_textures.size(); ++texture_index) {
@@ -311,6 +399,12 @@ void RasterizerOpenGL::DrawTriangles() {
     state.Apply();
 }
 
+void RasterizerOpenGL::NotifyPicaRegisterWrite(u32 id, u32 value) {
+    if (draw_batch_vertices != 0 && IsDrawBatchAffected(id, value)) {
+        FlushDrawBatch();
+    }
+}
+
 void RasterizerOpenGL::NotifyPicaRegisterChanged(u32 id) {
     const auto& regs = Pica::g_state.regs;
 
@@ -348,16 +442,6 @@ void RasterizerOpenGL::NotifyPicaRegisterChanged(u32 id) {
     case PICA_REG_INDEX(fog_color):
         SyncFogColor();
         break;
-    case PICA_REG_INDEX_WORKAROUND(fog_lut_data[0], 0xe8):
-    case PICA_REG_INDEX_WORKAROUND(fog_lut_data[1], 0xe9):
-    case PICA_REG_INDEX_WORKAROUND(fog_lut_data[2], 0xea):
-    case PICA_REG_INDEX_WORKAROUND(fog_lut_data[3], 0xeb):
-    case PICA_REG_INDEX_WORKAROUND(fog_lut_data[4], 0xec):
-    case PICA_REG_INDEX_WORKAROUND(fog_lut_data[5], 0xed):
-    case PICA_REG_INDEX_WORKAROUND(fog_lut_data[6], 0xee):
-    case PICA_REG_INDEX_WORKAROUND(fog_lut_data[7], 0xef):
-        uniform_block_data.fog_lut_dirty = true;
-        break;
 
     // Alpha test
     case PICA_REG_INDEX(output_merger.alpha_test):
@@ -682,39 +766,48 @@ void RasterizerOpenGL::NotifyPicaRegisterChanged(u32 id) {
     case PICA_REG_INDEX_WORKAROUND(lighting.global_ambient, 0x1c0):
         SyncGlobalAmbient();
         break;
-
-    // Fragment lighting lookup tables
-    case PICA_REG_INDEX_WORKAROUND(lighting.lut_data[0], 0x1c8):
-    case PICA_REG_INDEX_WORKAROUND(lighting.lut_data[1], 0x1c9):
-    case PICA_REG_INDEX_WORKAROUND(lighting.lut_data[2], 0x1ca):
-    case PICA_REG_INDEX_WORKAROUND(lighting.lut_data[3], 0x1cb):
-    case PICA_REG_INDEX_WORKAROUND(lighting.lut_data[4], 0x1cc):
-    case PICA_REG_INDEX_WORKAROUND(lighting.lut_data[5], 0x1cd):
-    case PICA_REG_INDEX_WORKAROUND(lighting.lut_data[6], 0x1ce):
-    case PICA_REG_INDEX_WORKAROUND(lighting.lut_data[7], 0x1cf): {
-        auto& lut_config = regs.lighting.lut_config;
-        uniform_block_data.lut_dirty[lut_config.type / 4] = true;
-        break;
-    }
     }
 }
 
 void RasterizerOpenGL::FlushAll() {
+    FlushDrawBatch();
     MICROPROFILE_SCOPE(OpenGL_CacheManagement);
     res_cache.FlushAll();
 }
 
 void RasterizerOpenGL::FlushRegion(PAddr addr, u32 size) {
+    FlushDrawBatch();
     MICROPROFILE_SCOPE(OpenGL_CacheManagement);
     res_cache.FlushRegion(addr, size, nullptr, false);
 }
 
 void RasterizerOpenGL::FlushAndInvalidateRegion(PAddr addr, u32 size) {
+    FlushDrawBatch();
     MICROPROFILE_SCOPE(OpenGL_CacheManagement);
     res_cache.FlushRegion(addr, size, nullptr, true);
 }
 
+void RasterizerOpenGL::NotifyFrameFinished() {
+    FlushDrawBatch();
+    MICROPROFILE_SCOPE(OpenGL_CacheManagement);
+    res_cache.FinishFrame();
+    ProcessPendingShaders(true);
+
+    LOG_TRACE(Render_OpenGL, "Draws: %u triggered by the PICA, %u submitted to OpenGL",
+              draw_stats.guest_draws, draw_stats.host_draws);
+    g_debugger.FrameDrawStatsUpdated(draw_stats.guest_draws, draw_stats.host_draws);
+    draw_stats = {};
+
+    const auto& surface_stats = res_cache.GetPreviousFrameStats();
+    LOG_TRACE(Render_OpenGL, "Surfaces: %u hits, %u uploads, %u reuses, %u evictions",
+              surface_stats.hits, surface_stats.uploads, surface_stats.reuses,
+              surface_stats.evictions);
+    g_debugger.FrameSurfaceStatsUpdated(surface_stats.hits, surface_stats.uploads,
+                                        surface_stats.reuses, surface_stats.evictions);
+}
+
 bool RasterizerOpenGL::AccelerateDisplayTransfer(const GPU::Regs::DisplayTransferConfig& config) {
+    FlushDrawBatch();
     MICROPROFILE_SCOPE(OpenGL_Blits);
     using PixelFormat = CachedSurface::PixelFormat;
     using SurfaceType = CachedSurface::SurfaceType;
@@ -777,7 +870,7 @@ bool RasterizerOpenGL::AccelerateDisplayTransfer(const GPU::Regs::DisplayTransfe
 
     u32 dst_size = dst_params.width * dst_params.height *
                    CachedSurface::GetFormatBpp(dst_params.pixel_format) / 8;
-    dst_surface->dirty = true;
+    res_cache.MarkSurfaceDirty(dst_surface);
     res_cache.FlushRegion(config.GetPhysicalOutputAddress(), dst_size, dst_surface, true);
     return true;
 }
@@ -788,6 +881,7 @@ bool RasterizerOpenGL::AccelerateTextureCopy(const GPU::Regs::DisplayTransferCon
 }
 
 bool RasterizerOpenGL::AccelerateFill(const GPU::Regs::MemoryFillConfig& config) {
+    FlushDrawBatch();
     MICROPROFILE_SCOPE(OpenGL_Blits);
     using PixelFormat = CachedSurface::PixelFormat;
     using SurfaceType = CachedSurface::SurfaceType;
@@ -926,7 +1020,7 @@ bool RasterizerOpenGL::AccelerateFill(const GPU::Regs::MemoryFillConfig& config)
     // TODO: Return scissor test to previous value when scissor test is implemented
     cur_state.Apply();
 
-    dst_surface->dirty = true;
+    res_cache.MarkSurfaceDirty(dst_surface);
     res_cache.FlushRegion(dst_surface->addr, dst_surface->size, dst_surface, true);
     return true;
 }
@@ -934,6 +1028,8 @@ bool RasterizerOpenGL::AccelerateFill(const GPU::Regs::MemoryFillConfig& config)
 bool RasterizerOpenGL::AccelerateDisplay(const GPU::Regs::FramebufferConfig& config,
                                          PAddr framebuffer_addr, u32 pixel_stride,
                                          ScreenInfo& screen_info) {
+    FlushDrawBatch();
+
     if (framebuffer_addr == 0) {
         return false;
     }
@@ -1008,103 +1104,319 @@ void RasterizerOpenGL::SamplerInfo::SyncWithConfig(const Pica::Regs::TextureConf
 }
 
 void RasterizerOpenGL::SetShader() {
+    ProcessPendingShaders(false);
+
     PicaShaderConfig config = PicaShaderConfig::CurrentConfig();
-    std::unique_ptr<PicaShader> shader = std::make_unique<PicaShader>();
 
-    // Find (or generate) the GLSL shader for the current TEV state
+    // Find the GLSL shader for the current TEV state, or request it from the worker thread
     auto cached_shader = shader_cache.find(config);
-    if (cached_shader != shader_cache.end()) {
-        current_shader = cached_shader->second.get();
+    if (cached_shader == shader_cache.end()) {
+        LOG_DEBUG(Render_OpenGL, "Creating new shader");
+
+        cached_shader = shader_cache.emplace(config, std::make_unique<PicaShader>()).first;
+        {
+            std::lock_guard<std::mutex> lock(shader_worker_mutex);
+            shader_generate_queue.push_back(config);
+        }
+        shader_worker_cv.notify_one();
+
+        SyncShaderUniforms();
+    }
 
+    if (cached_shader->second->ready) {
+        MICROPROFILE_META_CPU("Shader Cache Hit", 1);
+        current_shader = cached_shader->second.get();
         state.draw.shader_program = current_shader->shader.handle;
-        state.Apply();
     } else {
-        LOG_DEBUG(Render_OpenGL, "Creating new shader");
+        // Draw with the uber-shader until the specialized shader is built
+        MICROPROFILE_META_CPU("Shader Cache Miss", 1);
+        current_shader = nullptr;
+        SyncUberShaderConfig(config);
+        state.draw.shader_program = uber_shader.handle;
+    }
+    state.Apply();
+}
 
-        shader->shader.Create(GLShader::GenerateVertexShader().c_str(),
-                              GLShader::GenerateFragmentShader(config).c_str());
+void RasterizerOpenGL::SyncShaderUniforms() {
+    SyncDepthScale();
+    SyncDepthOffset();
+    SyncAlphaTest();
+    SyncCombinerColor();
+    auto& tev_stages = Pica::g_state.regs.GetTevStages();
+    for (int index = 0; index < tev_stages.size(); ++index)
+        SyncTevConstColor(index, tev_stages[index]);
+
+    SyncGlobalAmbient();
+    for (int light_index = 0; light_index < 8; light_index++) {
+        SyncLightSpecular0(light_index);
+        SyncLightSpecular1(light_index);
+        SyncLightDiffuse(light_index);
+        SyncLightAmbient(light_index);
+        SyncLightPosition(light_index);
+        SyncLightDistanceAttenuationBias(light_index);
+        SyncLightDistanceAttenuationScale(light_index);
+    }
 
-        state.draw.shader_program = shader->shader.handle;
-        state.Apply();
+    SyncFogColor();
+}
 
-        // Set the texture samplers to correspond to different texture units
-        GLuint uniform_tex = glGetUniformLocation(shader->shader.handle, "tex[0]");
-        if (uniform_tex != -1) {
-            glUniform1i(uniform_tex, 0);
-        }
-        uniform_tex = glGetUniformLocation(shader->shader.handle, "tex[1]");
-        if (uniform_tex != -1) {
-            glUniform1i(uniform_tex, 1);
-        }
-        uniform_tex = glGetUniformLocation(shader->shader.handle, "tex[2]");
-        if (uniform_tex != -1) {
-            glUniform1i(uniform_tex, 2);
-        }
+void RasterizerOpenGL::SetupShaderProgram(GLuint program) {
+    GLuint old_program = state.draw.shader_program;
+    state.draw.shader_program = program;
+    state.Apply();
 
-        // Set the texture samplers to correspond to different lookup table texture units
-        GLuint uniform_lut = glGetUniformLocation(shader->shader.handle, "lut[0]");
-        if (uniform_lut != -1) {
-            glUniform1i(uniform_lut, 3);
-        }
-        uniform_lut = glGetUniformLocation(shader->shader.handle, "lut[1]");
-        if (uniform_lut != -1) {
-            glUniform1i(uniform_lut, 4);
-        }
-        uniform_lut = glGetUniformLocation(shader->shader.handle, "lut[2]");
-        if (uniform_lut != -1) {
-            glUniform1i(uniform_lut, 5);
-        }
-        uniform_lut = glGetUniformLocation(shader->shader.handle, "lut[3]");
-        if (uniform_lut != -1) {
-            glUniform1i(uniform_lut, 6);
-        }
-        uniform_lut = glGetUniformLocation(shader->shader.handle, "lut[4]");
-        if (uniform_lut != -1) {
-            glUniform1i(uniform_lut, 7);
+    // Set the texture samplers to correspond to different texture units
+    GLuint uniform_tex = glGetUniformLocation(program, "tex[0]");
+    if (uniform_tex != -1) {
+        glUniform1i(uniform_tex, 0);
+    }
+    uniform_tex = glGetUniformLocation(program, "tex[1]");
+    if (uniform_tex != -1) {
+        glUniform1i(uniform_tex, 1);
+    }
+    uniform_tex = glGetUniformLocation(program, "tex[2]");
+    if (uniform_tex != -1) {
+        glUniform1i(uniform_tex, 2);
+    }
+
+    // Set the texture samplers to correspond to different lookup table texture units
+    GLuint uniform_lut = glGetUniformLocation(program, "lut");
+    if (uniform_lut != -1) {
+        glUniform1i(uniform_lut, 3);
+    }
+
+    unsigned int block_index = glGetUniformBlockIndex(program, "shader_data");
+    GLint block_size;
+    glGetActiveUniformBlockiv(program, block_index, GL_UNIFORM_BLOCK_DATA_SIZE, &block_size);
+    ASSERT_MSG(block_size == sizeof(UniformData),
+               "Uniform block size did not match! Got %d, expected %zu",
+               static_cast<int>(block_size), sizeof(UniformData));
+    glUniformBlockBinding(program, block_index, 0);
+
+    state.draw.shader_program = old_program;
+    state.Apply();
+}
+
+void RasterizerOpenGL::SyncUberShaderConfig(const PicaShaderConfig& config) {
+    if (uber_config_valid && config == uber_shader_config) {
+        return;
+    }
+    uber_shader_config = config;
+    uber_config_valid = true;
+
+    const auto& shader_state = config.state;
+    const auto& lighting = shader_state.lighting;
+
+    UberShaderData data = {};
+    for (size_t i = 0; i < shader_state.tev_stages.size(); ++i) {
+        const auto& stage = shader_state.tev_stages[i];
+        data.tev_stages[i] = {stage.sources_raw, stage.modifiers_raw, stage.ops_raw,
+                              stage.scales_raw};
+    }
+    data.alpha_test_func = static_cast<GLint>(shader_state.alpha_test_func);
+    data.scissor_test_mode = static_cast<GLint>(shader_state.scissor_test_mode);
+    data.texture0_type = static_cast<GLint>(shader_state.texture0_type);
+    data.combiner_buffer_input = shader_state.combiner_buffer_input;
+    data.w_buffering = shader_state.depthmap_enable == Pica::Regs::DepthBuffering::WBuffering;
+    data.fog_enable = shader_state.fog_mode == Pica::Regs::FogMode::Fog;
+    data.fog_flip = shader_state.fog_flip;
+
+    data.lighting_enable = lighting.enable;
+    data.lighting_src_num = lighting.src_num;
+    data.lighting_bump_mode = static_cast<GLint>(lighting.bump_mode);
+    data.lighting_bump_selector = lighting.bump_selector;
+    data.lighting_bump_renorm = lighting.bump_renorm;
+    data.lighting_clamp_highlights = lighting.clamp_highlights;
+    data.lighting_fresnel_selector = static_cast<GLint>(lighting.fresnel_selector);
+    for (size_t i = 0; i < 8; ++i) {
+        const auto& light = lighting.light[i];
+        data.lighting_lights[i] = {static_cast<GLint>(light.num), light.directional,
+                                   light.two_sided_diffuse, light.dist_atten_enable};
+    }
+
+    // LUTs are only used if enabled and available in the lighting configuration
+    auto sync_lut = [&](size_t index, const auto& lut, Pica::Regs::LightingSampler sampler) {
+        bool enable = lighting.enable && lut.enable &&
+                      Pica::Regs::IsLightingSamplerSupported(lighting.config, sampler);
+        data.lighting_luts[index] = {enable, lut.abs_input, static_cast<GLint>(lut.type), 0};
+        data.lighting_lut_scales[index] = {lut.scale, 0.0f, 0.0f, 0.0f};
+    };
+    sync_lut(0, lighting.lut_d0, Pica::Regs::LightingSampler::Distribution0);
+    sync_lut(1, lighting.lut_d1, Pica::Regs::LightingSampler::Distribution1);
+    sync_lut(2, lighting.lut_fr, Pica::Regs::LightingSampler::Fresnel);
+    sync_lut(3, lighting.lut_rr, Pica::Regs::LightingSampler::ReflectRed);
+    sync_lut(4, lighting.lut_rg, Pica::Regs::LightingSampler::ReflectGreen);
+    sync_lut(5, lighting.lut_rb, Pica::Regs::LightingSampler::ReflectBlue);
+
+    glBindBuffer(GL_UNIFORM_BUFFER, uber_config_buffer.handle);
+    glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(UberShaderData), &data);
+    glBindBuffer(GL_UNIFORM_BUFFER, OpenGLState::GetCurState().draw.uniform_buffer);
+}
+
+MICROPROFILE_DEFINE(OpenGL_ShaderCompilation, "OpenGL", "Shader Compilation",
+                    MP_RGB(192, 128, 64));
+void RasterizerOpenGL::ProcessPendingShaders(bool frame_finished) {
+    std::vector<std::pair<PicaShaderConfig, std::string>> sources;
+    {
+        std::lock_guard<std::mutex> lock(shader_worker_mutex);
+        sources.swap(generated_shaders);
+    }
+
+    for (const auto& source : sources) {
+        MICROPROFILE_SCOPE(OpenGL_ShaderCompilation);
+
+        PicaShader* shader = shader_cache.at(source.first).get();
+        shader->shader.handle = GLShader::CreateProgramAsync(
+            vertex_shader_source.c_str(), source.second.c_str(), shader_disk_cache_enabled);
+        linking_shaders.emplace_back(source.first, shader);
+    }
+
+    if (!frame_finished && !GLAD_GL_ARB_parallel_shader_compile) {
+        return;
+    }
+
+    for (size_t i = 0; i < linking_shaders.size();) {
+        PicaShader* shader = linking_shaders[i].second;
+        if (!GLShader::IsProgramLinkDone(shader->shader.handle)) {
+            ++i;
+            continue;
         }
-        uniform_lut = glGetUniformLocation(shader->shader.handle, "lut[5]");
-        if (uniform_lut != -1) {
-            glUniform1i(uniform_lut, 8);
+
+        MICROPROFILE_SCOPE(OpenGL_ShaderCompilation);
+        if (GLShader::CheckProgramLinked(shader->shader.handle)) {
+            SetupShaderProgram(shader->shader.handle);
+            shader->ready = true;
+            if (shader_disk_cache_enabled) {
+                StoreShaderBinary(linking_shaders[i].first, shader->shader.handle);
+            }
+            // Switch to the new shader on the next draw
+            shader_dirty = true;
+        } else {
+            // The configuration keeps being drawn with the uber-shader
+            shader->shader.Release();
         }
 
-        GLuint uniform_fog_lut = glGetUniformLocation(shader->shader.handle, "fog_lut");
-        if (uniform_fog_lut != -1) {
-            glUniform1i(uniform_fog_lut, 9);
+        linking_shaders[i] = linking_shaders.back();
+        linking_shaders.pop_back();
+    }
+
+    if (frame_finished && shader_disk_cache_dirty) {
+        shader_disk_cache.Sync();
+        shader_disk_cache_dirty = false;
+    }
+}
+
+void RasterizerOpenGL::LoadShaderDiskCache() {
+    GLint num_binary_formats = 0;
+    if (GLAD_GL_ARB_get_program_binary) {
+        glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &num_binary_formats);
+    }
+    if (num_binary_formats == 0) {
+        LOG_INFO(Render_OpenGL, "Driver doesn't support program binaries, not caching shaders");
+        return;
+    }
+
+    const std::string cache_dir = FileUtil::GetUserPath(D_CACHE_IDX);
+    if (!FileUtil::CreateFullPath(cache_dir)) {
+        LOG_ERROR(Render_OpenGL, "Unable to create shader cache directory %s", cache_dir.c_str());
+        return;
+    }
+
+    // Binaries are only valid for the driver that created them
+    std::string driver = reinterpret_cast<const char*>(glGetString(GL_VENDOR));
+    driver += '\n';
+    driver += reinterpret_cast<const char*>(glGetString(GL_RENDERER));
+    driver += '\n';
+    driver += reinterpret_cast<const char*>(glGetString(GL_VERSION));
+    driver_hash = Common::ComputeHash64(driver.data(), driver.size());
+
+    class BinaryReader : public LinearDiskCacheReader<ShaderBinaryKey, u8> {
+    public:
+        explicit BinaryReader(RasterizerOpenGL& rasterizer) : rasterizer(rasterizer) {}
+
+        void Read(const ShaderBinaryKey& key, const u8* value, u32 value_size) override {
+            if (key.driver_hash != rasterizer.driver_hash ||
+                rasterizer.shader_cache.count(key.config) != 0) {
+                return;
+            }
+
+            auto shader = std::make_unique<PicaShader>();
+            shader->shader.handle = glCreateProgram();
+            glProgramBinary(shader->shader.handle, key.binary_format, value, value_size);
+
+            // The driver may reject binaries of an older version of itself
+            GLint result = GL_FALSE;
+            glGetProgramiv(shader->shader.handle, GL_LINK_STATUS, &result);
+            if (result != GL_TRUE) {
+                ++num_rejected;
+                return;
+            }
+
+            rasterizer.SetupShaderProgram(shader->shader.handle);
+            shader->ready = true;
+            rasterizer.shader_cache.emplace(key.config, std::move(shader));
+            ++num_loaded;
         }
 
-        current_shader = shader_cache.emplace(config, std::move(shader)).first->second.get();
+        u32 num_loaded = 0;
+        u32 num_rejected = 0;
 
-        unsigned int block_index =
-            glGetUniformBlockIndex(current_shader->shader.handle, "shader_data");
-        GLint block_size;
-        glGetActiveUniformBlockiv(current_shader->shader.handle, block_index,
-                                  GL_UNIFORM_BLOCK_DATA_SIZE, &block_size);
-        ASSERT_MSG(block_size == sizeof(UniformData),
-                   "Uniform block size did not match! Got %d, expected %zu",
-                   static_cast<int>(block_size), sizeof(UniformData));
-        glUniformBlockBinding(current_shader->shader.handle, block_index, 0);
+    private:
+        RasterizerOpenGL& rasterizer;
+    };
 
-        // Update uniforms
-        SyncDepthScale();
-        SyncDepthOffset();
-        SyncAlphaTest();
-        SyncCombinerColor();
-        auto& tev_stages = Pica::g_state.regs.GetTevStages();
-        for (int index = 0; index < tev_stages.size(); ++index)
-            SyncTevConstColor(index, tev_stages[index]);
+    BinaryReader reader(*this);
+    shader_disk_cache.OpenAndRead((cache_dir + "opengl_shaders.bin").c_str(), reader);
+    shader_disk_cache_enabled = true;
 
-        SyncGlobalAmbient();
-        for (int light_index = 0; light_index < 8; light_index++) {
-            SyncLightSpecular0(light_index);
-            SyncLightSpecular1(light_index);
-            SyncLightDiffuse(light_index);
-            SyncLightAmbient(light_index);
-            SyncLightPosition(light_index);
-            SyncLightDistanceAttenuationBias(light_index);
-            SyncLightDistanceAttenuationScale(light_index);
+    LOG_INFO(Render_OpenGL, "Loaded %u shaders from the disk cache, %u rejected by the driver",
+             reader.num_loaded, reader.num_rejected);
+}
+
+void RasterizerOpenGL::StoreShaderBinary(const PicaShaderConfig& config, GLuint program) {
+    GLint binary_length = 0;
+    glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &binary_length);
+    if (binary_length <= 0) {
+        return;
+    }
+
+    // Zero the padding bytes, which are written to the file as well
+    ShaderBinaryKey key;
+    std::memset(&key, 0, sizeof(key));
+    key.driver_hash = driver_hash;
+    key.config = config;
+
+    std::vector<u8> binary(binary_length);
+    glGetProgramBinary(program, binary_length, &binary_length, &key.binary_format, binary.data());
+
+    shader_disk_cache.Append(key, binary.data(), static_cast<u32>(binary_length));
+    shader_disk_cache_dirty = true;
+}
+
+MICROPROFILE_DEFINE(OpenGL_ShaderGeneration, "OpenGL", "Shader Generation", MP_RGB(160, 96, 64));
+void RasterizerOpenGL::ShaderWorkerThread() {
+    MicroProfileOnThreadCreate("ShaderWorker");
+
+    std::unique_lock<std::mutex> lock(shader_worker_mutex);
+    while (true) {
+        shader_worker_cv.wait(
+            lock, [this] { return shader_worker_exit || !shader_generate_queue.empty(); });
+        if (shader_worker_exit) {
+            return;
         }
 
-        SyncFogColor();
+        PicaShaderConfig config = shader_generate_queue.front();
+        shader_generate_queue.pop_front();
+        lock.unlock();
+
+        std::string source;
+        {
+            MICROPROFILE_SCOPE(OpenGL_ShaderGeneration);
+            source = GLShader::GenerateFragmentShader(config);
+        }
+
+        lock.lock();
+        generated_shaders.emplace_back(config, std::move(source));
     }
 }
 
@@ -1185,20 +1497,6 @@ void RasterizerOpenGL::SyncFogColor() {
     uniform_block_data.dirty = true;
 }
 
-void RasterizerOpenGL::SyncFogLUT() {
-    std::array<GLuint, 128> new_data;
-
-    std::transform(Pica::g_state.fog.lut.begin(), Pica::g_state.fog.lut.end(), new_data.begin(),
-                   [](const auto& entry) { return entry.raw; });
-
-    if (new_data != fog_lut_data) {
-        fog_lut_data = new_data;
-        glActiveTexture(GL_TEXTURE9);
-        glTexSubImage1D(GL_TEXTURE_1D, 0, 0, 128, GL_RED_INTEGER, GL_UNSIGNED_INT,
-                        fog_lut_data.data());
-    }
-}
-
 void RasterizerOpenGL::SyncAlphaTest() {
     const auto& regs = Pica::g_state.regs;
     if (regs.output_merger.alpha_test.ref != uniform_block_data.data.alphatest_ref) {
@@ -1288,21 +1586,29 @@ void RasterizerOpenGL::SyncGlobalAmbient() {
     }
 }
 
-void RasterizerOpenGL::SyncLightingLUT(unsigned lut_index) {
-    std::array<GLvec4, 256> new_data;
+void RasterizerOpenGL::SyncLUTs() {
+    auto& lighting = Pica::g_state.lighting;
+    auto& fog = Pica::g_state.fog;
+    if (lighting.dirty.IsEmpty() && fog.dirty.IsEmpty())
+        return;
+
+    MICROPROFILE_SCOPE(OpenGL_LUTUpload);
+    glBindBuffer(GL_TEXTURE_BUFFER, lut_buffer.handle);
 
-    for (unsigned offset = 0; offset < new_data.size(); ++offset) {
-        new_data[offset][0] = Pica::g_state.lighting.luts[(lut_index * 4) + 0][offset].ToFloat();
-        new_data[offset][1] = Pica::g_state.lighting.luts[(lut_index * 4) + 1][offset].ToFloat();
-        new_data[offset][2] = Pica::g_state.lighting.luts[(lut_index * 4) + 2][offset].ToFloat();
-        new_data[offset][3] = Pica::g_state.lighting.luts[(lut_index * 4) + 3][offset].ToFloat();
+    if (!lighting.dirty.IsEmpty()) {
+        const u32* entries = &lighting.luts[0][0].raw;
+        glBufferSubData(GL_TEXTURE_BUFFER, lighting.dirty.begin * sizeof(u32),
+                        (lighting.dirty.end - lighting.dirty.begin) * sizeof(u32),
+                        entries + lighting.dirty.begin);
+        lighting.dirty.Reset();
     }
 
-    if (new_data != lighting_lut_data[lut_index]) {
-        lighting_lut_data[lut_index] = new_data;
-        glActiveTexture(GL_TEXTURE3 + lut_index);
-        glTexSubImage1D(GL_TEXTURE_1D, 0, 0, 256, GL_RGBA, GL_FLOAT,
-                        lighting_lut_data[lut_index].data());
+    if (!fog.dirty.IsEmpty()) {
+        const u32* entries = &fog.lut[0].raw;
+        glBufferSubData(GL_TEXTURE_BUFFER, (FOG_LUT_OFFSET + fog.dirty.begin) * sizeof(u32),
+                        (fog.dirty.end - fog.dirty.begin) * sizeof(u32),
+                        entries + fog.dirty.begin);
+        fog.dirty.Reset();
     }
 }
 
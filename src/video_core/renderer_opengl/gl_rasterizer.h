@@ -5,15 +5,22 @@
 #pragma once
 
 #include <array>
+#include <condition_variable>
 #include <cstddef>
 #include <cstring>
+#include <deque>
 #include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
 #include <unordered_map>
+#include <utility>
 #include <vector>
 #include <glad/glad.h>
 #include "common/bit_field.h"
 #include "common/common_types.h"
 #include "common/hash.h"
+#include "common/linear_disk_cache.h"
 #include "common/vector_math.h"
 #include "core/hw/gpu.h"
 #include "video_core/pica.h"
@@ -233,10 +240,13 @@ public:
     void AddTriangle(const Pica::Shader::OutputVertex& v0, const Pica::Shader::OutputVertex& v1,
                      const Pica::Shader::OutputVertex& v2) override;
     void DrawTriangles() override;
+    void FlushDrawBatch() override;
+    void NotifyPicaRegisterWrite(u32 id, u32 value) override;
     void NotifyPicaRegisterChanged(u32 id) override;
     void FlushAll() override;
     void FlushRegion(PAddr addr, u32 size) override;
     void FlushAndInvalidateRegion(PAddr addr, u32 size) override;
+    void NotifyFrameFinished() override;
     bool AccelerateDisplayTransfer(const GPU::Regs::DisplayTransferConfig& config) override;
     bool AccelerateTextureCopy(const GPU::Regs::DisplayTransferConfig& config) override;
     bool AccelerateFill(const GPU::Regs::MemoryFillConfig& config) override;
@@ -245,8 +255,10 @@ public:
 
     /// OpenGL shader generated for a given Pica register state
     struct PicaShader {
-        /// OpenGL shader resource
+        /// OpenGL shader resource, created once the worker thread has generated the source
         OGLShader shader;
+        /// Whether the program has finished linking and can be drawn with
+        bool ready = false;
     };
 
 private:
@@ -348,9 +360,75 @@ private:
     static_assert(sizeof(UniformData) < 16384,
                   "UniformData structure must be less than 16kb as per the OpenGL spec");
 
-    /// Sets the OpenGL shader in accordance with the current PICA register state
+    /// Uniform structure for the uber-shader's configuration block, holding the state the
+    /// specialized shaders are generated from
+    struct UberShaderData {
+        std::array<GLuint, 4> tev_stages[6];
+        GLint alpha_test_func;
+        GLint scissor_test_mode;
+        GLint texture0_type;
+        GLint combiner_buffer_input;
+        GLint w_buffering;
+        GLint fog_enable;
+        GLint fog_flip;
+        GLint lighting_enable;
+        GLint lighting_src_num;
+        GLint lighting_bump_mode;
+        GLint lighting_bump_selector;
+        GLint lighting_bump_renorm;
+        GLint lighting_clamp_highlights;
+        GLint lighting_fresnel_selector;
+        alignas(16) std::array<GLint, 4> lighting_lights[8];
+        alignas(16) std::array<GLint, 4> lighting_luts[6];
+        alignas(16) GLvec4 lighting_lut_scales[6];
+    };
+
+    static_assert(
+        sizeof(UberShaderData) == 0x1E0,
+        "The size of the UberShaderData structure has changed, update the structure in the shader");
+
+    /// Checks whether writing the value to the register changes the state the queued draws were
+    /// made with. Must be called before the register is written.
+    bool IsDrawBatchAffected(u32 id, u32 value) const;
+
+    /// Sets the OpenGL shader in accordance with the current PICA register state. Uses the
+    /// uber-shader until the specialized shader for the state has been built.
     void SetShader();
 
+    /// Syncs all uniforms read by the fragment shaders to match the PICA registers
+    void SyncShaderUniforms();
+
+    /// Binds the texture units and uniform blocks of a newly linked shader program
+    void SetupShaderProgram(GLuint program);
+
+    /// Uploads the configuration of the uber-shader for the given state
+    void SyncUberShaderConfig(const PicaShaderConfig& config);
+
+    /// Key of a program binary in the shader disk cache
+    struct ShaderBinaryKey {
+        /// Hash of the OpenGL vendor, renderer and version strings
+        u64 driver_hash;
+        /// Format of the program binary, as returned by glGetProgramBinary
+        GLenum binary_format;
+        PicaShaderConfig config;
+    };
+
+    /// Opens the shader disk cache and adds the programs built by the current driver to the
+    /// shader cache, so that they don't have to be compiled again
+    void LoadShaderDiskCache();
+
+    /// Appends the binary of a successfully linked program to the shader disk cache. The file is
+    /// synced once the frame is finished.
+    void StoreShaderBinary(const PicaShaderConfig& config, GLuint program);
+
+    /// Starts compiling the shader sources generated by the worker thread, and makes the shaders
+    /// that finished linking available. Without ARB_parallel_shader_compile, link results are
+    /// only collected at the end of a frame, giving the driver time to compile in the background.
+    void ProcessPendingShaders(bool frame_finished);
+
+    /// Generates the sources of specialized fragment shaders requested by SetShader
+    void ShaderWorkerThread();
+
     /// Syncs the cull mode to match the PICA register
     void SyncCullMode();
 
@@ -371,7 +449,6 @@ private:
 
     /// Syncs the fog states to match the PICA register
     void SyncFogColor();
-    void SyncFogLUT();
 
     /// Syncs the alpha test states to match the PICA register
     void SyncAlphaTest();
@@ -403,8 +480,8 @@ private:
     /// Syncs the lighting global ambient color to match the PICA register
     void SyncGlobalAmbient();
 
-    /// Syncs the lighting lookup tables
-    void SyncLightingLUT(unsigned index);
+    /// Uploads the lighting and fog lookup table entries written since the last upload
+    void SyncLUTs();
 
     /// Syncs the specified light's specular 0 color to match the PICA register
     void SyncLightSpecular0(int light_index);
@@ -432,27 +509,66 @@ private:
     RasterizerCacheOpenGL res_cache;
 
     std::vector<HardwareVertex> vertex_batch;
+    /// Vertices of the draws being submitted by FlushDrawBatch
+    std::vector<HardwareVertex> flushing_batch;
+
+    /// Range of registers that affect how queued vertices are drawn. The vertex processing
+    /// registers following it only affect vertices that haven't been queued yet.
+    static constexpr u32 DRAW_BATCH_REGS_BEGIN = PICA_REG_INDEX(cull_mode);
+    static constexpr u32 DRAW_BATCH_REGS_END = PICA_REG_INDEX(vertex_attributes);
+    /// Number of vertices in vertex_batch belonging to queued draws
+    size_t draw_batch_vertices = 0;
+
+    /// Draw statistics of the current frame, reported to the graphics debugger when it finishes
+    struct DrawStats {
+        /// Draws triggered by the PICA
+        u32 guest_draws = 0;
+        /// Draw calls submitted to OpenGL after merging consecutive draws
+        u32 host_draws = 0;
+    } draw_stats;
 
     std::unordered_map<PicaShaderConfig, std::unique_ptr<PicaShader>> shader_cache;
     const PicaShader* current_shader = nullptr;
     bool shader_dirty;
 
+    std::string vertex_shader_source;
+    OGLShader uber_shader;
+    OGLBuffer uber_config_buffer;
+    /// Configuration currently held by uber_config_buffer
+    PicaShaderConfig uber_shader_config;
+    bool uber_config_valid = false;
+    /// Shaders whose programs are being compiled and linked by the driver
+    std::vector<std::pair<PicaShaderConfig, PicaShader*>> linking_shaders;
+
+    /// Whether program binaries are read from and written to shader_disk_cache
+    bool shader_disk_cache_enabled = false;
+    /// Whether binaries were appended to shader_disk_cache since it was last synced
+    bool shader_disk_cache_dirty = false;
+    u64 driver_hash = 0;
+    LinearDiskCache<ShaderBinaryKey, u8> shader_disk_cache;
+
+    std::thread shader_worker;
+    std::mutex shader_worker_mutex;
+    std::condition_variable shader_worker_cv;
+    /// Configurations whose fragment shader source has to be generated
+    std::deque<PicaShaderConfig> shader_generate_queue;
+    /// Generated fragment shader sources waiting to be compiled
+    std::vector<std::pair<PicaShaderConfig, std::string>> generated_shaders;
+    bool shader_worker_exit = false;
+
     struct {
         UniformData data;
-        bool lut_dirty[6];
-        bool fog_lut_dirty;
         bool dirty;
     } uniform_block_data = {};
 
     std::array<SamplerInfo, 3> texture_samplers;
     OGLVertexArray vertex_array;
-    OGLBuffer vertex_buffer;
-    OGLBuffer uniform_buffer;
+    OGLStreamBuffer vertex_buffer;
+    OGLStreamBuffer uniform_buffer;
+    GLintptr uniform_buffer_alignment;
     OGLFramebuffer framebuffer;
 
-    std::array<OGLTexture, 6> lighting_luts;
-    std::array<std::array<GLvec4, 256>, 6> lighting_lut_data{};
-
-    OGLTexture fog_lut;
-    std::array<GLuint, 128> fog_lut_data{};
+    /// Raw lighting LUT entries followed by the fog LUT, read through a texture buffer
+    OGLBuffer lut_buffer;
+    OGLTexture lut_texture;
 };
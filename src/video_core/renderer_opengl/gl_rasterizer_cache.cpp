@@ -11,6 +11,7 @@
 #include <vector>
 #include <glad/glad.h>
 #include "common/bit_field.h"
+#include "common/hash.h"
 #include "common/logging/log.h"
 #include "common/math_util.h"
 #include "common/microprofile.h"
@@ -46,6 +47,20 @@ static const std::array<FormatTuple, 4> depth_format_tuples = {{
     {GL_DEPTH24_STENCIL8, GL_DEPTH_STENCIL, GL_UNSIGNED_INT_24_8}, // D24S8
 }};
 
+/// Texture memory the cache may hold before least recently used surfaces are evicted
+constexpr u64 SURFACE_MEMORY_BUDGET = 512 * 1024 * 1024;
+
+/// Estimates the amount of video memory used by the texture of a surface
+static u64 GetTextureMemoryUsage(const CachedSurface& surface) {
+    // Texture formats are decoded to RGBA8 and 24-bit formats are usually padded by the driver
+    u32 bpp = CachedSurface::GetFormatBpp(surface.pixel_format);
+    if (CachedSurface::GetFormatType(surface.pixel_format) == CachedSurface::SurfaceType::Texture ||
+        bpp == 24) {
+        bpp = 32;
+    }
+    return static_cast<u64>(surface.GetScaledWidth()) * surface.GetScaledHeight() * bpp / 8;
+}
+
 RasterizerCacheOpenGL::RasterizerCacheOpenGL() {
     transfer_framebuffers[0].Create();
     transfer_framebuffers[1].Create();
@@ -176,6 +191,46 @@ static void AllocateSurfaceTexture(GLuint texture, CachedSurface::PixelFormat pi
     cur_state.Apply();
 }
 
+/// Format of the pixel data transferred between a color or depth surface and its texture
+static const FormatTuple& GetSurfaceFormatTuple(const CachedSurface& surface) {
+    using SurfaceType = CachedSurface::SurfaceType;
+
+    SurfaceType type = CachedSurface::GetFormatType(surface.pixel_format);
+    if (type != SurfaceType::Depth && type != SurfaceType::DepthStencil) {
+        // TODO: Ensure this will always be a color format, not a depth or other format
+        ASSERT((size_t)surface.pixel_format < fb_format_tuples.size());
+        return fb_format_tuples[(unsigned int)surface.pixel_format];
+    }
+
+    // Depth/Stencil formats need special treatment since they aren't sampleable using
+    // LookupTexture and can't use RGBA format
+    size_t tuple_idx = (size_t)surface.pixel_format - 14;
+    ASSERT(tuple_idx < depth_format_tuples.size());
+    return depth_format_tuples[tuple_idx];
+}
+
+/// Whether the surface is converted between the 3DS tiled layout and its texture on the GPU.
+/// Texture-only formats and the other depth formats go through the CPU codecs.
+static bool IsTiledOnGPU(const CachedSurface& surface) {
+    using PixelFormat = CachedSurface::PixelFormat;
+
+    if (!surface.is_tiled || surface.width % 8 != 0 || surface.height % 8 != 0) {
+        return false;
+    }
+
+    switch (surface.pixel_format) {
+    case PixelFormat::RGBA8:
+    case PixelFormat::RGB8:
+    case PixelFormat::RGB5A1:
+    case PixelFormat::RGB565:
+    case PixelFormat::RGBA4:
+    case PixelFormat::D24S8:
+        return true;
+    default:
+        return false;
+    }
+}
+
 // TODO: refactor this function into a factory method, sepparating format decoding
 // from ogl texture loading. Thus the decoder could be used for different backends.
 static void DecodeTexture(const CachedSurface& params, u8* texture_src_data, FormatTuple tuple) {
@@ -391,6 +446,8 @@ CachedSurface* RasterizerCacheOpenGL::GetSurface(const CachedSurface& params, bo
 
     // Return the best exact surface if found
     if (best_exact_surface != nullptr) {
+        best_exact_surface->last_used_frame = frame_number;
+        ++frame_stats.hits;
         return best_exact_surface;
     }
 
@@ -405,6 +462,29 @@ CachedSurface* RasterizerCacheOpenGL::GetSurface(const CachedSurface& params, bo
     // Stride only applies to linear images.
     ASSERT(params.pixel_stride == 0 || !params.is_tiled);
 
+    u64 content_hash = 0;
+    if (load_if_create) {
+        Memory::RasterizerFlushRegion(params.addr, params_size);
+
+        // Images with padding between lines aren't hashed, since the padding isn't part of the
+        // surface. A hash of 0 is reserved for unknown contents.
+        if (params.pixel_stride == 0 || params.pixel_stride == params.width) {
+            content_hash = std::max<u64>(
+                Common::ComputeHash64(texture_src_data, static_cast<int>(params_size)), 1);
+        }
+
+        // Streamed textures are often invalidated and uploaded again with the same contents,
+        // possibly at a different address. Reuse the old texture instead of decoding again.
+        std::shared_ptr<CachedSurface> reused_surface = TakeReusableSurface(params, content_hash);
+        if (reused_surface != nullptr) {
+            reused_surface->addr = params.addr;
+            reused_surface->last_used_frame = frame_number;
+            RegisterSurface(reused_surface);
+            ++frame_stats.reuses;
+            return reused_surface.get();
+        }
+    }
+
     std::shared_ptr<CachedSurface> new_surface = std::make_shared<CachedSurface>();
 
     new_surface->addr = params.addr;
@@ -420,6 +500,8 @@ CachedSurface* RasterizerCacheOpenGL::GetSurface(const CachedSurface& params, bo
     new_surface->is_tiled = params.is_tiled;
     new_surface->pixel_format = params.pixel_format;
     new_surface->dirty = false;
+    new_surface->content_hash = content_hash;
+    new_surface->last_used_frame = frame_number;
 
     if (!load_if_create) {
         // Don't load any data; just allocate the surface's texture
@@ -429,7 +511,7 @@ CachedSurface* RasterizerCacheOpenGL::GetSurface(const CachedSurface& params, bo
         // TODO: Consider attempting subrect match in existing surfaces and direct blit here instead
         // of memory upload below if that's a common scenario in some game
 
-        Memory::RasterizerFlushRegion(params.addr, params_size);
+        ++frame_stats.uploads;
 
         // Load data from memory to the new surface
         OpenGLState cur_state = OpenGLState::GetCurState();
@@ -448,6 +530,13 @@ CachedSurface* RasterizerCacheOpenGL::GetSurface(const CachedSurface& params, bo
             glTexImage2D(GL_TEXTURE_2D, 0, tuple.internal_format, params.width, params.height, 0,
                          tuple.format, tuple.type, texture_src_data);
             glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
+        } else if (IsTiledOnGPU(*new_surface)) {
+            const FormatTuple& tuple = GetSurfaceFormatTuple(*new_surface);
+            AllocateSurfaceTexture(new_surface->texture.handle, new_surface->pixel_format,
+                                   params.width, params.height);
+            tile_converter.Untile(texture_src_data, new_surface->texture.handle, params.width,
+                                  params.height, tuple.internal_format, tuple.format, tuple.type);
+            glActiveTexture(GL_TEXTURE0);
         } else {
             SurfaceType type = CachedSurface::GetFormatType(new_surface->pixel_format);
             if (type != SurfaceType::Depth && type != SurfaceType::DepthStencil) {
@@ -498,10 +587,7 @@ CachedSurface* RasterizerCacheOpenGL::GetSurface(const CachedSurface& params, bo
         cur_state.Apply();
     }
 
-    Memory::RasterizerMarkRegionCached(new_surface->addr, new_surface->size, 1);
-    surface_cache.add(std::make_pair(boost::icl::interval<PAddr>::right_open(
-                                         new_surface->addr, new_surface->addr + new_surface->size),
-                                     std::set<std::shared_ptr<CachedSurface>>({new_surface})));
+    RegisterSurface(new_surface);
     return new_surface.get();
 }
 
@@ -549,6 +635,9 @@ CachedSurface* RasterizerCacheOpenGL::GetSurfaceRect(const CachedSurface& params
 
     // Return the best subrect surface if found
     if (best_subrect_surface != nullptr) {
+        best_subrect_surface->last_used_frame = frame_number;
+        ++frame_stats.hits;
+
         unsigned int bytes_per_pixel =
             (CachedSurface::GetFormatBpp(best_subrect_surface->pixel_format) / 8);
 
@@ -710,6 +799,8 @@ RasterizerCacheOpenGL::GetFramebufferSurfaces(const Pica::Regs::FramebufferConfi
         rect = MathUtil::Rectangle<int>(0, 0, 0, 0);
     }
 
+    SetFramebufferSurfaces(color_surface, depth_surface);
+
     return std::make_tuple(color_surface, depth_surface, rect);
 }
 
@@ -743,22 +834,66 @@ CachedSurface* RasterizerCacheOpenGL::TryGetFillSurface(const GPU::Regs::MemoryF
     return nullptr;
 }
 
-MICROPROFILE_DEFINE(OpenGL_SurfaceDownload, "OpenGL", "Surface Download", MP_RGB(128, 192, 64));
-void RasterizerCacheOpenGL::FlushSurface(CachedSurface* surface) {
+/// Number of consecutive frames a surface has to be flushed in to be downloaded ahead of time
+constexpr u32 DOWNLOAD_AHEAD_THRESHOLD = 2;
+
+/// Number of pixels between the starts of two lines of a downloaded surface
+static u32 GetDownloadRowLength(const CachedSurface& surface) {
+    return (!surface.is_tiled && surface.pixel_stride != 0) ? surface.pixel_stride : surface.width;
+}
+
+/// Size in bytes of the pixel data OpenGL returns for a surface
+static size_t GetDownloadSize(const CachedSurface& surface) {
+    // OpenGL needs 4 bpp alignment for D24 since using GL_UNSIGNED_INT as type
+    u32 gl_bytes_per_pixel = (surface.pixel_format == CachedSurface::PixelFormat::D24)
+                                 ? 4
+                                 : CachedSurface::GetFormatBpp(surface.pixel_format) / 8;
+    return GetDownloadRowLength(surface) * surface.height * gl_bytes_per_pixel;
+}
+
+/// Writes pixel data downloaded from a surface's texture to 3DS memory in the surface's format
+static void WriteSurfaceData(const CachedSurface& surface, u8* gl_data, u8* dst_buffer) {
     using PixelFormat = CachedSurface::PixelFormat;
-    using SurfaceType = CachedSurface::SurfaceType;
 
-    if (!surface->dirty) {
+    u32 bytes_per_pixel = CachedSurface::GetFormatBpp(surface.pixel_format) / 8;
+
+    if (IsTiledOnGPU(surface)) {
+        // Already in the tiled layout
+        std::memcpy(dst_buffer, gl_data, GetDownloadSize(surface));
         return;
     }
 
-    MICROPROFILE_SCOPE(OpenGL_SurfaceDownload);
-
-    u8* dst_buffer = Memory::GetPhysicalPointer(surface->addr);
-    if (dst_buffer == nullptr) {
+    if (!surface.is_tiled) {
+        // Copy line by line to leave the memory between lines untouched
+        u32 line_size = GetDownloadRowLength(surface) * bytes_per_pixel;
+        for (u32 y = 0; y < surface.height; ++y) {
+            std::memcpy(dst_buffer + y * line_size, gl_data + y * line_size,
+                        surface.width * bytes_per_pixel);
+        }
         return;
     }
 
+    // Directly copy pixels. Internal OpenGL color formats are consistent so no conversion is
+    // necessary.
+    switch (surface.pixel_format) {
+    case PixelFormat::D24: {
+        Pica::Encoders::Morton(gl_data, dst_buffer, surface.width, surface.height, 3);
+        break;
+    }
+    case PixelFormat::D24S8: {
+        Pica::Encoders::Morton(gl_data, dst_buffer, surface.width, surface.height, 4);
+        Pica::Encoders::Depth(dst_buffer, surface.width, surface.height);
+        break;
+    }
+    default: {
+        Pica::Encoders::Morton(gl_data, dst_buffer, surface.width, surface.height,
+                               bytes_per_pixel);
+        break;
+    }
+    }
+}
+
+void RasterizerCacheOpenGL::ReadSurfaceTexture(CachedSurface* surface, GLvoid* pixels) {
     OpenGLState cur_state = OpenGLState::GetCurState();
     GLuint old_tex = cur_state.texture_units[0].texture_2d;
 
@@ -780,78 +915,135 @@ void RasterizerCacheOpenGL::FlushSurface(CachedSurface* surface) {
         texture_to_flush = unscaled_tex.handle;
     }
 
+    const FormatTuple& tuple = GetSurfaceFormatTuple(*surface);
+
+    if (IsTiledOnGPU(*surface)) {
+        tile_converter.Tile(texture_to_flush, surface->width, surface->height,
+                            tuple.internal_format, tuple.format, tuple.type, pixels);
+        return;
+    }
+
     cur_state.texture_units[0].texture_2d = texture_to_flush;
     cur_state.Apply();
     glActiveTexture(GL_TEXTURE0);
 
-    if (!surface->is_tiled) {
-        // TODO: Ensure this will always be a color format, not a depth or other format
-        ASSERT((size_t)surface->pixel_format < fb_format_tuples.size());
-        const FormatTuple& tuple = fb_format_tuples[(unsigned int)surface->pixel_format];
+    glPixelStorei(GL_PACK_ALIGNMENT, 1);
+    glPixelStorei(GL_PACK_ROW_LENGTH, (GLint)GetDownloadRowLength(*surface));
+    glGetTexImage(GL_TEXTURE_2D, 0, tuple.format, tuple.type, pixels);
+    glPixelStorei(GL_PACK_ROW_LENGTH, 0);
+    glPixelStorei(GL_PACK_ALIGNMENT, 4);
+
+    cur_state.texture_units[0].texture_2d = old_tex;
+    cur_state.Apply();
+}
+
+MICROPROFILE_DEFINE(OpenGL_SurfaceDownload, "OpenGL", "Surface Download", MP_RGB(128, 192, 64));
+void RasterizerCacheOpenGL::FlushSurface(CachedSurface* surface) {
+    if (!surface->dirty) {
+        return;
+    }
+
+    MICROPROFILE_SCOPE(OpenGL_SurfaceDownload);
 
-        glPixelStorei(GL_PACK_ROW_LENGTH, (GLint)surface->pixel_stride);
-        glGetTexImage(GL_TEXTURE_2D, 0, tuple.format, tuple.type, dst_buffer);
-        glPixelStorei(GL_PACK_ROW_LENGTH, 0);
+    // The texture has been rendered to, so it no longer matches the memory it was loaded from
+    surface->content_hash = 0;
+
+    u8* dst_buffer = Memory::GetPhysicalPointer(surface->addr);
+    if (dst_buffer == nullptr) {
+        return;
+    }
+
+    // Count the consecutive frames in which the surface gets read back
+    if (surface->flush_streak != 0 && surface->last_flush_frame + 1 >= frame_number) {
+        if (surface->last_flush_frame != frame_number) {
+            ++surface->flush_streak;
+        }
     } else {
-        SurfaceType type = CachedSurface::GetFormatType(surface->pixel_format);
-        if (type != SurfaceType::Depth && type != SurfaceType::DepthStencil) {
-            ASSERT((size_t)surface->pixel_format < fb_format_tuples.size());
-            const FormatTuple& tuple = fb_format_tuples[(unsigned int)surface->pixel_format];
+        surface->flush_streak = 1;
+    }
+    surface->last_flush_frame = frame_number;
+
+    if (surface->download_fence.handle != nullptr) {
+        // The contents were already downloaded after the last draw, usually long enough ago that
+        // the GPU is done and this doesn't wait
+        glClientWaitSync(surface->download_fence.handle, GL_SYNC_FLUSH_COMMANDS_BIT,
+                         GL_TIMEOUT_IGNORED);
+        surface->download_fence.Release();
+
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, surface->download_buffer.handle);
+        void* pixels = glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, GetDownloadSize(*surface),
+                                        GL_MAP_READ_BIT);
+        if (pixels != nullptr) {
+            WriteSurfaceData(*surface, static_cast<u8*>(pixels), dst_buffer);
+            glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+        }
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
 
-            u32 bytes_per_pixel = CachedSurface::GetFormatBpp(surface->pixel_format) / 8;
+        if (pixels != nullptr) {
+            ++frame_stats.predicted_downloads;
+            surface->dirty = false;
+            return;
+        }
+    }
 
-            std::vector<u8> temp_gl_buffer(surface->width * surface->height * bytes_per_pixel);
+    if (!surface->is_tiled || IsTiledOnGPU(*surface)) {
+        // Linear images and images tiled on the GPU can be read straight into 3DS memory
+        ReadSurfaceTexture(surface, dst_buffer);
+    } else {
+        std::vector<u8> temp_gl_buffer(GetDownloadSize(*surface));
+        ReadSurfaceTexture(surface, temp_gl_buffer.data());
+        WriteSurfaceData(*surface, temp_gl_buffer.data(), dst_buffer);
+    }
 
-            glGetTexImage(GL_TEXTURE_2D, 0, tuple.format, tuple.type, temp_gl_buffer.data());
+    ++frame_stats.synchronous_downloads;
+    surface->dirty = false;
+}
 
-            // Directly copy pixels. Internal OpenGL color formats are consistent so no conversion
-            // is necessary.
-            Pica::Encoders::Morton(temp_gl_buffer.data(), dst_buffer, surface->width,
-                                   surface->height, bytes_per_pixel);
-        } else {
-            // Depth/Stencil formats need special treatment since they aren't sampleable using
-            // LookupTexture and can't use RGBA format
-            size_t tuple_idx = (size_t)surface->pixel_format - 14;
-            ASSERT(tuple_idx < depth_format_tuples.size());
-            const FormatTuple& tuple = depth_format_tuples[tuple_idx];
+void RasterizerCacheOpenGL::MarkSurfaceDirty(CachedSurface* surface) {
+    surface->dirty = true;
 
-            u32 bytes_per_pixel = CachedSurface::GetFormatBpp(surface->pixel_format) / 8;
+    // A download started earlier doesn't hold the new contents
+    surface->download_fence.Release();
+}
 
-            // OpenGL needs 4 bpp alignment for D24 since using GL_UNSIGNED_INT as type
-            bool use_4bpp = (surface->pixel_format == PixelFormat::D24);
-            u32 gl_bytes_per_pixel = use_4bpp ? 4 : bytes_per_pixel;
+MICROPROFILE_DEFINE(OpenGL_SurfaceDownloadAhead, "OpenGL", "Surface Download-ahead",
+                    MP_RGB(96, 160, 64));
+void RasterizerCacheOpenGL::DownloadAhead(CachedSurface* surface) {
+    if (!surface->dirty || surface->download_fence.handle != nullptr) {
+        return;
+    }
 
-            std::vector<u8> temp_gl_buffer(surface->width * surface->height * gl_bytes_per_pixel);
+    // Only surfaces read back in each of the last frames are expected to be read again
+    if (surface->flush_streak < DOWNLOAD_AHEAD_THRESHOLD ||
+        surface->last_flush_frame + 1 < frame_number) {
+        return;
+    }
 
-            glPixelStorei(GL_PACK_ALIGNMENT, 1);
-            glGetTexImage(GL_TEXTURE_2D, 0, tuple.format, tuple.type, temp_gl_buffer.data());
-            glPixelStorei(GL_PACK_ALIGNMENT, 4);
+    MICROPROFILE_SCOPE(OpenGL_SurfaceDownloadAhead);
 
-            switch (surface->pixel_format) {
-            case PixelFormat::D24: {
-                Pica::Encoders::Morton(temp_gl_buffer.data(), dst_buffer, surface->width,
-                                       surface->height, 3);
-                break;
-            }
-            case PixelFormat::D24S8: {
-                Pica::Encoders::Morton(temp_gl_buffer.data(), dst_buffer, surface->width,
-                                       surface->height, 4);
-                Pica::Encoders::Depth(dst_buffer, surface->width, surface->height);
-                break;
-            }
-            default: {
-                Pica::Encoders::Morton(temp_gl_buffer.data(), dst_buffer, surface->width,
-                                       surface->height, bytes_per_pixel);
-                break;
-            }
-            }
+    surface->download_buffer.Create();
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, surface->download_buffer.handle);
+    glBufferData(GL_PIXEL_PACK_BUFFER, GetDownloadSize(*surface), nullptr, GL_STREAM_READ);
+    ReadSurfaceTexture(surface, nullptr);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+    surface->download_fence.Create();
+}
+
+void RasterizerCacheOpenGL::SetFramebufferSurfaces(CachedSurface* color_surface,
+                                                   CachedSurface* depth_surface) {
+    // Surfaces that stop being drawn to are done for now, so their downloads can start
+    for (const auto& surface : framebuffer_surfaces) {
+        if (surface != nullptr && surface.get() != color_surface &&
+            surface.get() != depth_surface) {
+            DownloadAhead(surface.get());
         }
     }
 
-    surface->dirty = false;
-
-    cur_state.texture_units[0].texture_2d = old_tex;
-    cur_state.Apply();
+    framebuffer_surfaces[0] =
+        color_surface != nullptr ? color_surface->shared_from_this() : nullptr;
+    framebuffer_surfaces[1] =
+        depth_surface != nullptr ? depth_surface->shared_from_this() : nullptr;
 }
 
 void RasterizerCacheOpenGL::FlushRegion(PAddr addr, u32 size, const CachedSurface* skip_surface,
@@ -877,11 +1069,7 @@ void RasterizerCacheOpenGL::FlushRegion(PAddr addr, u32 size, const CachedSurfac
     for (auto surface : touching_surfaces) {
         FlushSurface(surface.get());
         if (invalidate) {
-            Memory::RasterizerMarkRegionCached(surface->addr, surface->size, -1);
-            surface_cache.subtract(
-                std::make_pair(boost::icl::interval<PAddr>::right_open(
-                                   surface->addr, surface->addr + surface->size),
-                               std::set<std::shared_ptr<CachedSurface>>({surface})));
+            UnregisterSurface(surface);
         }
     }
 }
@@ -893,3 +1081,120 @@ void RasterizerCacheOpenGL::FlushAll() {
         }
     }
 }
+
+void RasterizerCacheOpenGL::FinishFrame() {
+    // The frame's drawing is done, so start downloading the render targets if they are expected
+    // to be read back
+    for (const auto& surface : framebuffer_surfaces) {
+        if (surface != nullptr) {
+            DownloadAhead(surface.get());
+        }
+    }
+
+    // Gather up unique surfaces, both cached and kept for reuse
+    std::unordered_set<std::shared_ptr<CachedSurface>> cached_surfaces;
+    for (auto& surfaces : surface_cache) {
+        cached_surfaces.insert(surfaces.second.begin(), surfaces.second.end());
+    }
+
+    u64 resident_bytes = 0;
+    std::vector<std::pair<std::shared_ptr<CachedSurface>, bool>> eviction_candidates;
+    for (auto& surface : cached_surfaces) {
+        resident_bytes += GetTextureMemoryUsage(*surface);
+        // Surfaces used during this frame may still be referenced by the rasterizer's state
+        if (surface->last_used_frame < frame_number) {
+            eviction_candidates.emplace_back(surface, false);
+        }
+    }
+    for (auto& entry : reusable_surfaces) {
+        resident_bytes += GetTextureMemoryUsage(*entry.second);
+        eviction_candidates.emplace_back(entry.second, true);
+    }
+
+    if (resident_bytes > SURFACE_MEMORY_BUDGET) {
+        std::sort(eviction_candidates.begin(), eviction_candidates.end(),
+                  [](const auto& a, const auto& b) {
+                      return a.first->last_used_frame < b.first->last_used_frame;
+                  });
+
+        for (auto& candidate : eviction_candidates) {
+            if (resident_bytes <= SURFACE_MEMORY_BUDGET) {
+                break;
+            }
+
+            const std::shared_ptr<CachedSurface>& surface = candidate.first;
+            if (candidate.second) {
+                auto range = reusable_surfaces.equal_range(surface->content_hash);
+                for (auto it = range.first; it != range.second; ++it) {
+                    if (it->second == surface) {
+                        reusable_surfaces.erase(it);
+                        break;
+                    }
+                }
+            } else {
+                FlushSurface(surface.get());
+                Memory::RasterizerMarkRegionCached(surface->addr, surface->size, -1);
+                surface_cache.subtract(
+                    std::make_pair(boost::icl::interval<PAddr>::right_open(
+                                       surface->addr, surface->addr + surface->size),
+                                   std::set<std::shared_ptr<CachedSurface>>({surface})));
+            }
+
+            resident_bytes -= GetTextureMemoryUsage(*surface);
+            ++frame_stats.evictions;
+        }
+    }
+
+    frame_stats.resident_bytes = resident_bytes;
+    LOG_TRACE(Render_OpenGL,
+              "Surface cache: %u hits, %u uploads, %u reuses, %u evictions, %llu bytes resident, "
+              "%u predicted and %u synchronous downloads",
+              frame_stats.hits, frame_stats.uploads, frame_stats.reuses, frame_stats.evictions,
+              static_cast<unsigned long long>(frame_stats.resident_bytes),
+              frame_stats.predicted_downloads, frame_stats.synchronous_downloads);
+
+    previous_frame_stats = frame_stats;
+    frame_stats = {};
+    ++frame_number;
+}
+
+void RasterizerCacheOpenGL::RegisterSurface(const std::shared_ptr<CachedSurface>& surface) {
+    Memory::RasterizerMarkRegionCached(surface->addr, surface->size, 1);
+    surface_cache.add(std::make_pair(
+        boost::icl::interval<PAddr>::right_open(surface->addr, surface->addr + surface->size),
+        std::set<std::shared_ptr<CachedSurface>>({surface})));
+}
+
+void RasterizerCacheOpenGL::UnregisterSurface(const std::shared_ptr<CachedSurface>& surface) {
+    Memory::RasterizerMarkRegionCached(surface->addr, surface->size, -1);
+    surface_cache.subtract(std::make_pair(
+        boost::icl::interval<PAddr>::right_open(surface->addr, surface->addr + surface->size),
+        std::set<std::shared_ptr<CachedSurface>>({surface})));
+
+    if (surface->content_hash != 0 && !surface->dirty) {
+        reusable_surfaces.emplace(surface->content_hash, surface);
+    }
+}
+
+std::shared_ptr<CachedSurface> RasterizerCacheOpenGL::TakeReusableSurface(
+    const CachedSurface& params, u64 content_hash) {
+    if (content_hash == 0) {
+        return nullptr;
+    }
+
+    auto range = reusable_surfaces.equal_range(content_hash);
+    for (auto it = range.first; it != range.second; ++it) {
+        const CachedSurface& surface = *it->second;
+        if (surface.width == params.width && surface.height == params.height &&
+            surface.pixel_format == params.pixel_format && surface.is_tiled == params.is_tiled &&
+            surface.pixel_stride == params.pixel_stride &&
+            surface.res_scale_width == params.res_scale_width &&
+            surface.res_scale_height == params.res_scale_height) {
+            std::shared_ptr<CachedSurface> surface_ptr = std::move(it->second);
+            reusable_surfaces.erase(it);
+            return surface_ptr;
+        }
+    }
+
+    return nullptr;
+}
@@ -8,6 +8,7 @@
 #include <memory>
 #include <set>
 #include <tuple>
+#include <unordered_map>
 #include <boost/icl/interval_map.hpp>
 #include <glad/glad.h>
 #include "common/assert.h"
@@ -16,6 +17,7 @@
 #include "core/hw/gpu.h"
 #include "video_core/pica.h"
 #include "video_core/renderer_opengl/gl_resource_manager.h"
+#include "video_core/renderer_opengl/gl_tile_converter.h"
 
 namespace MathUtil {
 template <class T>
@@ -26,7 +28,7 @@ struct CachedSurface;
 
 using SurfaceCache = boost::icl::interval_map<PAddr, std::set<std::shared_ptr<CachedSurface>>>;
 
-struct CachedSurface {
+struct CachedSurface : std::enable_shared_from_this<CachedSurface> {
     enum class PixelFormat {
         // First 5 formats are shared between textures and color buffers
         RGBA8 = 0,
@@ -179,6 +181,22 @@ struct CachedSurface {
     bool is_tiled;
     PixelFormat pixel_format;
     bool dirty;
+
+    /// Hash of the guest memory the texture was loaded from. 0 once the texture no longer
+    /// reflects that memory, e.g. after being rendered to, or if it was never loaded from memory.
+    u64 content_hash = 0;
+    /// Frame in which the surface was last looked up, used for LRU eviction
+    u64 last_used_frame = 0;
+
+    /// Number of consecutive frames in which the surface was flushed, used to predict read backs
+    u32 flush_streak = 0;
+    /// Frame in which the surface was last flushed
+    u64 last_flush_frame = 0;
+    /// Pixel pack buffer the surface is downloaded to ahead of a predicted flush
+    OGLBuffer download_buffer;
+    /// Signaled when the download to download_buffer has completed. Only set while the download
+    /// holds the current contents of the texture.
+    OGLSync download_fence;
 };
 
 class RasterizerCacheOpenGL : NonCopyable {
@@ -218,6 +236,9 @@ public:
     /// Write the surface back to memory
     void FlushSurface(CachedSurface* surface);
 
+    /// Marks the surface as modified by the GPU, so that it has to be written back to memory
+    void MarkSurfaceDirty(CachedSurface* surface);
+
     /// Write any cached resources overlapping the region back to memory (if dirty) and optionally
     /// invalidate them in the cache
     void FlushRegion(PAddr addr, u32 size, const CachedSurface* skip_surface, bool invalidate);
@@ -225,7 +246,67 @@ public:
     /// Flush all cached resources tracked by this cache manager
     void FlushAll();
 
+    struct FrameStats {
+        /// Lookups satisfied by a surface already in the cache
+        u32 hits = 0;
+        /// Surfaces decoded and uploaded from guest memory
+        u32 uploads = 0;
+        /// Surfaces restored by content hash instead of being uploaded
+        u32 reuses = 0;
+        /// Surfaces evicted to stay within the memory budget
+        u32 evictions = 0;
+        /// Flushes served by a download started ahead of time
+        u32 predicted_downloads = 0;
+        /// Flushes that had to download synchronously
+        u32 synchronous_downloads = 0;
+        /// Estimated texture memory held by the cache at the end of the frame
+        u64 resident_bytes = 0;
+    };
+
+    /// Starts predicted downloads, evicts least recently used surfaces if over the memory budget
+    /// and starts a new frame
+    void FinishFrame();
+
+    /// Get the statistics of the previous frame. This is updated when you call FinishFrame().
+    const FrameStats& GetPreviousFrameStats() const {
+        return previous_frame_stats;
+    }
+
 private:
+    /// Adds a surface to the cache and marks its memory as cached
+    void RegisterSurface(const std::shared_ptr<CachedSurface>& surface);
+
+    /// Removes a surface from the cache. Surfaces whose contents are known are kept aside so that
+    /// an identical upload can reuse them.
+    void UnregisterSurface(const std::shared_ptr<CachedSurface>& surface);
+
+    /// Takes a previously invalidated surface matching the parameters and content hash, if any
+    std::shared_ptr<CachedSurface> TakeReusableSurface(const CachedSurface& params,
+                                                       u64 content_hash);
+
+    /// Reads the texture of the surface at 1x scale into `pixels`, or into the bound pixel pack
+    /// buffer if one is bound
+    void ReadSurfaceTexture(CachedSurface* surface, GLvoid* pixels);
+
+    /// Starts downloading the surface into its pixel pack buffer if the guest is expected to read
+    /// it back, so that the flush doesn't have to wait for the GPU
+    void DownloadAhead(CachedSurface* surface);
+
+    /// Tracks the surfaces bound for rendering, starting predicted downloads of the ones that
+    /// are no longer bound
+    void SetFramebufferSurfaces(CachedSurface* color_surface, CachedSurface* depth_surface);
+
     SurfaceCache surface_cache;
     OGLFramebuffer transfer_framebuffers[2];
+    TileConverterOpenGL tile_converter;
+
+    /// Invalidated surfaces with known contents, keyed by content hash
+    std::unordered_multimap<u64, std::shared_ptr<CachedSurface>> reusable_surfaces;
+
+    /// Color and depth surfaces used by the last draw
+    std::array<std::shared_ptr<CachedSurface>, 2> framebuffer_surfaces;
+
+    u64 frame_number = 0;
+    FrameStats frame_stats;
+    FrameStats previous_frame_stats;
 };
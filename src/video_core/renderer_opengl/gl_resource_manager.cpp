@@ -0,0 +1,108 @@
+// Copyright 2017 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include "common/alignment.h"
+#include "common/assert.h"
+#include "video_core/renderer_opengl/gl_resource_manager.h"
+
+OGLStreamBuffer::OGLStreamBuffer(GLenum target, GLsizeiptr size)
+    : target(target), buffer_size(size), persistent(GLAD_GL_ARB_buffer_storage != 0) {
+    ASSERT(size % NUM_SYNC_POINTS == 0);
+
+    buffer.Create();
+    glBindBuffer(target, buffer.handle);
+
+    if (persistent) {
+        constexpr GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+        glBufferStorage(target, buffer_size, nullptr, flags);
+        mapped_ptr = static_cast<u8*>(glMapBufferRange(target, 0, buffer_size, flags));
+        persistent = mapped_ptr != nullptr;
+    }
+
+    if (!persistent) {
+        // Immutable storage can not be respecified, so the fallback needs a fresh buffer
+        buffer.Release();
+        buffer.Create();
+        glBindBuffer(target, buffer.handle);
+        glBufferData(target, buffer_size, nullptr, GL_STREAM_DRAW);
+        staging.resize(static_cast<size_t>(buffer_size));
+    }
+}
+
+OGLStreamBuffer::~OGLStreamBuffer() {
+    for (GLsync& fence : fences) {
+        if (fence != nullptr) {
+            glDeleteSync(fence);
+            fence = nullptr;
+        }
+    }
+
+    if (persistent && buffer.handle != 0) {
+        glBindBuffer(target, buffer.handle);
+        glUnmapBuffer(target);
+    }
+}
+
+std::pair<u8*, GLintptr> OGLStreamBuffer::Map(GLsizeiptr size, GLintptr alignment) {
+    ASSERT(size <= buffer_size);
+
+    GLintptr offset = static_cast<GLintptr>(
+        Common::AlignUp(static_cast<size_t>(buffer_pos), static_cast<size_t>(alignment)));
+    const bool wrap = offset + size > buffer_size;
+
+    if (persistent) {
+        // Every draw reading from regions filled before this call has been issued by now
+        if (wrap) {
+            FenceRegions(fenced_region, buffer_pos != 0 ? GetRegion(buffer_pos - 1) + 1 : 0);
+            fenced_region = 0;
+        } else {
+            FenceRegions(fenced_region, GetRegion(offset));
+            fenced_region = GetRegion(offset);
+        }
+    }
+
+    if (wrap) {
+        offset = 0;
+    }
+
+    if (persistent) {
+        WaitRegions(GetRegion(offset), GetRegion(offset + size - 1) + 1);
+    }
+
+    mapped_offset = offset;
+    buffer_pos = offset;
+
+    return {persistent ? mapped_ptr + offset : staging.data(), offset};
+}
+
+void OGLStreamBuffer::Unmap(GLsizeiptr size) {
+    ASSERT(mapped_offset + size <= buffer_size);
+
+    if (!persistent && size > 0) {
+        glBufferSubData(target, mapped_offset, size, staging.data());
+    }
+
+    buffer_pos = mapped_offset + size;
+}
+
+void OGLStreamBuffer::FenceRegions(size_t begin, size_t end) {
+    for (size_t region = begin; region < end; ++region) {
+        // A region skipped over since it was last fenced can still hold an older fence, which the
+        // new one supersedes
+        if (fences[region] != nullptr) {
+            glDeleteSync(fences[region]);
+        }
+        fences[region] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    }
+}
+
+void OGLStreamBuffer::WaitRegions(size_t begin, size_t end) {
+    for (size_t region = begin; region < end; ++region) {
+        if (fences[region] != nullptr) {
+            glClientWaitSync(fences[region], GL_SYNC_FLUSH_COMMANDS_BIT, GL_TIMEOUT_IGNORED);
+            glDeleteSync(fences[region]);
+            fences[region] = nullptr;
+        }
+    }
+}
@@ -4,7 +4,9 @@
 
 #pragma once
 
+#include <array>
 #include <utility>
+#include <vector>
 #include <glad/glad.h>
 #include "common/common_types.h"
 #include "video_core/renderer_opengl/gl_shader_util.h"
@@ -142,6 +144,108 @@ public:
     GLuint handle = 0;
 };
 
+class OGLSync : private NonCopyable {
+public:
+    OGLSync() = default;
+    OGLSync(OGLSync&& o) {
+        std::swap(handle, o.handle);
+    }
+    ~OGLSync() {
+        Release();
+    }
+    OGLSync& operator=(OGLSync&& o) {
+        std::swap(handle, o.handle);
+        return *this;
+    }
+
+    /// Inserts a fence that is signaled once all previously issued commands have completed
+    void Create() {
+        if (handle != nullptr)
+            return;
+        handle = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    }
+
+    /// Deletes the internal OpenGL resource
+    void Release() {
+        if (handle == nullptr)
+            return;
+        glDeleteSync(handle);
+        handle = nullptr;
+    }
+
+    GLsync handle = nullptr;
+};
+
+/**
+ * Ring buffer used to stream per-draw data to the GPU without reallocating buffer storage. With
+ * ARB_buffer_storage the whole buffer stays persistently mapped and regions are only reused once
+ * fences show the GPU is done reading them. Without it, data is staged in system memory and
+ * uploaded with glBufferSubData into successive ranges of the buffer.
+ */
+class OGLStreamBuffer : private NonCopyable {
+public:
+    /**
+     * Creates the buffer and binds it to `target`.
+     * @param target Buffer binding point the stream buffer is used with
+     * @param size Capacity of the ring in bytes
+     */
+    OGLStreamBuffer(GLenum target, GLsizeiptr size);
+    ~OGLStreamBuffer();
+
+    GLuint GetHandle() const {
+        return buffer.handle;
+    }
+
+    GLsizeiptr GetSize() const {
+        return buffer_size;
+    }
+
+    /**
+     * Reserves space for the next piece of data. The buffer must be bound to its target and every
+     * call must be followed by Unmap before drawing from the returned range.
+     * @param size Number of bytes to reserve, at most the capacity of the buffer
+     * @param alignment Alignment of the returned offset in bytes
+     * @returns Pointer to write the data to and its offset inside the buffer
+     */
+    std::pair<u8*, GLintptr> Map(GLsizeiptr size, GLintptr alignment);
+
+    /// Commits the first `size` bytes written to the range returned by the last Map call.
+    void Unmap(GLsizeiptr size);
+
+private:
+    /// Number of independently fenced regions the ring is divided into
+    static constexpr size_t NUM_SYNC_POINTS = 16;
+
+    size_t GetRegion(GLintptr offset) const {
+        return static_cast<size_t>(offset / (buffer_size / NUM_SYNC_POINTS));
+    }
+
+    /// Inserts fences for the regions in [begin, end), whose draws have all been issued
+    void FenceRegions(size_t begin, size_t end);
+    /// Waits for the GPU to finish reading the regions in [begin, end)
+    void WaitRegions(size_t begin, size_t end);
+
+    OGLBuffer buffer;
+    GLenum target;
+    GLsizeiptr buffer_size;
+
+    /// Offset of the first byte after the last committed data
+    GLintptr buffer_pos = 0;
+    /// Offset of the range returned by the last Map call
+    GLintptr mapped_offset = 0;
+    /// First region that has not been fenced since data was last written to it
+    size_t fenced_region = 0;
+
+    /// Whether the buffer is persistently mapped, otherwise data is staged
+    bool persistent;
+    /// Base pointer of the persistent mapping
+    u8* mapped_ptr = nullptr;
+    /// Staging memory for the glBufferSubData fallback
+    std::vector<u8> staging;
+
+    std::array<GLsync, NUM_SYNC_POINTS> fences{};
+};
+
 class OGLVertexArray : private NonCopyable {
 public:
     OGLVertexArray() = default;
@@ -433,8 +433,7 @@ static void WriteLighting(std::string& out, const PicaShaderConfig& config) {
 
     // Gets the lighting lookup table value given the specified sampler and index
     auto GetLutValue = [](Regs::LightingSampler sampler, std::string lut_index) {
-        return std::string("texture(lut[" + std::to_string((unsigned)sampler / 4) + "], " +
-                           lut_index + ")[" + std::to_string((unsigned)sampler & 3) + "]");
+        return "LookupLightingLut(" + std::to_string((unsigned)sampler) + ", " + lut_index + ")";
     };
 
     // Write the code to emulate each enabled light
@@ -570,13 +569,12 @@ static void WriteLighting(std::string& out, const PicaShaderConfig& config) {
     out += "secondary_fragment_color = clamp(specular_sum, vec4(0.0), vec4(1.0));\n";
 }
 
-std::string GenerateFragmentShader(const PicaShaderConfig& config) {
-    const auto& state = config.state;
-
-    std::string out = R"(
+/// Declarations shared by the specialized fragment shaders and the uber-shader
+static const char fragment_shader_preamble[] = R"(
 #version 330 core
 #define NUM_TEV_STAGES 6
 #define NUM_LIGHTS 8
+#define FOG_LUT_OFFSET 6144
 
 // Texture coordinate offsets and scales
 #define OFFSET_256 (0.5 / 256.0)
@@ -619,14 +617,31 @@ layout (std140) uniform shader_data {
 };
 
 uniform sampler2D tex[3];
-uniform sampler1D lut[6];
-uniform usampler1D fog_lut;
+// Raw entries of the 24 lighting LUTs of 256 entries each, followed by the fog LUT
+uniform usamplerBuffer lut;
 
 // Rotate the vector v by the quaternion q
 vec3 quaternion_rotate(vec4 q, vec3 v) {
     return v + 2.0 * cross(q.xyz, cross(q.xyz, v) + q.w * v);
 }
 
+// Samples a lighting LUT at a texture coordinate, interpolating between neighbouring entries like
+// a linearly filtered texture of 256 texels would
+float LookupLightingLut(int sampler_index, float coord) {
+    float position = clamp(coord * 256.0 - 0.5, 0.0, 255.0);
+    int index = int(position);
+    int base = sampler_index * 256;
+    float value = float(texelFetch(lut, base + index).r & 0xFFFU);
+    float next_value = float(texelFetch(lut, base + min(index + 1, 255)).r & 0xFFFU);
+    return mix(value, next_value, position - float(index)) / 4095.0;
+}
+)";
+
+std::string GenerateFragmentShader(const PicaShaderConfig& config) {
+    const auto& state = config.state;
+
+    std::string out = fragment_shader_preamble;
+    out += R"(
 void main() {
 vec4 primary_fragment_color = vec4(0.0);
 vec4 secondary_fragment_color = vec4(0.0);
@@ -684,7 +699,7 @@ vec4 secondary_fragment_color = vec4(0.0);
         // Generate clamped fog factor from LUT for given fog index
         out += "float fog_i = clamp(floor(fog_index), 0.0, 127.0);\n";
         out += "float fog_f = fog_index - fog_i;\n";
-        out += "uint fog_lut_entry = texelFetch(fog_lut, int(fog_i), 0).r;\n";
+        out += "uint fog_lut_entry = texelFetch(lut, FOG_LUT_OFFSET + int(fog_i)).r;\n";
         out += "float fog_lut_entry_difference = float(int((fog_lut_entry & 0x1FFFU) << 19U) >> "
                "19);\n"; // Extract signed difference
         out += "float fog_lut_entry_value = float((fog_lut_entry >> 13U) & 0x7FFU);\n";
@@ -704,6 +719,367 @@ vec4 secondary_fragment_color = vec4(0.0);
     return out;
 }
 
+std::string GenerateUberFragmentShader() {
+    std::string out = fragment_shader_preamble;
+    out += R"(
+#define ALPHA_TEST_NEVER 0
+#define SCISSOR_EXCLUDE 1
+#define SCISSOR_INCLUDE 3
+#define TEXTURE_PROJECTION_2D 3
+#define BUMP_MODE_NORMAL_MAP 1
+
+// Indices into lighting_luts and the lighting samplers they read
+#define LUT_D0 0
+#define LUT_D1 1
+#define LUT_FR 2
+#define LUT_RR 3
+#define LUT_RG 4
+#define LUT_RB 5
+#define SAMPLER_D0 0
+#define SAMPLER_D1 1
+#define SAMPLER_FR 3
+#define SAMPLER_RB 4
+#define SAMPLER_RG 5
+#define SAMPLER_RR 6
+#define SAMPLER_DIST_ATTEN 16
+
+// Pica state normally baked into the specialized shaders
+layout (std140) uniform uber_config {
+    // sources_raw, modifiers_raw, ops_raw and scales_raw of each TEV stage
+    uvec4 tev_stages[NUM_TEV_STAGES];
+    int alpha_test_func;
+    int scissor_test_mode;
+    int texture0_type;
+    int combiner_buffer_input;
+    int w_buffering;
+    int fog_enable;
+    int fog_flip;
+    int lighting_enable;
+    int lighting_src_num;
+    int lighting_bump_mode;
+    int lighting_bump_selector;
+    int lighting_bump_renorm;
+    int lighting_clamp_highlights;
+    int lighting_fresnel_selector;
+    // num, directional, two_sided_diffuse, dist_atten_enable of each enabled light
+    ivec4 lighting_lights[NUM_LIGHTS];
+    // enable, abs_input and input of each LUT
+    ivec4 lighting_luts[6];
+    // Scale of each LUT, in x
+    vec4 lighting_lut_scales[6];
+};
+
+vec4 primary_fragment_color;
+vec4 secondary_fragment_color;
+vec4 texture_color[3];
+vec4 combiner_buffer;
+vec4 last_tex_env_out;
+
+vec4 GetSource(uint source, int stage) {
+    switch (int(source)) {
+    case 0x0: return primary_color;
+    case 0x1: return primary_fragment_color;
+    case 0x2: return secondary_fragment_color;
+    case 0x3: return texture_color[0];
+    case 0x4: return texture_color[1];
+    case 0x5: return texture_color[2];
+    case 0xd: return combiner_buffer;
+    case 0xe: return const_color[stage];
+    case 0xf: return last_tex_env_out;
+    default: return vec4(0.0);
+    }
+}
+
+vec3 GetColorModifier(uint modifier, vec4 value) {
+    switch (int(modifier)) {
+    case 0x0: return value.rgb;
+    case 0x1: return vec3(1.0) - value.rgb;
+    case 0x2: return value.aaa;
+    case 0x3: return vec3(1.0) - value.aaa;
+    case 0x4: return value.rrr;
+    case 0x5: return vec3(1.0) - value.rrr;
+    case 0x8: return value.ggg;
+    case 0x9: return vec3(1.0) - value.ggg;
+    case 0xc: return value.bbb;
+    case 0xd: return vec3(1.0) - value.bbb;
+    default: return vec3(0.0);
+    }
+}
+
+float GetAlphaModifier(uint modifier, vec4 value) {
+    switch (int(modifier)) {
+    case 0x0: return value.a;
+    case 0x1: return 1.0 - value.a;
+    case 0x2: return value.r;
+    case 0x3: return 1.0 - value.r;
+    case 0x4: return value.g;
+    case 0x5: return 1.0 - value.g;
+    case 0x6: return value.b;
+    case 0x7: return 1.0 - value.b;
+    default: return 0.0;
+    }
+}
+
+vec3 CombineColor(uint operation, vec3 value[3]) {
+    vec3 result;
+    switch (int(operation)) {
+    case 0: result = value[0]; break;
+    case 1: result = value[0] * value[1]; break;
+    case 2: result = value[0] + value[1]; break;
+    case 3: result = value[0] + value[1] - vec3(0.5); break;
+    case 4: result = value[0] * value[2] + value[1] * (vec3(1.0) - value[2]); break;
+    case 5: result = value[0] - value[1]; break;
+    case 6: result = vec3(dot(value[0] - vec3(0.5), value[1] - vec3(0.5)) * 4.0); break;
+    case 8: result = value[0] * value[1] + value[2]; break;
+    case 9: result = min(value[0] + value[1], vec3(1.0)) * value[2]; break;
+    default: result = vec3(0.0); break;
+    }
+    return clamp(result, vec3(0.0), vec3(1.0));
+}
+
+float CombineAlpha(uint operation, float value[3]) {
+    float result;
+    switch (int(operation)) {
+    case 0: result = value[0]; break;
+    case 1: result = value[0] * value[1]; break;
+    case 2: result = value[0] + value[1]; break;
+    case 3: result = value[0] + value[1] - 0.5; break;
+    case 4: result = value[0] * value[2] + value[1] * (1.0 - value[2]); break;
+    case 5: result = value[0] - value[1]; break;
+    case 8: result = value[0] * value[1] + value[2]; break;
+    case 9: result = min(value[0] + value[1], 1.0) * value[2]; break;
+    default: result = 0.0; break;
+    }
+    return clamp(result, 0.0, 1.0);
+}
+
+float GetMultiplier(uint scale) {
+    return (scale < 3u) ? float(1u << scale) : 1.0;
+}
+
+bool AlphaTestFails(float alpha) {
+    int value = int(alpha * 255.0);
+    switch (alpha_test_func) {
+    case 0: return true;
+    case 2: return value != alphatest_ref;
+    case 3: return value == alphatest_ref;
+    case 4: return value >= alphatest_ref;
+    case 5: return value > alphatest_ref;
+    case 6: return value <= alphatest_ref;
+    case 7: return value < alphatest_ref;
+    default: return false;
+    }
+}
+
+float GetLightingLutValue(int lut_index, int sampler_index, bool two_sided_diffuse, vec3 normal,
+                          vec3 light_vector) {
+    ivec4 config = lighting_luts[lut_index];
+    vec3 half_angle = normalize(normalize(view) + light_vector);
+
+    float index;
+    switch (config.z) {
+    case 0: index = dot(normal, half_angle); break;
+    case 1: index = dot(normalize(view), half_angle); break;
+    case 2: index = dot(normal, normalize(view)); break;
+    case 3: index = dot(light_vector, normal); break;
+    default: index = 0.0; break;
+    }
+
+    if (config.y != 0) {
+        // LUT index is in the range of (0.0, 1.0)
+        index = two_sided_diffuse ? abs(index) : max(index, 0.0);
+    } else {
+        // LUT index is in the range of (-1.0, 1.0)
+        index = ((index < 0) ? index + 2.0 : index) / 2.0;
+    }
+
+    index = OFFSET_256 + SCALE_256 * clamp(index, 0.0, 1.0);
+    return lighting_lut_scales[lut_index].x * LookupLightingLut(sampler_index, index);
+}
+
+void ComputeLighting(vec4 bump_color) {
+    vec4 diffuse_sum = vec4(0.0, 0.0, 0.0, 1.0);
+    vec4 specular_sum = vec4(0.0, 0.0, 0.0, 1.0);
+
+    vec3 surface_normal = vec3(0.0, 0.0, 1.0);
+    if (lighting_bump_mode == BUMP_MODE_NORMAL_MAP) {
+        surface_normal = 2.0 * bump_color.rgb - 1.0;
+        if (lighting_bump_renorm != 0) {
+            surface_normal.z = sqrt(max((1.0 - (surface_normal.x * surface_normal.x +
+                                                surface_normal.y * surface_normal.y)), 0.0));
+        }
+    }
+    vec3 normal = normalize(quaternion_rotate(normquat, surface_normal));
+
+    for (int i = 0; i < NUM_LIGHTS && i < lighting_src_num; ++i) {
+        ivec4 light = lighting_lights[i];
+        LightSrc src = light_src[light.x];
+
+        vec3 light_vector =
+            (light.y != 0) ? normalize(src.position) : normalize(src.position + view);
+        float dot_product = (light.z != 0) ? abs(dot(light_vector, normal))
+                                           : max(dot(light_vector, normal), 0.0);
+
+        float dist_atten = 1.0;
+        if (light.w != 0) {
+            float index = src.dist_atten_scale * length(-view - src.position) +
+                          src.dist_atten_bias;
+            index = OFFSET_256 + SCALE_256 * clamp(index, 0.0, 1.0);
+            dist_atten = LookupLightingLut(SAMPLER_DIST_ATTEN + light.x, index);
+        }
+
+        float clamp_highlights =
+            (lighting_clamp_highlights != 0 && dot(light_vector, normal) <= 0.0) ? 0.0 : 1.0;
+
+        // The specialized shaders look the flag up by light number, do the same to match them
+        bool two_sided = lighting_lights[light.x].z != 0;
+
+        float d0_lut_value = 1.0;
+        if (lighting_luts[LUT_D0].x != 0) {
+            d0_lut_value = GetLightingLutValue(LUT_D0, SAMPLER_D0, two_sided, normal,
+                                               light_vector);
+        }
+        vec3 specular_0 = d0_lut_value * src.specular_0;
+
+        vec3 refl_value;
+        refl_value.r = 1.0;
+        if (lighting_luts[LUT_RR].x != 0) {
+            refl_value.r = GetLightingLutValue(LUT_RR, SAMPLER_RR, two_sided, normal,
+                                               light_vector);
+        }
+        refl_value.g = refl_value.r;
+        if (lighting_luts[LUT_RG].x != 0) {
+            refl_value.g = GetLightingLutValue(LUT_RG, SAMPLER_RG, two_sided, normal,
+                                               light_vector);
+        }
+        refl_value.b = refl_value.r;
+        if (lighting_luts[LUT_RB].x != 0) {
+            refl_value.b = GetLightingLutValue(LUT_RB, SAMPLER_RB, two_sided, normal,
+                                               light_vector);
+        }
+
+        float d1_lut_value = 1.0;
+        if (lighting_luts[LUT_D1].x != 0) {
+            d1_lut_value = GetLightingLutValue(LUT_D1, SAMPLER_D1, two_sided, normal,
+                                               light_vector);
+        }
+        vec3 specular_1 = d1_lut_value * refl_value * src.specular_1;
+
+        if (lighting_luts[LUT_FR].x != 0) {
+            float fresnel = GetLightingLutValue(LUT_FR, SAMPLER_FR, two_sided, normal,
+                                                light_vector);
+            if ((lighting_fresnel_selector & 1) != 0)
+                diffuse_sum.a *= fresnel;
+            if ((lighting_fresnel_selector & 2) != 0)
+                specular_sum.a *= fresnel;
+        }
+
+        diffuse_sum.rgb += ((src.diffuse * dot_product) + src.ambient) * dist_atten;
+        specular_sum.rgb += (specular_0 + specular_1) * clamp_highlights * dist_atten;
+    }
+
+    diffuse_sum.rgb += lighting_global_ambient;
+    primary_fragment_color = clamp(diffuse_sum, vec4(0.0), vec4(1.0));
+    secondary_fragment_color = clamp(specular_sum, vec4(0.0), vec4(1.0));
+}
+
+void main() {
+    primary_fragment_color = vec4(0.0);
+    secondary_fragment_color = vec4(0.0);
+
+    if (alpha_test_func == ALPHA_TEST_NEVER)
+        discard;
+
+    if (scissor_test_mode == SCISSOR_EXCLUDE || scissor_test_mode == SCISSOR_INCLUDE) {
+        bool inside = gl_FragCoord.x >= scissor_x1 && gl_FragCoord.y >= scissor_y1 &&
+                      gl_FragCoord.x < scissor_x2 && gl_FragCoord.y < scissor_y2;
+        if (inside == (scissor_test_mode == SCISSOR_EXCLUDE))
+            discard;
+    }
+
+    float z_over_w = 1.0 - gl_FragCoord.z * 2.0;
+    float depth = z_over_w * depth_scale + depth_offset;
+    if (w_buffering != 0)
+        depth /= gl_FragCoord.w;
+
+    // Only unit 0 respects the texturing type (according to 3DBrew)
+    if (texture0_type == TEXTURE_PROJECTION_2D)
+        texture_color[0] = textureProj(tex[0], vec3(texcoord[0], texcoord0_w));
+    else
+        texture_color[0] = texture(tex[0], texcoord[0]);
+    texture_color[1] = texture(tex[1], texcoord[1]);
+    texture_color[2] = texture(tex[2], texcoord[2]);
+
+    if (lighting_enable != 0) {
+        // The normal map is sampled without projection, even on unit 0
+        vec4 bump_color;
+        if (lighting_bump_selector == 0)
+            bump_color = texture(tex[0], texcoord[0]);
+        else
+            bump_color = texture_color[lighting_bump_selector];
+        ComputeLighting(bump_color);
+    }
+
+    combiner_buffer = vec4(0.0);
+    vec4 next_combiner_buffer = tev_combiner_buffer_color;
+    last_tex_env_out = vec4(0.0);
+
+    for (int i = 0; i < NUM_TEV_STAGES; ++i) {
+        uvec4 stage = tev_stages[i];
+        uint sources = stage.x;
+        uint modifiers = stage.y;
+
+        vec3 color_results[3] = vec3[3](
+            GetColorModifier(modifiers & 0xFu, GetSource(sources & 0xFu, i)),
+            GetColorModifier((modifiers >> 4) & 0xFu, GetSource((sources >> 4) & 0xFu, i)),
+            GetColorModifier((modifiers >> 8) & 0xFu, GetSource((sources >> 8) & 0xFu, i)));
+        float alpha_results[3] = float[3](
+            GetAlphaModifier((modifiers >> 12) & 0x7u, GetSource((sources >> 16) & 0xFu, i)),
+            GetAlphaModifier((modifiers >> 16) & 0x7u, GetSource((sources >> 20) & 0xFu, i)),
+            GetAlphaModifier((modifiers >> 20) & 0x7u, GetSource((sources >> 24) & 0xFu, i)));
+
+        vec3 color_output = CombineColor(stage.z & 0xFu, color_results);
+        float alpha_output = CombineAlpha((stage.z >> 16) & 0xFu, alpha_results);
+
+        last_tex_env_out = vec4(
+            clamp(color_output * GetMultiplier(stage.w & 0x3u), vec3(0.0), vec3(1.0)),
+            clamp(alpha_output * GetMultiplier((stage.w >> 16) & 0x3u), 0.0, 1.0));
+
+        combiner_buffer = next_combiner_buffer;
+        if (i < 4 && (combiner_buffer_input & (1 << i)) != 0)
+            next_combiner_buffer.rgb = last_tex_env_out.rgb;
+        if (i < 4 && ((combiner_buffer_input >> 4) & (1 << i)) != 0)
+            next_combiner_buffer.a = last_tex_env_out.a;
+    }
+
+    if (AlphaTestFails(last_tex_env_out.a))
+        discard;
+
+    if (fog_enable != 0) {
+        float fog_index = ((fog_flip != 0) ? (1.0 - depth) : depth) * 128.0;
+
+        // Generate clamped fog factor from LUT for given fog index
+        float fog_i = clamp(floor(fog_index), 0.0, 127.0);
+        float fog_f = fog_index - fog_i;
+        uint fog_lut_entry = texelFetch(lut, FOG_LUT_OFFSET + int(fog_i)).r;
+        // Extract signed difference
+        float fog_lut_entry_difference = float(int((fog_lut_entry & 0x1FFFU) << 19U) >> 19);
+        float fog_lut_entry_value = float((fog_lut_entry >> 13U) & 0x7FFU);
+        float fog_factor = (fog_lut_entry_value + fog_lut_entry_difference * fog_f) / 2047.0;
+        fog_factor = clamp(fog_factor, 0.0, 1.0);
+
+        // Blend the fog
+        last_tex_env_out.rgb = mix(fog_color.rgb, last_tex_env_out.rgb, fog_factor);
+    }
+
+    gl_FragDepth = depth;
+    color = last_tex_env_out;
+}
+)";
+
+    return out;
+}
+
 std::string GenerateVertexShader() {
     std::string out = "#version 330 core\n";
 
@@ -24,4 +24,12 @@ std::string GenerateVertexShader();
  */
 std::string GenerateFragmentShader(const PicaShaderConfig& config);
 
+/**
+ * Generates the GLSL source code of a fragment shader that emulates any Pica state, read at run
+ * time from the uber_config uniform block instead of being baked into the code. It is used
+ * while the specialized shader for a configuration is being built.
+ * @returns String of the shader source code
+ */
+std::string GenerateUberFragmentShader();
+
 } // namespace GLShader
@@ -96,4 +96,59 @@ GLuint LoadProgram(const char* vertex_shader, const char* fragment_shader) {
     return program_id;
 }
 
+GLuint CreateProgramAsync(const char* vertex_shader, const char* fragment_shader,
+                          bool retrievable) {
+    GLuint vertex_shader_id = glCreateShader(GL_VERTEX_SHADER);
+    GLuint fragment_shader_id = glCreateShader(GL_FRAGMENT_SHADER);
+
+    glShaderSource(vertex_shader_id, 1, &vertex_shader, nullptr);
+    glCompileShader(vertex_shader_id);
+    glShaderSource(fragment_shader_id, 1, &fragment_shader, nullptr);
+    glCompileShader(fragment_shader_id);
+
+    GLuint program_id = glCreateProgram();
+    glAttachShader(program_id, vertex_shader_id);
+    glAttachShader(program_id, fragment_shader_id);
+    if (retrievable) {
+        glProgramParameteri(program_id, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+    }
+    glLinkProgram(program_id);
+
+    // The shaders are only flagged for deletion while attached, compile errors end up in the
+    // program info log
+    glDeleteShader(vertex_shader_id);
+    glDeleteShader(fragment_shader_id);
+
+    return program_id;
+}
+
+bool IsProgramLinkDone(GLuint program) {
+    if (!GLAD_GL_ARB_parallel_shader_compile) {
+        return true;
+    }
+
+    GLint done = GL_FALSE;
+    glGetProgramiv(program, GL_COMPLETION_STATUS_ARB, &done);
+    return done == GL_TRUE;
+}
+
+bool CheckProgramLinked(GLuint program) {
+    GLint result = GL_FALSE;
+    glGetProgramiv(program, GL_LINK_STATUS, &result);
+    if (result == GL_TRUE) {
+        return true;
+    }
+
+    GLint info_log_length = 0;
+    glGetProgramiv(program, GL_INFO_LOG_LENGTH, &info_log_length);
+    if (info_log_length > 1) {
+        std::vector<char> program_error(info_log_length);
+        glGetProgramInfoLog(program, info_log_length, nullptr, &program_error[0]);
+        LOG_ERROR(Render_OpenGL, "Error linking shader:\n%s", &program_error[0]);
+    } else {
+        LOG_ERROR(Render_OpenGL, "Error linking shader");
+    }
+    return false;
+}
+
 } // namespace GLShader
@@ -27,4 +27,29 @@ enum Attributes {
  */
 GLuint LoadProgram(const char* vertex_shader, const char* fragment_shader);
 
+/**
+ * Starts compiling and linking a GLSL program without waiting for the result, so that drivers
+ * compiling on their own threads can do so in the background. Check the result with
+ * IsProgramLinkDone and CheckProgramLinked.
+ * @param vertex_shader String of the GLSL vertex shader program
+ * @param fragment_shader String of the GLSL fragment shader program
+ * @param retrievable Whether the binary of the program will be retrieved with glGetProgramBinary
+ * @returns Handle of the newly created OpenGL program object
+ */
+GLuint CreateProgramAsync(const char* vertex_shader, const char* fragment_shader,
+                          bool retrievable);
+
+/**
+ * Queries whether the driver has finished linking a program. Only returns false if
+ * ARB_parallel_shader_compile can tell, otherwise asking for the result may block instead.
+ */
+bool IsProgramLinkDone(GLuint program);
+
+/**
+ * Checks whether a program was linked successfully, logging the errors if it wasn't
+ * @param program Handle of the program
+ * @returns true if the program can be used
+ */
+bool CheckProgramLinked(GLuint program);
+
 } // namespace
@@ -52,11 +52,7 @@ OpenGLState::OpenGLState() {
         texture_unit.sampler = 0;
     }
 
-    for (auto& lut : lighting_luts) {
-        lut.texture_1d = 0;
-    }
-
-    fog_lut.texture_1d = 0;
+    lut.texture_buffer = 0;
 
     draw.read_framebuffer = 0;
     draw.draw_framebuffer = 0;
@@ -187,18 +183,10 @@ void OpenGLState::Apply() const {
         }
     }
 
-    // Lighting LUTs
-    for (unsigned i = 0; i < ARRAY_SIZE(lighting_luts); ++i) {
-        if (lighting_luts[i].texture_1d != cur_state.lighting_luts[i].texture_1d) {
-            glActiveTexture(GL_TEXTURE3 + i);
-            glBindTexture(GL_TEXTURE_1D, lighting_luts[i].texture_1d);
-        }
-    }
-
-    // Fog LUT
-    if (fog_lut.texture_1d != cur_state.fog_lut.texture_1d) {
-        glActiveTexture(GL_TEXTURE9);
-        glBindTexture(GL_TEXTURE_1D, fog_lut.texture_1d);
+    // Lighting and fog LUTs
+    if (lut.texture_buffer != cur_state.lut.texture_buffer) {
+        glActiveTexture(GL_TEXTURE3);
+        glBindTexture(GL_TEXTURE_BUFFER, lut.texture_buffer);
     }
 
     // Framebuffer
@@ -238,6 +226,9 @@ void OpenGLState::ResetTexture(GLuint handle) {
             unit.texture_2d = 0;
         }
     }
+    if (cur_state.lut.texture_buffer == handle) {
+        cur_state.lut.texture_buffer = 0;
+    }
 }
 
 void OpenGLState::ResetSampler(GLuint handle) {
@@ -64,12 +64,8 @@ public:
     } texture_units[3];
 
     struct {
-        GLuint texture_1d; // GL_TEXTURE_BINDING_1D
-    } lighting_luts[6];
-
-    struct {
-        GLuint texture_1d; // GL_TEXTURE_BINDING_1D
-    } fog_lut;
+        GLuint texture_buffer; // GL_TEXTURE_BINDING_BUFFER
+    } lut;
 
     struct {
         GLuint read_framebuffer; // GL_READ_FRAMEBUFFER_BINDING
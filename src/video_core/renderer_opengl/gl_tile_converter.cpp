@@ -0,0 +1,272 @@
+// Copyright 2017 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <glad/glad.h>
+#include "common/assert.h"
+#include "common/microprofile.h"
+#include "video_core/renderer_opengl/gl_state.h"
+#include "video_core/renderer_opengl/gl_tile_converter.h"
+
+static const char vertex_shader[] = R"(
+#version 150 core
+
+void main() {
+    // Single triangle covering the whole viewport
+    vec2 position = vec2((gl_VertexID << 1) & 2, gl_VertexID & 2);
+    gl_Position = vec4(position * 2.0 - 1.0, 0.0, 1.0);
+}
+)";
+
+// The staging texture holds the raw 3DS data, so its texel at index i (counting rows from the
+// bottom of the texture) is the i-th pixel in memory. Images are stored in memory as a row-major
+// grid of 8x8 tiles with the pixels of each tile in Morton order, starting at the top-left tile.
+// Textures are flipped vertically, with row 0 holding the bottom line of the image.
+static const char fragment_shader[] = R"(
+#version 150 core
+
+out vec4 color;
+
+uniform sampler2D source;
+uniform int width;
+uniform int height;
+// 0 to untile the staging texture, 1 to tile it
+uniform int tile;
+// Source component of each output component
+uniform ivec4 swizzle;
+
+int MortonOffset(ivec2 position) {
+    return (position.x & 1) | ((position.y & 1) << 1) | ((position.x & 2) << 1) |
+           ((position.y & 2) << 2) | ((position.x & 4) << 2) | ((position.y & 4) << 3);
+}
+
+ivec2 MortonPosition(int offset) {
+    return ivec2((offset & 1) | ((offset >> 1) & 2) | ((offset >> 2) & 4),
+                 ((offset >> 1) & 1) | ((offset >> 2) & 2) | ((offset >> 3) & 4));
+}
+
+void main() {
+    ivec2 coord = ivec2(gl_FragCoord.xy);
+    int tiles_per_row = width >> 3;
+    ivec2 source_coord;
+
+    if (tile == 0) {
+        // Output texel is a pixel of the image, fetch it from its position in memory
+        ivec2 position = ivec2(coord.x, height - 1 - coord.y);
+        int tile_index = (position.y >> 3) * tiles_per_row + (position.x >> 3);
+        int index = tile_index * 64 + MortonOffset(position & 7);
+        source_coord = ivec2(index % width, index / width);
+    } else {
+        // Output texel is a pixel in memory, fetch it from its position in the image
+        int index = coord.y * width + coord.x;
+        int tile_index = index >> 6;
+        ivec2 position = ivec2(tile_index % tiles_per_row, tile_index / tiles_per_row) * 8 +
+                         MortonPosition(index & 63);
+        source_coord = ivec2(position.x, height - 1 - position.y);
+    }
+
+    vec4 texel = texelFetch(source, source_coord, 0);
+    color = vec4(texel[swizzle.x], texel[swizzle.y], texel[swizzle.z], texel[swizzle.w]);
+}
+)";
+
+static const GLint identity_swizzle[4] = {0, 1, 2, 3};
+/// Moves 3DS D24S8 pixels (depth in the low 24 bits) to GL_UNSIGNED_INT_24_8 order
+static const GLint d24s8_untile_swizzle[4] = {3, 0, 1, 2};
+/// Moves GL_UNSIGNED_INT_24_8 pixels (depth in the high 24 bits) to 3DS D24S8 order
+static const GLint d24s8_tile_swizzle[4] = {1, 2, 3, 0};
+
+TileConverterOpenGL::TileConverterOpenGL() {
+    program.Create(vertex_shader, fragment_shader);
+    vertex_array.Create();
+    framebuffer.Create();
+    staging_texture.Create();
+    target_texture.Create();
+    depth_stencil_buffer.Create();
+
+    uniform_width = glGetUniformLocation(program.handle, "width");
+    uniform_height = glGetUniformLocation(program.handle, "height");
+    uniform_tile = glGetUniformLocation(program.handle, "tile");
+    uniform_swizzle = glGetUniformLocation(program.handle, "swizzle");
+
+    OpenGLState cur_state = OpenGLState::GetCurState();
+    GLuint old_program = cur_state.draw.shader_program;
+    GLuint old_tex = cur_state.texture_units[0].texture_2d;
+
+    cur_state.draw.shader_program = program.handle;
+    cur_state.texture_units[0].texture_2d = staging_texture.handle;
+    cur_state.Apply();
+    glActiveTexture(GL_TEXTURE0);
+
+    glUniform1i(glGetUniformLocation(program.handle, "source"), 0);
+
+    // Allocate the level so that the texture is complete
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, 8, 8, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, 0);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+
+    cur_state.texture_units[0].texture_2d = target_texture.handle;
+    cur_state.Apply();
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, 0);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+
+    cur_state.draw.shader_program = old_program;
+    cur_state.texture_units[0].texture_2d = old_tex;
+    cur_state.Apply();
+}
+
+void TileConverterOpenGL::Convert(GLuint src_texture, GLuint dst_texture, u32 width, u32 height,
+                                  bool tile, const GLint swizzle[4]) {
+    // Make sure the destination isn't bound to a texture unit while rendering to it
+    OpenGLState::ResetTexture(dst_texture);
+
+    OpenGLState state = OpenGLState::GetCurState();
+
+    state.cull.enabled = false;
+    state.depth.test_enabled = false;
+    state.stencil.test_enabled = false;
+    state.blend.enabled = false;
+    state.logic_op = GL_COPY;
+    state.color_mask.red_enabled = GL_TRUE;
+    state.color_mask.green_enabled = GL_TRUE;
+    state.color_mask.blue_enabled = GL_TRUE;
+    state.color_mask.alpha_enabled = GL_TRUE;
+    state.texture_units[0].texture_2d = src_texture;
+    state.texture_units[0].sampler = 0;
+    state.draw.read_framebuffer = framebuffer.handle;
+    state.draw.draw_framebuffer = framebuffer.handle;
+    state.draw.vertex_array = vertex_array.handle;
+    state.draw.shader_program = program.handle;
+    state.Apply();
+
+    glFramebufferTexture2D(GL_DRAW_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, dst_texture,
+                           0);
+    glFramebufferTexture2D(GL_DRAW_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_TEXTURE_2D, 0, 0);
+
+    glUniform1i(uniform_width, static_cast<GLint>(width));
+    glUniform1i(uniform_height, static_cast<GLint>(height));
+    glUniform1i(uniform_tile, tile ? 1 : 0);
+    glUniform4iv(uniform_swizzle, 1, swizzle);
+
+    glViewport(0, 0, width, height);
+    glDrawArrays(GL_TRIANGLES, 0, 3);
+
+    // The framebuffer stays bound for reading the result, callers restore their own state
+}
+
+MICROPROFILE_DEFINE(OpenGL_Untile, "OpenGL", "GPU Untiling", MP_RGB(160, 96, 192));
+void TileConverterOpenGL::Untile(const u8* tiled_data, GLuint dst_texture, u32 width, u32 height,
+                                 GLint internal_format, GLenum format, GLenum type) {
+    MICROPROFILE_SCOPE(OpenGL_Untile);
+
+    ASSERT(width % 8 == 0 && height % 8 == 0);
+
+    OpenGLState prev_state = OpenGLState::GetCurState();
+    OpenGLState state = prev_state;
+    state.texture_units[0].texture_2d = staging_texture.handle;
+    state.Apply();
+    glActiveTexture(GL_TEXTURE0);
+
+    const bool depth_stencil = format == GL_DEPTH_STENCIL;
+
+    // Upload the tiled data as if it was a linear image, each texel still holds one pixel
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    if (depth_stencil) {
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE,
+                     tiled_data);
+    } else {
+        glTexImage2D(GL_TEXTURE_2D, 0, internal_format, width, height, 0, format, type,
+                     tiled_data);
+    }
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+
+    if (!depth_stencil) {
+        Convert(staging_texture.handle, dst_texture, width, height, false, identity_swizzle);
+        prev_state.Apply();
+        return;
+    }
+
+    state.texture_units[0].texture_2d = target_texture.handle;
+    state.Apply();
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE,
+                 nullptr);
+
+    Convert(staging_texture.handle, target_texture.handle, width, height, false,
+            d24s8_untile_swizzle);
+
+    // Copy the untiled pixels into the depth-stencil texture without leaving the GPU
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, depth_stencil_buffer.handle);
+    glBufferData(GL_PIXEL_PACK_BUFFER, width * height * 4, nullptr, GL_STREAM_COPY);
+    glReadPixels(0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+    state.texture_units[0].texture_2d = dst_texture;
+    state.Apply();
+    glActiveTexture(GL_TEXTURE0);
+
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, depth_stencil_buffer.handle);
+    glTexImage2D(GL_TEXTURE_2D, 0, internal_format, width, height, 0, format, type, nullptr);
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+
+    prev_state.Apply();
+}
+
+MICROPROFILE_DEFINE(OpenGL_Tile, "OpenGL", "GPU Tiling", MP_RGB(96, 192, 160));
+void TileConverterOpenGL::Tile(GLuint src_texture, u32 width, u32 height, GLint internal_format,
+                               GLenum format, GLenum type, GLvoid* pixels) {
+    MICROPROFILE_SCOPE(OpenGL_Tile);
+
+    ASSERT(width % 8 == 0 && height % 8 == 0);
+
+    OpenGLState prev_state = OpenGLState::GetCurState();
+    OpenGLState state = prev_state;
+
+    const bool depth_stencil = format == GL_DEPTH_STENCIL;
+    const GLint* swizzle = identity_swizzle;
+
+    // Pixels are read into the pixel pack buffer bound by the caller, if any
+    GLint pack_buffer = 0;
+    glGetIntegerv(GL_PIXEL_PACK_BUFFER_BINDING, &pack_buffer);
+
+    if (depth_stencil) {
+        // Reinterpret the depth-stencil texture as RGBA8 so that it can be sampled as a whole
+        state.texture_units[0].texture_2d = src_texture;
+        state.Apply();
+        glActiveTexture(GL_TEXTURE0);
+
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, depth_stencil_buffer.handle);
+        glBufferData(GL_PIXEL_PACK_BUFFER, width * height * 4, nullptr, GL_STREAM_COPY);
+        glGetTexImage(GL_TEXTURE_2D, 0, format, type, nullptr);
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+        state.texture_units[0].texture_2d = staging_texture.handle;
+        state.Apply();
+
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, depth_stencil_buffer.handle);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE,
+                     nullptr);
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+
+        internal_format = GL_RGBA8;
+        format = GL_RGBA;
+        type = GL_UNSIGNED_BYTE;
+        swizzle = d24s8_tile_swizzle;
+        src_texture = staging_texture.handle;
+    }
+
+    state.texture_units[0].texture_2d = target_texture.handle;
+    state.Apply();
+    glActiveTexture(GL_TEXTURE0);
+    glTexImage2D(GL_TEXTURE_2D, 0, internal_format, width, height, 0, format, type, nullptr);
+
+    Convert(src_texture, target_texture.handle, width, height, true, swizzle);
+
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, static_cast<GLuint>(pack_buffer));
+    glPixelStorei(GL_PACK_ALIGNMENT, 1);
+    glReadPixels(0, 0, width, height, format, type, pixels);
+    glPixelStorei(GL_PACK_ALIGNMENT, 4);
+
+    prev_state.Apply();
+}
@@ -0,0 +1,72 @@
+// Copyright 2017 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <glad/glad.h>
+#include "common/common_funcs.h"
+#include "common/common_types.h"
+#include "video_core/renderer_opengl/gl_resource_manager.h"
+
+/**
+ * Converts images between the 3DS tiled (Morton order, 8x8 tiles) layout and OpenGL textures on
+ * the GPU. Raw guest data is uploaded unchanged into a staging texture of the same format, and a
+ * fragment pass moves each texel to its place. Since every texel is only moved, color formats go
+ * through OpenGL's own format conversion and the result matches the CPU codecs bit for bit.
+ *
+ * D24S8 is moved as RGBA8 and converted to and from the depth-stencil texture through a pixel
+ * buffer, since fragment shaders can't write stencil values.
+ */
+class TileConverterOpenGL : NonCopyable {
+public:
+    TileConverterOpenGL();
+
+    /**
+     * Untiles 3DS image data into a texture, replacing its level 0 image
+     * @param tiled_data Image data in the 3DS tiled layout
+     * @param dst_texture Texture receiving the image. Color textures must already be allocated
+     *                    at the size of the image.
+     * @param width Width of the image in pixels, a multiple of 8
+     * @param height Height of the image in pixels, a multiple of 8
+     * @param internal_format Internal format of the texture
+     * @param format Pixel format of the 3DS data, as passed to glTexImage2D
+     * @param type Pixel type of the 3DS data, as passed to glTexImage2D
+     */
+    void Untile(const u8* tiled_data, GLuint dst_texture, u32 width, u32 height,
+                GLint internal_format, GLenum format, GLenum type);
+
+    /**
+     * Reads a texture back in the 3DS tiled layout
+     * @param src_texture Texture to read, at 1x scale
+     * @param width Width of the texture in pixels, a multiple of 8
+     * @param height Height of the texture in pixels, a multiple of 8
+     * @param internal_format Internal format of the texture
+     * @param format Pixel format of the 3DS data, as passed to glReadPixels
+     * @param type Pixel type of the 3DS data, as passed to glReadPixels
+     * @param pixels Destination of the tiled data, or an offset into the bound pixel pack buffer
+     */
+    void Tile(GLuint src_texture, u32 width, u32 height, GLint internal_format, GLenum format,
+              GLenum type, GLvoid* pixels);
+
+private:
+    /// Renders the tiled or untiled contents of src_texture into dst_texture
+    void Convert(GLuint src_texture, GLuint dst_texture, u32 width, u32 height, bool tile,
+                 const GLint swizzle[4]);
+
+    OGLShader program;
+    OGLVertexArray vertex_array;
+    OGLFramebuffer framebuffer;
+
+    /// Raw 3DS data, or a depth-stencil image reinterpreted as RGBA8
+    OGLTexture staging_texture;
+    /// Output of the conversion pass for reads and depth-stencil images
+    OGLTexture target_texture;
+    /// Moves depth-stencil images between RGBA8 and depth-stencil textures
+    OGLBuffer depth_stencil_buffer;
+
+    GLint uniform_width;
+    GLint uniform_height;
+    GLint uniform_tile;
+    GLint uniform_swizzle;
+};
@@ -5,7 +5,9 @@
 #include <algorithm>
 #include <cstddef>
 #include <cstdlib>
+#include <cstring>
 #include <memory>
+#include <vector>
 #include <glad/glad.h>
 #include "common/assert.h"
 #include "common/bit_field.h"
@@ -122,6 +124,7 @@ void RendererOpenGL::SwapBuffers() {
         if (color_fill.is_enabled) {
             LoadColorToActiveGLTexture(color_fill.color_r, color_fill.color_g, color_fill.color_b,
                                        screen_infos[i].texture);
+            screen_infos[i].loaded_addr = 0;
 
             // Resize the texture in case the framebuffer size has changed
             screen_infos[i].texture.width = 1;
@@ -134,6 +137,7 @@ void RendererOpenGL::SwapBuffers() {
                 // This is expected to not happen very often and hence should not be a
                 // performance problem.
                 ConfigureFramebufferTexture(screen_infos[i].texture, framebuffer);
+                screen_infos[i].loaded_addr = 0;
             }
             LoadFBToScreenInfo(framebuffer, screen_infos[i]);
 
@@ -145,6 +149,8 @@ void RendererOpenGL::SwapBuffers() {
 
     DrawScreens();
 
+    rasterizer->NotifyFrameFinished();
+
     auto& profiler = Common::Profiling::GetProfilingManager();
     profiler.FinishFrame();
     {
@@ -167,6 +173,28 @@ void RendererOpenGL::SwapBuffers() {
     }
 }
 
+/**
+ * Brings a copy of a guest framebuffer up to date. The two are compared block by block, and only
+ * the part starting at the first block that differs is copied.
+ * @returns Whether the copy was out of date
+ */
+static bool UpdateFramebufferCopy(std::vector<u8>& copy, const u8* data, size_t size) {
+    if (copy.size() != size) {
+        copy.assign(data, data + size);
+        return true;
+    }
+
+    constexpr size_t BLOCK_SIZE = 0x1000;
+    for (size_t offset = 0; offset < size; offset += BLOCK_SIZE) {
+        const size_t block_size = std::min(BLOCK_SIZE, size - offset);
+        if (std::memcmp(copy.data() + offset, data + offset, block_size) != 0) {
+            std::memcpy(copy.data() + offset, data + offset, size - offset);
+            return true;
+        }
+    }
+    return false;
+}
+
 /**
  * Loads framebuffer from emulated memory into the active OpenGL texture.
  */
@@ -196,9 +224,20 @@ void RendererOpenGL::LoadFBToScreenInfo(const GPU::Regs::FramebufferConfig& fram
         screen_info.display_texture = screen_info.texture.resource.handle;
         screen_info.display_texcoords = MathUtil::Rectangle<float>(0.f, 0.f, 1.f, 1.f);
 
-        Memory::RasterizerFlushRegion(framebuffer_addr, framebuffer.stride * framebuffer.height);
+        const u32 size = framebuffer.stride * framebuffer.height;
+        Memory::RasterizerFlushRegion(framebuffer_addr, size);
 
         const u8* framebuffer_data = Memory::GetPhysicalPointer(framebuffer_addr);
+        if (framebuffer_data == nullptr) {
+            return;
+        }
+
+        // Static screens don't need to be uploaded again. The CPU writes framebuffers with plain
+        // stores that aren't tracked, so they are compared with the data last loaded.
+        const bool changed = UpdateFramebufferCopy(screen_info.loaded_data, framebuffer_data, size);
+        if (!changed && screen_info.loaded_addr == framebuffer_addr) {
+            return;
+        }
 
         state.texture_units[0].texture_2d = screen_info.texture.resource.handle;
         state.Apply();
@@ -206,6 +245,24 @@ void RendererOpenGL::LoadFBToScreenInfo(const GPU::Regs::FramebufferConfig& fram
         glActiveTexture(GL_TEXTURE0);
         glPixelStorei(GL_UNPACK_ROW_LENGTH, (GLint)pixel_stride);
 
+        // Stage the framebuffer in a pixel buffer, letting the driver upload it asynchronously
+        const size_t buffer_index = upload_buffer_index;
+        upload_buffer_index = (upload_buffer_index + 1) % upload_buffers.size();
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, upload_buffers[buffer_index].handle);
+        if (upload_buffer_sizes[buffer_index] < size) {
+            glBufferData(GL_PIXEL_UNPACK_BUFFER, size, nullptr, GL_STREAM_DRAW);
+            upload_buffer_sizes[buffer_index] = size;
+        }
+
+        void* pixels = glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, size,
+                                        GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT);
+        if (pixels != nullptr) {
+            std::memcpy(pixels, framebuffer_data, size);
+            glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+        } else {
+            glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+        }
+
         // Update existing texture
         // TODO: Test what happens on hardware when you change the framebuffer dimensions so that
         //       they differ from the LCD resolution.
@@ -213,12 +270,15 @@ void RendererOpenGL::LoadFBToScreenInfo(const GPU::Regs::FramebufferConfig& fram
         //       framebuffer sizes. We should make sure that this cannot happen.
         glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, framebuffer.width, framebuffer.height,
                         screen_info.texture.gl_format, screen_info.texture.gl_type,
-                        framebuffer_data);
+                        pixels != nullptr ? nullptr : framebuffer_data);
 
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
         glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
 
         state.texture_units[0].texture_2d = 0;
         state.Apply();
+
+        screen_info.loaded_addr = framebuffer_addr;
     }
 }
 
@@ -274,6 +334,10 @@ void RendererOpenGL::InitOpenGLObjects() {
     glEnableVertexAttribArray(attrib_position);
     glEnableVertexAttribArray(attrib_tex_coord);
 
+    for (auto& upload_buffer : upload_buffers) {
+        upload_buffer.Create();
+    }
+
     // Allocate textures for each screen
     for (auto& screen_info : screen_infos) {
         screen_info.texture.resource.Create();
@@ -5,6 +5,7 @@
 #pragma once
 
 #include <array>
+#include <vector>
 #include <glad/glad.h>
 #include "common/common_types.h"
 #include "common/math_util.h"
@@ -30,6 +31,10 @@ struct ScreenInfo {
     GLuint display_texture;
     MathUtil::Rectangle<float> display_texcoords;
     TextureInfo texture;
+    /// Address of the guest framebuffer held by texture, 0 if it holds none
+    PAddr loaded_addr = 0;
+    /// Copy of the guest framebuffer held by texture, to detect changes to it
+    std::vector<u8> loaded_data;
 };
 
 class RendererOpenGL : public RendererBase {
@@ -81,6 +86,12 @@ private:
     /// Display information for top and bottom screens respectively
     std::array<ScreenInfo, 2> screen_infos;
 
+    /// Pixel buffers staging framebuffer uploads, used in turns so that filling one doesn't wait
+    /// for the upload from the other one
+    std::array<OGLBuffer, 2> upload_buffers;
+    std::array<u32, 2> upload_buffer_sizes{};
+    size_t upload_buffer_index = 0;
+
     // Shader uniform location indices
     GLuint uniform_modelview_matrix;
     GLuint uniform_color_texture;